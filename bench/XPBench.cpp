@@ -0,0 +1,523 @@
+//Module:	XPBench
+//Author:	Connor Russell
+//Date:		10/16/2026 9:36:12 PM
+//Purpose:	Microbenchmarks for the hot paths: the tokenizer, the obj parser and the library loader. Runs on the fixed inputs in bench/data, no X-Plane install needed.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <xplib/include/TextUtils.h>
+#include <xplib/include/XPLayerGroups.h>
+#include <xplib/include/XPLibrarySystem.h>
+#include <xplib/include/XPObj.h>
+#include <xplib/include/XPObjBvh.h>
+#include <xplib/include/XPObjOptimizer.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifndef XPLIB_BENCH_DATA_DIR
+#define XPLIB_BENCH_DATA_DIR "bench/data"
+#endif
+
+namespace fs = std::filesystem;
+
+///< Every allocation in the process goes through these, so a case's allocations are the difference in the counter across it
+static std::atomic<uint64_t> uintAllocations{0};
+
+///< GCC pairs the std::free in the replaced deletes with the inlined operator new rather than the malloc inside it
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(const std::size_t InSize)
+{
+    uintAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(InSize == 0 ? 1 : InSize))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(const std::size_t InSize, const std::align_val_t InAlign)
+{
+    uintAllocations.fetch_add(1, std::memory_order_relaxed);
+    const auto uintAlign = static_cast<std::size_t>(InAlign);
+#ifdef _WIN32
+    if (void *p = _aligned_malloc(InSize == 0 ? 1 : InSize, uintAlign))
+        return p;
+#else
+    if (void *p = std::aligned_alloc(uintAlign, (std::max<std::size_t>(InSize, 1) + uintAlign - 1) / uintAlign * uintAlign))
+        return p;
+#endif
+    throw std::bad_alloc();
+}
+
+void operator delete(void *InPtr) noexcept { std::free(InPtr); }
+void operator delete(void *InPtr, std::size_t) noexcept { std::free(InPtr); }
+#ifdef _WIN32
+void operator delete(void *InPtr, std::align_val_t) noexcept { _aligned_free(InPtr); }
+void operator delete(void *InPtr, std::size_t, std::align_val_t) noexcept { _aligned_free(InPtr); }
+#else
+void operator delete(void *InPtr, std::align_val_t) noexcept { std::free(InPtr); }
+void operator delete(void *InPtr, std::size_t, std::align_val_t) noexcept { std::free(InPtr); }
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+	/**
+	 * @brief Gets the peak resident set size of the process, in bytes
+	 */
+	size_t GetPeakRss()
+	{
+#ifdef _WIN32
+	    PROCESS_MEMORY_COUNTERS Counters{};
+	    if (GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters)))
+	        return Counters.PeakWorkingSetSize;
+	    return 0;
+#else
+	    rusage Usage{};
+	    getrusage(RUSAGE_SELF, &Usage);
+	#ifdef __APPLE__
+	    return static_cast<size_t>(Usage.ru_maxrss); ///< Bytes on macOS
+	#else
+	    return static_cast<size_t>(Usage.ru_maxrss) * 1024; ///< KiB on Linux
+	#endif
+#endif
+	}
+
+	/**
+	 * @brief Reads a whole file
+	 */
+	std::string ReadFile(const fs::path &InPath)
+	{
+	    std::ifstream File(InPath, std::ios::binary);
+	    std::stringstream ss;
+	    ss << File.rdbuf();
+	    return ss.str();
+	}
+
+	///< Work done by one run of a case, used to turn time into throughput
+	class BenchWork
+	{
+	public:
+	    uint64_t uintLines{0};
+	    uint64_t uintBytes{0};
+	};
+
+	/**
+	 * @brief A benchmark. Run is called repeatedly and must do the same work every time.
+	 */
+	class BenchCase
+	{
+	public:
+	    std::string strName;
+	    BenchWork Work;
+	    std::function<void()> Run;
+	};
+
+	/**
+	 * @brief Settings from the command line
+	 */
+	class BenchSettings
+	{
+	public:
+	    fs::path pDataDir{XPLIB_BENCH_DATA_DIR};
+	    std::string strFilter;  ///< Only cases whose name contains this run
+	    double dblMinTime{0.5}; ///< Seconds each case runs for, at least
+	    uint64_t uintMinIterations{3};
+	};
+
+	/**
+	 * @brief Runs a case until it has run long enough, then prints a row
+	 */
+	void RunCase(const BenchCase &InCase, const BenchSettings &InSettings)
+	{
+	    using Clock = std::chrono::steady_clock;
+
+	    ///< One untimed run to warm the page cache and the allocator
+	    InCase.Run();
+
+	    uint64_t uintIterations = 0;
+	    const uint64_t uintAllocationsBefore = uintAllocations.load(std::memory_order_relaxed);
+	    const auto tStart = Clock::now();
+	    double dblElapsed = 0;
+	    while (uintIterations < InSettings.uintMinIterations || dblElapsed < InSettings.dblMinTime)
+	    {
+	        InCase.Run();
+	        uintIterations++;
+	        dblElapsed = std::chrono::duration<double>(Clock::now() - tStart).count();
+	    }
+	    const uint64_t uintCaseAllocations = uintAllocations.load(std::memory_order_relaxed) - uintAllocationsBefore;
+
+	    const double dblPerOp = dblElapsed / static_cast<double>(uintIterations);
+	    std::printf("%-48s %8llu %10.3f %14.0f %10.1f %12.1f %10.1f\n", InCase.strName.c_str(), static_cast<unsigned long long>(uintIterations), dblPerOp * 1e3,
+	                static_cast<double>(InCase.Work.uintLines) / dblPerOp, static_cast<double>(InCase.Work.uintBytes) / dblPerOp / 1e6,
+	                static_cast<double>(uintCaseAllocations) / static_cast<double>(uintIterations), static_cast<double>(GetPeakRss()) / (1024.0 * 1024.0));
+	    std::fflush(stdout);
+	}
+
+	/**
+	 * @brief Counts the lines in a buffer. A last line without a newline counts.
+	 */
+	uint64_t CountLines(const std::string_view InText)
+	{
+	    const auto uintLines = static_cast<uint64_t>(std::ranges::count(InText, '\n'));
+	    return uintLines + (!InText.empty() && InText.back() != '\n' ? 1 : 0);
+	}
+
+	/**
+	 * @brief Splits a buffer into lines, without the newlines
+	 */
+	std::vector<std::string> SplitLines(const std::string &InText)
+	{
+	    std::vector<std::string> vctLines;
+	    std::stringstream ss(InText);
+	    std::string strLine;
+	    while (std::getline(ss, strLine))
+	        vctLines.push_back(strLine);
+	    return vctLines;
+	}
+
+	/**
+	 * @brief Finds every library.txt under a folder, sorted
+	 */
+	std::vector<fs::path> FindLibraryFiles(const fs::path &InFolder)
+	{
+	    std::vector<fs::path> vctFiles;
+	    std::error_code ec;
+	    for (const auto &p : fs::recursive_directory_iterator(InFolder, ec))
+	    {
+	        if (p.path().filename() == "library.txt")
+	            vctFiles.push_back(p.path());
+	    }
+	    std::ranges::sort(vctFiles);
+	    return vctFiles;
+	}
+
+	/**
+	 * @brief Tokenizes every library.txt line the way a parser would
+	 */
+	void AddTokenizerCases(std::vector<BenchCase> &OutCases, const BenchSettings &InSettings)
+	{
+	    std::string strText;
+	    for (const auto &p : FindLibraryFiles(InSettings.pDataDir / "xplane"))
+	        strText += ReadFile(p);
+
+	    auto vctLines = std::make_shared<std::vector<std::string>>(SplitLines(strText));
+
+	    BenchCase Case;
+	    Case.strName = "TextUtils::TokenizeString";
+	    Case.Work = {CountLines(strText), strText.size()};
+	    Case.Run = [vctLines]() {
+	        const std::vector<char> vctDelimiters = {' ', '\t', '\r', '\n'};
+	        size_t uintTokens = 0;
+	        for (const auto &strLine : *vctLines)
+	            uintTokens += TextUtils::TokenizeString(strLine, vctDelimiters).size();
+	        if (uintTokens == 0)
+	            std::abort();
+	    };
+	    OutCases.push_back(Case);
+
+	    ///< The string_view overload, with the token vector reused like the library.txt parser does
+	    Case.strName = "TextUtils::TokenizeString view";
+	    Case.Run = [vctLines]() {
+	        std::vector<std::string_view> vctTokens;
+	        size_t uintTokens = 0;
+	        for (const auto &strLine : *vctLines)
+	            uintTokens += TextUtils::TokenizeString(strLine, vctTokens);
+	        if (uintTokens == 0)
+	            std::abort();
+	    };
+	    OutCases.push_back(std::move(Case));
+	}
+
+	/**
+	 * @brief Resolves every layer group name, plus one that isn't, the way ATTR_layer_group does
+	 */
+	void AddLayerGroupCases(std::vector<BenchCase> &OutCases)
+	{
+	    static constexpr std::string_view GROUPS[] = {"terrain", "beaches", "shoulders", "taxiways", "runways", "markings", "airports", "roads", "objects", "light_objects", "cars", "unknown"};
+	    constexpr int REPEATS = 1000;
+
+	    size_t uintBytes = 0;
+	    for (const auto svGroup : GROUPS)
+	        uintBytes += svGroup.size() * REPEATS;
+
+	    BenchCase Case;
+	    Case.strName = "XPLayerGroups::Resolve";
+	    Case.Work = {std::size(GROUPS) * REPEATS, uintBytes};
+	    Case.Run = []() {
+	        int intSum = 0;
+	        for (int i = 0; i < REPEATS; i++)
+	        {
+	            for (const auto svGroup : GROUPS)
+	                intSum += XPLayerGroups::Resolve(svGroup, i & 7);
+	        }
+	        if (intSum == 0)
+	            std::abort();
+	    };
+	    OutCases.push_back(std::move(Case));
+	}
+
+	/**
+	 * @brief Loads every obj in the objects folder with each parse mode and storage
+	 */
+	void AddObjCases(std::vector<BenchCase> &OutCases, const BenchSettings &InSettings)
+	{
+	    std::vector<fs::path> vctObjs;
+	    std::error_code ec;
+	    for (const auto &p : fs::directory_iterator(InSettings.pDataDir / "objects", ec))
+	    {
+	        if (p.path().extension() == ".obj")
+	            vctObjs.push_back(p.path());
+	    }
+	    std::ranges::sort(vctObjs);
+
+	    for (const auto &pObj : vctObjs)
+	    {
+	        const std::string strText = ReadFile(pObj);
+	        const BenchWork Work{CountLines(strText), strText.size()};
+	        const std::string strSuffix = " [" + pObj.stem().string() + "]";
+
+	        auto AddCase = [&](const std::string &InName, const XPAsset::ObjLoadOptions &InOptions) {
+	            BenchCase Case;
+	            Case.strName = InName + strSuffix;
+	            Case.Work = Work;
+	            Case.Run = [pObj, InOptions]() {
+	                XPAsset::Obj Obj;
+	                if (!Obj.Load(pObj, InOptions))
+	                    std::abort();
+	            };
+	            OutCases.push_back(std::move(Case));
+	        };
+
+	        XPAsset::ObjLoadOptions Options;
+	        Options.Mode = XPAsset::ObjParseMode::Stream;
+	        AddCase("Obj::Load stream", Options);
+
+	        Options.Mode = XPAsset::ObjParseMode::MemoryMapped;
+	        AddCase("Obj::Load mapped", Options);
+
+	        Options.Storage = XPAsset::ObjStorage::Compact;
+	        Options.bQuantizeNormals = true;
+	        Options.bQuantizeUVs = true;
+	        AddCase("Obj::Load mapped compact", Options);
+
+	        ///< Only differs from mapped for objs with ATTR_LOD, like the corpus writes with --obj-lods
+	        Options = {};
+	        Options.Lods = XPAsset::ObjLodSelection::Farthest;
+	        AddCase("Obj::Load mapped farthest LOD", Options);
+
+	        ///< Compiled copies go to a scratch folder, never next to the inputs
+	        Options = {};
+	        Options.CompiledCache = XPAsset::ObjCompiledCache::Directory;
+	        Options.pCompiledCacheDir = fs::temp_directory_path() / "xplib_bench_compiled";
+	        AddCase("Obj::Load compiled", Options);
+
+	        auto AddHeaderCase = [&](const std::string &InName, const XPAsset::ObjReadMode InMode) {
+	            BenchCase Case;
+	            Case.strName = InName + strSuffix;
+	            Case.Work = Work;
+	            Case.Run = [pObj, InMode]() {
+	                XPAsset::ObjHeader Header;
+	                if (!Header.Load(pObj, InMode))
+	                    std::abort();
+	            };
+	            OutCases.push_back(std::move(Case));
+	        };
+
+	        ///< Optimizes a fresh copy each run. Loaded on first use, so filtered out cases don't hold big objs in memory.
+	        {
+	            BenchCase Case;
+	            Case.strName = "OptimizeObj" + strSuffix;
+	            Case.Work = Work;
+	            Case.Run = [pObj, pLoaded = std::shared_ptr<XPAsset::Obj>()]() mutable {
+	                if (pLoaded == nullptr)
+	                {
+	                    pLoaded = std::make_shared<XPAsset::Obj>();
+	                    if (!pLoaded->Load(pObj))
+	                        std::abort();
+	                }
+	                XPAsset::Obj Copy = *pLoaded;
+	                XPAsset::OptimizeObj(Copy);
+	            };
+	            OutCases.push_back(std::move(Case));
+	        }
+
+	        {
+	            BenchCase Case;
+	            Case.strName = "Obj::ComputeBounds" + strSuffix;
+	            Case.Work = Work;
+	            Case.Run = [pObj, pLoaded = std::shared_ptr<XPAsset::Obj>()]() mutable {
+	                if (pLoaded == nullptr)
+	                {
+	                    pLoaded = std::make_shared<XPAsset::Obj>();
+	                    if (!pLoaded->Load(pObj))
+	                        std::abort();
+	                }
+	                pLoaded->ComputeBounds();
+	            };
+	            OutCases.push_back(std::move(Case));
+	        }
+
+	        {
+	            BenchCase Case;
+	            Case.strName = "ObjBvh::Build" + strSuffix;
+	            Case.Work = Work;
+	            Case.Run = [pObj, pLoaded = std::shared_ptr<XPAsset::Obj>()]() mutable {
+	                if (pLoaded == nullptr)
+	                {
+	                    pLoaded = std::make_shared<XPAsset::Obj>();
+	                    if (!pLoaded->Load(pObj))
+	                        std::abort();
+	                }
+	                XPAsset::ObjBvh Bvh;
+	                Bvh.Build(*pLoaded);
+	            };
+	            OutCases.push_back(std::move(Case));
+	        }
+
+	        ///< 1000 rays per op, from above the object's bounds down through fixed points of them
+	        {
+	            BenchCase Case;
+	            Case.strName = "ObjBvh::Raycast x1000" + strSuffix;
+	            Case.Work = Work;
+	            Case.Run = [pObj, pBvh = std::shared_ptr<XPAsset::ObjBvh>(), Bounds = XPAsset::ObjBounds()]() mutable {
+	                if (pBvh == nullptr)
+	                {
+	                    XPAsset::Obj Obj;
+	                    if (!Obj.Load(pObj))
+	                        std::abort();
+	                    pBvh = std::make_shared<XPAsset::ObjBvh>();
+	                    pBvh->Build(Obj);
+	                    Bounds = Obj.Bounds;
+	                }
+	                if (Bounds.IsEmpty())
+	                    return;
+
+	                const double dblTop = Bounds.arrMax[1] + 10.0;
+	                for (int i = 0; i < 1000; i++)
+	                {
+	                    const double dblX = Bounds.arrMin[0] + (Bounds.arrMax[0] - Bounds.arrMin[0]) * ((i * 37) % 1000) / 1000.0;
+	                    const double dblZ = Bounds.arrMin[2] + (Bounds.arrMax[2] - Bounds.arrMin[2]) * ((i * 61) % 1000) / 1000.0;
+	                    XPAsset::ObjRayHit Hit;
+	                    pBvh->Raycast({dblX, dblTop, dblZ}, {0.0, -1.0, 0.0}, std::numeric_limits<double>::infinity(), Hit);
+	                }
+	            };
+	            OutCases.push_back(std::move(Case));
+	        }
+
+	        ///< Work is the whole file, so MB/s is the effective rate of a catalog pass
+	        AddHeaderCase("ObjHeader::Load probe", XPAsset::ObjReadMode::Probe);
+	        AddHeaderCase("ObjHeader::Load skip geometry", XPAsset::ObjReadMode::SkipGeometry);
+	    }
+	}
+
+	/**
+	 * @brief Loads the bench X-Plane install
+	 */
+	void AddLibraryCases(std::vector<BenchCase> &OutCases, const BenchSettings &InSettings)
+	{
+	    const fs::path pRoot = InSettings.pDataDir / "xplane";
+	    const fs::path pCurrentPackage = pRoot / "Custom Scenery" / "Bench Airport";
+
+	    std::vector<fs::path> vctPacks;
+	    std::error_code ec;
+	    for (const auto &p : fs::directory_iterator(pRoot / "Custom Scenery", ec))
+	    {
+	        if (p.is_directory() && p.path() != pCurrentPackage)
+	            vctPacks.push_back(p.path());
+	    }
+	    std::ranges::sort(vctPacks);
+
+	    BenchWork Work;
+	    for (const auto &p : FindLibraryFiles(pRoot))
+	    {
+	        const std::string strText = ReadFile(p);
+	        Work.uintLines += CountLines(strText);
+	        Work.uintBytes += strText.size();
+	    }
+
+	    BenchCase Case;
+	    Case.strName = "VirtualFileSystem::LoadFileSystem";
+	    Case.Work = Work;
+	    Case.Run = [pRoot, pCurrentPackage, vctPacks]() {
+	        XPLibrary::VirtualFileSystem Vfs;
+	        Vfs.LoadFileSystem(pRoot, pCurrentPackage, vctPacks);
+	        if (Vfs.GetRegions().empty())
+	            std::abort();
+	    };
+	    OutCases.push_back(std::move(Case));
+	}
+
+	void PrintUsage()
+	{
+	    std::printf("Usage: xplib_bench [--data <dir>] [--filter <text>] [--min-time <seconds>]\n"
+	                "  --data      Folder with the inputs: xplane/ and objects/*.obj, as written by scripts/generate_scenery_corpus.py (default: %s)\n"
+	                "  --filter    Only run cases whose name contains the text\n"
+	                "  --min-time  Minimum seconds per case (default: 0.5)\n",
+	                XPLIB_BENCH_DATA_DIR);
+	}
+}
+
+int main(const int argc, char **argv)
+{
+    BenchSettings Settings;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view svArg = argv[i];
+        if (svArg == "--data" && i + 1 < argc)
+            Settings.pDataDir = argv[++i];
+        else if (svArg == "--filter" && i + 1 < argc)
+            Settings.strFilter = argv[++i];
+        else if (svArg == "--min-time" && i + 1 < argc)
+            Settings.dblMinTime = std::atof(argv[++i]);
+        else
+        {
+            PrintUsage();
+            return svArg == "--help" || svArg == "-h" ? 0 : 1;
+        }
+    }
+
+    if (!fs::is_directory(Settings.pDataDir / "xplane") || !fs::is_directory(Settings.pDataDir / "objects"))
+    {
+        std::fprintf(stderr, "xplib_bench: no inputs in %s\n", Settings.pDataDir.string().c_str());
+        return 1;
+    }
+
+    std::vector<BenchCase> vctCases;
+    AddTokenizerCases(vctCases, Settings);
+    AddLayerGroupCases(vctCases);
+    AddObjCases(vctCases, Settings);
+    AddLibraryCases(vctCases, Settings);
+
+    std::printf("%-48s %8s %10s %14s %10s %12s %10s\n", "case", "iters", "ms/op", "lines/s", "MB/s", "allocs/op", "peak MiB");
+    for (const auto &Case : vctCases)
+    {
+        if (Settings.strFilter.empty() || Case.strName.find(Settings.strFilter) != std::string::npos)
+            RunCase(Case, Settings);
+    }
+
+    return 0;
+}
@@ -62,6 +62,18 @@ TARGET_COMPILE_DEFINITIONS(XPSceneryLib
         $<$<CONFIG:Release>:SEDX_RELEASE>
 )
 
+# The loaders use std::thread
+FIND_PACKAGE(Threads REQUIRED)
+TARGET_LINK_LIBRARIES(XPSceneryLib PUBLIC Threads::Threads)
+
+# Optional profiling zones, see XPProfile.h. Off by default, the zones then compile to nothing.
+IF(XP_SCENERY_LIB_WITH_TRACY)
+    FIND_PACKAGE(tracy CONFIG REQUIRED)
+    TARGET_LINK_LIBRARIES(XPSceneryLib PUBLIC Tracy::TracyClient)
+    TARGET_COMPILE_DEFINITIONS(XPSceneryLib PUBLIC XPLIB_WITH_TRACY)
+    MESSAGE(STATUS "XPSceneryLib: Tracy profiling zones enabled")
+ENDIF()
+
 TARGET_INCLUDE_DIRECTORIES(XPSceneryLib
 	PUBLIC
         ${CMAKE_CURRENT_SOURCE_DIR}/xplib/include
@@ -0,0 +1,260 @@
+#!/usr/bin/env python3
+# -------------------------------------------------------
+# Created: 10/16/2026
+# -------------------------------------------------------
+# Writes a synthetic X-Plane scenery tree for scale testing,
+# so load times can be measured without a licensed install.
+#
+# Layout (the same one xplib_bench --data expects):
+#   <out>/xplane/Resources/default scenery/Default Library NNNN/library.txt
+#   <out>/xplane/Custom Scenery/Pack NNNNN/[Sub NN/]library.txt
+#   <out>/xplane/Custom Scenery/Bench Airport/...   (current package, real files)
+#   <out>/objects/obj_<vertices>v.obj
+#
+# Output only depends on the arguments and the seed.
+# -------------------------------------------------------
+import argparse
+import random
+import shutil
+from pathlib import Path
+
+# Virtual path families, and the extension their assets use
+CATEGORIES = [
+    ("objects/buildings", "obj"),
+    ("objects/vehicles", "obj"),
+    ("objects/trees", "obj"),
+    ("facades", "fac"),
+    ("forests", "for"),
+    ("lines", "lin"),
+    ("polygons", "pol"),
+    ("strings", "str"),
+    ("autogen", "agp"),
+]
+
+# Written into every corpus, so a rerun knows it may replace the folder. Holds the arguments it was made with.
+MARKER = ".scenery_corpus"
+
+SEASONS = ["sum", "win", "spr", "fal"]
+LAYER_GROUPS = ["terrain", "beaches", "shoulders", "taxiways", "runways", "markings", "airports", "roads", "objects", "light_objects", "cars"]
+
+
+def make_virtual_paths(rng, count):
+    """The shared virtual namespace packs export into. Packs overlap on it like real libraries do."""
+    paths = []
+    for i in range(count):
+        category, ext = CATEGORIES[i % len(CATEGORIES)]
+        paths.append(f"corpuslib/{category}/item_{i:05d}.{ext}")
+    rng.shuffle(paths)
+    return paths
+
+
+def real_path_for(rng, virtual):
+    category, name = virtual.rsplit("/", 1)
+    ext = name.rsplit(".", 1)[1]
+    return f"{category.split('/', 1)[1]}/real_{rng.randint(0, 9999):04d}.{ext}"
+
+
+def seasons(rng):
+    return ",".join(sorted(rng.sample(SEASONS, rng.randint(1, 3))))
+
+
+def write_library(path, rng, virtual_paths, exports, region_prefix):
+    """Writes one library.txt using every command LoadFileSystem handles."""
+    lines = ["A", "800", "LIBRARY", ""]
+
+    # A few regions up front, some with datarefs or bitmaps
+    regions = []
+    for r in range(rng.randint(1, 4)):
+        name = f"{region_prefix}_r{r}"
+        regions.append(name)
+        south = rng.randint(-80, 60)
+        west = rng.randint(-179, 150)
+        lines.append(f"REGION_DEFINE {name}")
+        kind = rng.random()
+        if kind < 0.1:
+            lines.append("REGION_ALL")
+        elif kind < 0.15:
+            lines.append(f"REGION_BITMAP {name}.png")
+        else:
+            lines.append(f"REGION_RECT {west} {south} {min(west + rng.randint(2, 40), 180)} {min(south + rng.randint(2, 30), 90)}")
+        if rng.random() < 0.3:
+            lines.append(f"REGION_DREF sim/private/stuff/{name} {rng.choice(['==', '>', '<'])} {rng.randint(0, 3)}")
+        lines.append("")
+
+    for _ in range(exports):
+        roll = rng.random()
+
+        # Block structure: region switches and privacy blocks
+        if roll < 0.02:
+            lines += ["", f"REGION {rng.choice(regions + ['region_all'])}"]
+            continue
+        if roll < 0.03:
+            lines.append(rng.choice(["PRIVATE", "PUBLIC"]))
+            continue
+        if roll < 0.05:
+            lines.append(f"# {rng.choice(['variant', 'TODO', 'legacy'])} {rng.choice(virtual_paths)}")
+            continue
+        if roll < 0.06:
+            lines.append("")
+            continue
+
+        virtual = rng.choice(virtual_paths)
+        real = real_path_for(rng, virtual)
+        roll = rng.random()
+        if roll < 0.45:
+            lines.append(f"EXPORT {virtual} {real}")
+        elif roll < 0.52:
+            lines.append(f"EXPORT_EXTEND {virtual} {real}")
+        elif roll < 0.58:
+            lines.append(f"EXPORT_BACKUP {virtual} {real}")
+        elif roll < 0.68:
+            lines.append(f"EXPORT_RATIO {rng.choice(['0.1', '0.25', '0.5', '1', '2', '4'])} {virtual} {real}")
+        elif roll < 0.72:
+            lines.append(f"EXPORT_EXCLUDE {virtual} {real}")
+        elif roll < 0.82:
+            lines.append(f"EXPORT_SEASON {seasons(rng)} {virtual} {real}")
+        elif roll < 0.87:
+            lines.append(f"EXPORT_EXTEND_SEASON {seasons(rng)} {virtual} {real}")
+        elif roll < 0.95:
+            lines.append(f"EXPORT_RATIO_SEASON {seasons(rng)} {rng.choice(['0.25', '0.5', '1', '3'])} {virtual} {real}")
+        else:
+            lines.append(f"EXPORT_EXCLUDE_SEASON {seasons(rng)} {virtual} {real}")
+
+    path.mkdir(parents=True, exist_ok=True)
+    (path / "library.txt").write_text("\n".join(lines) + "\n", encoding="utf-8", newline="\n")
+
+
+def lod_slices(vertices, lods):
+    """Vertex count of each LOD, halving from the most detailed one. No LODs is one slice holding everything."""
+    if lods <= 0:
+        return [vertices]
+    weights = [0.5 ** k for k in range(lods)]
+    slices = [max(1, int(vertices * w / sum(weights))) for w in weights[:-1]]
+    return slices + [max(1, vertices - sum(slices))]
+
+
+def write_obj(path, rng, vertices, lods):
+    """Writes an OBJ8 with VT, IDX10/IDX and TRIS, split over plain and draped draw calls.
+    With lods > 0 each ATTR_LOD band gets its own vertices, and a single draw call indexing only those."""
+    slices = lod_slices(vertices, lods)
+    vertices = sum(slices)
+    indices = vertices * 3
+    with open(path, "w", encoding="utf-8", newline="\n") as f:
+        f.write("I\n800\nOBJ\n\n")
+        f.write("TEXTURE corpus.png\nTEXTURE_NORMAL corpus_nml.png\nTEXTURE_DRAPED corpus_draped.png\nTEXTURE_DRAPED_NORMAL corpus_draped_nml.png\n")
+        f.write(f"POINT_COUNTS {vertices} 0 0 {indices}\n\n")
+
+        # Written in chunks, Python's per call overhead dominates otherwise
+        chunk = []
+        for _ in range(vertices):
+            chunk.append("VT %.4f %.4f %.4f %.3f %.3f %.3f %.5f %.5f\n" % (
+                rng.uniform(-200, 200), rng.uniform(0, 60), rng.uniform(-200, 200),
+                rng.uniform(-1, 1), rng.uniform(-1, 1), rng.uniform(-1, 1), rng.random(), rng.random()))
+            if len(chunk) >= 8192:
+                f.write("".join(chunk))
+                chunk.clear()
+        f.write("".join(chunk))
+        chunk.clear()
+        f.write("\n")
+
+        # Three indices per vertex, each LOD's only pointing at its own vertices
+        values = []
+        first = 0
+        for count in slices:
+            values += [first + rng.randrange(count) for _ in range(count * 3)]
+            first += count
+
+        for i in range(0, indices - indices % 10, 10):
+            chunk.append("IDX10 " + " ".join(str(v) for v in values[i:i + 10]) + "\n")
+            if len(chunk) >= 8192:
+                f.write("".join(chunk))
+                chunk.clear()
+        for v in values[indices - indices % 10:]:
+            chunk.append(f"IDX {v}\n")
+        f.write("".join(chunk))
+        f.write("\n")
+
+        if lods > 0:
+            f.write(f"ATTR_layer_group {rng.choice(LAYER_GROUPS)} {rng.randint(-5, 5)}\n")
+            near = 0
+            offset = 0
+            for k, count in enumerate(slices):
+                far = 1000 * 4 ** k
+                f.write(f"ATTR_LOD {near} {far}\n")
+                f.write(f"TRIS {offset} {count * 3}\n")
+                near = far
+                offset += count * 3
+            return
+
+        # Three draw calls: plain, draped in another layer group, then plain again
+        third = indices // 3 // 3 * 3
+        f.write(f"ATTR_layer_group {rng.choice(LAYER_GROUPS)} {rng.randint(-5, 5)}\n")
+        f.write(f"TRIS 0 {third}\n")
+        f.write("ATTR_draped\n")
+        f.write(f"ATTR_layer_group_draped {rng.choice(LAYER_GROUPS)} {rng.randint(-5, 5)}\n")
+        f.write(f"TRIS {third} {third}\n")
+        f.write("ATTR_no_draped\n")
+        f.write(f"TRIS {2 * third} {indices - 2 * third}\n")
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="Write a synthetic X-Plane scenery tree for scale testing.")
+    parser.add_argument("out", type=Path, help="Output folder. A corpus already there is replaced, anything else is left alone.")
+    parser.add_argument("--packs", type=int, default=10, help="Custom scenery packs (default: 10)")
+    parser.add_argument("--default-libraries", type=int, default=4, help="Libraries under Resources/default scenery (default: 4)")
+    parser.add_argument("--exports", type=int, default=500, help="Lines per library.txt, roughly (default: 500)")
+    parser.add_argument("--nested", type=float, default=0.2, help="Fraction of packs with several library.txt in sub folders (default: 0.2)")
+    parser.add_argument("--virtual-paths", type=int, default=2000, help="Size of the shared virtual namespace (default: 2000)")
+    parser.add_argument("--package-files", type=int, default=200, help="Real asset files in the current package (default: 200)")
+    parser.add_argument("--obj-vertices", type=int, nargs="*", default=[1000, 100000],
+                        help="Vertex count of each obj to write, 3 indices per vertex. About 75 bytes per vertex on disk. (default: 1000 100000)")
+    parser.add_argument("--obj-lods", type=int, default=0,
+                        help="ATTR_LOD bands per obj, each half the vertices of the one before, from 0-1000 m out by 4x. 0 writes no LODs. (default: 0)")
+    parser.add_argument("--seed", type=int, default=1, help="Random seed (default: 1)")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    rng = random.Random(args.seed)
+
+    # Only ever delete something this script wrote
+    if args.out.exists() and any(args.out.iterdir()):
+        if not (args.out / MARKER).exists():
+            raise SystemExit(f"{args.out} is not empty and wasn't written by this script, refusing to replace it")
+        shutil.rmtree(args.out)
+    args.out.mkdir(parents=True, exist_ok=True)
+    (args.out / MARKER).write_text(" ".join(f"--{k.replace('_', '-')}={v}" for k, v in vars(args).items() if k != "out") + "\n", encoding="utf-8")
+
+    xplane = args.out / "xplane"
+    virtual_paths = make_virtual_paths(rng, args.virtual_paths)
+
+    for i in range(args.default_libraries):
+        write_library(xplane / "Resources" / "default scenery" / f"Default Library {i:04d}", rng, virtual_paths, args.exports, f"ds{i}")
+
+    for i in range(args.packs):
+        pack = xplane / "Custom Scenery" / f"Pack {i:05d}"
+        if rng.random() < args.nested:
+            for sub in range(rng.randint(2, 4)):
+                write_library(pack / f"Sub {sub:02d}", rng, virtual_paths, args.exports // 2, f"cs{i}_{sub}")
+        else:
+            write_library(pack, rng, virtual_paths, args.exports, f"cs{i}")
+
+    # The current package: real files that shadow some of the virtual paths
+    current = xplane / "Custom Scenery" / "Bench Airport"
+    current.mkdir(parents=True, exist_ok=True)
+    for virtual in rng.sample(virtual_paths, min(args.package_files, len(virtual_paths))):
+        real = current / virtual
+        real.parent.mkdir(parents=True, exist_ok=True)
+        real.touch()
+
+    objects = args.out / "objects"
+    objects.mkdir(parents=True, exist_ok=True)
+    for vertices in args.obj_vertices:
+        write_obj(objects / f"obj_{vertices}v.obj", rng, max(vertices, 1), args.obj_lods)
+
+    print(f"Wrote {args.default_libraries} default libraries, {args.packs} packs and {len(args.obj_vertices)} objects to {args.out}")
+
+
+if __name__ == "__main__":
+    main()
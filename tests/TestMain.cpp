@@ -0,0 +1,6 @@
+//Module:	TestMain
+//Author:	Connor Russell
+//Date:		10/17/2026 1:12:40 AM
+//Purpose:	Provides main for the tests when built against Catch2 v2. Catch2 v3 links its own.
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
@@ -0,0 +1,275 @@
+//Module:	XPLibrarySystemTests
+//Author:	Connor Russell
+//Date:		10/17/2026 1:20:16 AM
+//Purpose:	Regression tests for library.txt parsing and the VirtualFileSystem
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <tests/XPTest.h>
+#include <xplib/include/XPLibrarySystem.h>
+
+namespace
+{
+    ///< A region block, a blank line, then exports under it. Every line after the block used to save another unnamed region.
+    constexpr std::string_view REGION_LIBRARY = R"(A
+800
+LIBRARY
+
+REGION_DEFINE north
+REGION_RECT -180 0 180 90
+
+REGION_DEFINE south
+REGION_RECT -180 -90 180 0
+
+REGION north
+EXPORT lib/tree.obj objects/tree_north.obj
+EXPORT lib/house.obj objects/house_north.obj
+
+REGION south
+EXPORT lib/tree.obj objects/tree_south.obj
+EXPORT lib/house.obj objects/house_south.obj
+
+REGION region_all
+EXPORT lib/rock.obj objects/rock.obj
+
+)";
+
+    ///< Virtual paths the random library exports to
+    constexpr int RANDOM_DEFINITIONS = 40;
+
+    /**
+     * @brief Makes a library.txt with overlapping rectangular regions and definitions exported under several of them, with seasons and ratios.
+     * Bounds are whole or half degrees, so points on cell and region edges come up often.
+     */
+    std::string MakeRandomLibrary(std::mt19937 &InOutRng, const int InRegions)
+    {
+        auto Bound = [&](const int InLimit) { return static_cast<double>(static_cast<int>(InOutRng() % (InLimit * 4 + 1)) - InLimit * 2) / 2.0; };
+
+        std::string strLibrary = "A\n800\nLIBRARY\n\n";
+        for (int i = 0; i < InRegions; i++)
+        {
+            double dblLat[2] = {Bound(90), Bound(90)};
+            double dblLon[2] = {Bound(180), Bound(180)};
+            if (i % 2 == 0)
+            {
+                ///< Every other region is small, so some cells are only partly covered
+                dblLat[1] = dblLat[0] + 0.5 * (1 + InOutRng() % 6);
+                dblLon[1] = dblLon[0] + 0.5 * (1 + InOutRng() % 6);
+            }
+            strLibrary += "REGION_DEFINE r" + std::to_string(i) + "\nREGION_RECT " + std::to_string(std::min(dblLon[0], dblLon[1])) + " " + std::to_string(std::min(dblLat[0], dblLat[1])) + " " +
+                std::to_string(std::max(dblLon[0], dblLon[1])) + " " + std::to_string(std::max(dblLat[0], dblLat[1])) + "\n\n";
+        }
+
+        for (int i = 0; i <= InRegions; i++)
+        {
+            strLibrary += i == InRegions ? "REGION region_all\n" : "REGION r" + std::to_string(i) + "\n";
+            for (int d = 0; d < RANDOM_DEFINITIONS; d++)
+            {
+                if (InOutRng() % 3 != 0)
+                    continue;
+
+                const std::string strVirtual = " lib/def" + std::to_string(d) + ".obj ";
+                const std::string strReal = "objects/r" + std::to_string(i) + "/d" + std::to_string(d);
+                strLibrary += "EXPORT" + strVirtual + strReal + "_a.obj\n";
+                strLibrary += "EXPORT_RATIO " + std::to_string(1 + InOutRng() % 4) + strVirtual + strReal + "_b.obj\n";
+                strLibrary += "EXPORT_SEASON sum,win" + strVirtual + strReal + "_sw.obj\n";
+                strLibrary += "EXPORT_RATIO_SEASON sum 0.5" + strVirtual + strReal + "_s.obj\n";
+            }
+            strLibrary += "\n";
+        }
+        return strLibrary;
+    }
+
+    /**
+     * @brief Makes random placement coordinates, a share of them on whole and half degrees, at the poles and antimeridian, or off the globe
+     */
+    std::pair<double, double> MakeRandomPoint(std::mt19937 &InOutRng)
+    {
+        std::uniform_real_distribution<double> Lat(-90, 90);
+        std::uniform_real_distribution<double> Lon(-180, 180);
+        switch (InOutRng() % 8)
+        {
+        case 0:
+            return {std::round(Lat(InOutRng) * 2) / 2, std::round(Lon(InOutRng) * 2) / 2};
+        case 1:
+            return {InOutRng() % 2 ? 90.0 : -90.0, InOutRng() % 2 ? 180.0 : -180.0};
+        case 2:
+            return {Lat(InOutRng) * 1.2, Lon(InOutRng) * 1.2};
+        case 3:
+            return {std::numeric_limits<double>::quiet_NaN(), Lon(InOutRng)};
+        default:
+            return {Lat(InOutRng), Lon(InOutRng)};
+        }
+    }
+
+    /**
+     * @brief Loads a file system from one custom scenery pack
+     */
+    void LoadPack(XPLibrary::VirtualFileSystem &OutVfs, const XPTest::ScratchDir &InDir, const std::string_view InLibrary)
+    {
+        const std::filesystem::path pRoot = InDir.GetPath() / "X-Plane";
+        const std::filesystem::path pPack = pRoot / "Custom Scenery" / "Pack";
+        InDir.Write(pPack / "library.txt", InLibrary);
+        std::filesystem::create_directories(pRoot / "Custom Scenery" / "Current");
+        OutVfs.LoadFileSystem(pRoot, pRoot / "Custom Scenery" / "Current", {pPack});
+    }
+}
+
+TEST_CASE("A region block only saves its own regions", "[library]")
+{
+    const XPTest::ScratchDir Dir("region_count");
+    XPLibrary::VirtualFileSystem Vfs;
+    LoadPack(Vfs, Dir, REGION_LIBRARY);
+
+    const XPLibrary::LoadStats &Stats = Vfs.GetLoadStats();
+    REQUIRE(Stats.vctFiles.size() == 1);
+    CHECK(Stats.vctFiles[0].uintRegions == 2);
+    CHECK(Stats.vctFiles[0].uintDefinitions == 3);
+    CHECK_FALSE(Vfs.GetRegions().contains(""));
+
+    ///< The regions were saved with their bounds, so the exports under them resolve by hemisphere
+    const XPLibrary::DefinitionHandle Tree = Vfs.FindDefinition("lib/tree.obj");
+    REQUIRE(Tree);
+    XPLibrary::RegionMask Mask;
+    for (const auto &[dblLat, svFile] : {std::pair{45.0, "tree_north.obj"}, std::pair{-45.0, "tree_south.obj"}})
+    {
+        Vfs.GetCompatibleRegions(dblLat, 10, Mask);
+        const XPLibrary::RegionalDefinitions *pRegionalDef = Vfs.ResolveRegionalDefinition(Tree, Mask);
+        REQUIRE(pRegionalDef != nullptr);
+        REQUIRE(pRegionalDef->dDefault.GetOptionCount() == 1);
+        CHECK(pRegionalDef->dDefault.GetOptions()[0].second.GetPath().filename() == svFile);
+    }
+}
+
+TEST_CASE("Grid region lookups match the name based walk", "[library]")
+{
+    const XPTest::ScratchDir Dir("region_grid");
+    std::mt19937 Rng(7);
+    XPLibrary::VirtualFileSystem Vfs;
+    LoadPack(Vfs, Dir, MakeRandomLibrary(Rng, 60));
+
+    constexpr std::string_view SEASONS = "dswfp";
+    for (int iPoint = 0; iPoint < 5000; iPoint++)
+    {
+        const auto [dblLat, dblLon] = MakeRandomPoint(Rng);
+        const char chrSeason = SEASONS[Rng() % SEASONS.size()];
+        for (int d = 0; d < RANDOM_DEFINITIONS; d++)
+        {
+            const XPLibrary::DefinitionHandle Handle = Vfs.FindDefinition("lib/def" + std::to_string(d) + ".obj");
+            if (!Handle)
+                continue;
+
+            INFO("lat " << dblLat << " lon " << dblLon << " season " << chrSeason << " def " << d);
+            CHECK(Vfs.GetPath(Handle, dblLat, dblLon, chrSeason) == Vfs.GetDefinition(Handle).GetPath(Vfs.GetRegions(), dblLat, dblLon, chrSeason));
+        }
+    }
+}
+
+TEST_CASE("Batch placement resolution matches resolving one at a time", "[library]")
+{
+    const XPTest::ScratchDir Dir("batch_placements");
+    std::mt19937 Rng(8);
+    XPLibrary::VirtualFileSystem Vfs;
+    LoadPack(Vfs, Dir, MakeRandomLibrary(Rng, 60));
+
+    std::vector<XPLibrary::DefinitionHandle> vctHandles;
+    for (int d = 0; d < RANDOM_DEFINITIONS; d++)
+    {
+        if (const XPLibrary::DefinitionHandle Handle = Vfs.FindDefinition("lib/def" + std::to_string(d) + ".obj"))
+            vctHandles.push_back(Handle);
+    }
+    REQUIRE_FALSE(vctHandles.empty());
+
+    constexpr size_t PLACEMENTS = 50000;
+    constexpr std::string_view SEASONS = "dswfp";
+    std::vector<XPLibrary::DefinitionHandle> vctDefinitions(PLACEMENTS);
+    std::vector<double> vctLat(PLACEMENTS), vctLon(PLACEMENTS);
+    std::vector<char> vctSeasons(PLACEMENTS);
+    for (size_t i = 0; i < PLACEMENTS; i++)
+    {
+        vctDefinitions[i] = vctHandles[Rng() % vctHandles.size()];
+        std::tie(vctLat[i], vctLon[i]) = MakeRandomPoint(Rng);
+        vctSeasons[i] = SEASONS[Rng() % SEASONS.size()];
+    }
+
+    std::vector<XPLibrary::RealPathId> vctPaths(PLACEMENTS);
+    Vfs.ResolvePlacements(vctDefinitions, vctLat, vctLon, vctSeasons, vctPaths);
+
+    size_t uintMismatches = 0;
+    for (size_t i = 0; i < PLACEMENTS; i++)
+    {
+        const std::filesystem::path pExpected = Vfs.GetPath(vctDefinitions[i], vctLat[i], vctLon[i], vctSeasons[i]);
+        const std::filesystem::path pBatch = vctPaths[i] == 0 ? std::filesystem::path() : XPLibrary::ResolveRealPath(vctPaths[i]);
+        uintMismatches += pBatch != pExpected;
+    }
+    CHECK(uintMismatches == 0);
+}
+
+TEST_CASE("EXPORT_RATIO weights reach the options", "[library]")
+{
+    const XPTest::ScratchDir Dir("export_ratio");
+    XPLibrary::VirtualFileSystem Vfs;
+    LoadPack(Vfs, Dir, R"(A
+800
+LIBRARY
+
+EXPORT_RATIO 3 lib/tree.obj objects/tree a.obj
+EXPORT_RATIO 1 lib/tree.obj objects/tree_b.obj
+EXPORT_RATIO_SEASON sum,win 0.25 lib/bush.obj objects/bush.obj
+)");
+
+    const XPLibrary::Definition &Tree = Vfs.GetDefinition(Vfs.FindDefinition("lib/tree.obj"));
+    REQUIRE(Tree.vctRegionalDefs.size() == 1);
+    const auto &vctTreeOptions = Tree.vctRegionalDefs[0].dBackup.GetOptions();
+    REQUIRE(vctTreeOptions.size() == 2);
+    CHECK(vctTreeOptions[0].first == 3);
+    CHECK(vctTreeOptions[0].second.GetPath() == "objects/tree a.obj");
+    CHECK(vctTreeOptions[1].first == 1);
+
+    const XPLibrary::Definition &Bush = Vfs.GetDefinition(Vfs.FindDefinition("lib/bush.obj"));
+    REQUIRE(Bush.vctRegionalDefs.size() == 1);
+    for (const XPLibrary::DefinitionOptions *pOptions : {&Bush.vctRegionalDefs[0].dSummer, &Bush.vctRegionalDefs[0].dWinter})
+    {
+        REQUIRE(pOptions->GetOptionCount() == 1);
+        CHECK(pOptions->GetOptions()[0].first == 0.25);
+    }
+    CHECK(Bush.vctRegionalDefs[0].dFall.GetOptionCount() == 0);
+}
+
+TEST_CASE("Alias table picks match the weights", "[library]")
+{
+    constexpr double WEIGHTS[] = {1, 2, 3, 0, -1, 4};
+    XPLibrary::DefinitionOptions Options;
+    for (size_t i = 0; i < std::size(WEIGHTS); i++)
+    {
+        XPLibrary::DefinitionPath Path;
+        Path.SetPath(std::filesystem::path("pack"), "option" + std::to_string(i) + ".obj");
+        Options.AddOption(Path, WEIGHTS[i]);
+    }
+    Options.BuildAliasTable();
+
+    constexpr int PICKS = 200000;
+    std::vector<int> vctCounts(std::size(WEIGHTS), 0);
+    for (uint64_t uintSeed = 0; uintSeed < PICKS; uintSeed++)
+    {
+        const std::filesystem::path pPicked = Options.PickOption(uintSeed).GetPath();
+        for (size_t i = 0; i < std::size(WEIGHTS); i++)
+            vctCounts[i] += pPicked == "option" + std::to_string(i) + ".obj";
+    }
+
+    ///< Non-positive weights are never picked, the rest within 1.5% of their share
+    constexpr double TOTAL = 1 + 2 + 3 + 4;
+    for (size_t i = 0; i < std::size(WEIGHTS); i++)
+    {
+        INFO("option " << i);
+        if (WEIGHTS[i] <= 0)
+            CHECK(vctCounts[i] == 0);
+        else
+            CHECK(std::abs(vctCounts[i] / static_cast<double>(PICKS) - WEIGHTS[i] / TOTAL) < 0.015);
+    }
+
+    ///< The same seed always picks the same option
+    CHECK(Options.PickOption(12345).GetPath() == Options.PickOption(12345).GetPath());
+}
@@ -0,0 +1,165 @@
+//Module:	XPObjBvhTests
+//Author:	Connor Russell
+//Date:		10/17/2026 1:58:10 AM
+//Purpose:	Regression tests for ObjBvh queries and its cache file
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <tests/XPTest.h>
+#include <xplib/include/XPObjBvh.h>
+
+namespace
+{
+    /**
+     * @brief Makes an object of random triangles in a 100m cube, all in one draw call
+     */
+    XPAsset::Obj MakeRandomObj(std::mt19937 &InOutRng, const size_t InTriangles)
+    {
+        std::uniform_real_distribution<double> Coord(0, 100);
+        std::uniform_real_distribution<double> Offset(-3, 3);
+
+        XPAsset::Obj Obj;
+        for (size_t i = 0; i < InTriangles; i++)
+        {
+            const double dblX = Coord(InOutRng), dblY = Coord(InOutRng), dblZ = Coord(InOutRng);
+            for (int k = 0; k < 3; k++)
+            {
+                Obj.Indices.push_back(Obj.Vertices.size());
+                Obj.Vertices.push_back({dblX + Offset(InOutRng), dblY + Offset(InOutRng), dblZ + Offset(InOutRng), 0, 1, 0, 0, 0});
+            }
+        }
+
+        XPAsset::ObjDrawCall Call{};
+        Call.idxEnd = Obj.Indices.size();
+        Obj.DrawCalls.push_back(Call);
+        return Obj;
+    }
+
+    /**
+     * @brief Double sided Möller–Trumbore, the brute force reference for Raycast
+     *
+     * @returns Distance along the ray, or infinity on a miss
+     */
+    double IntersectTriangle(const std::array<double, 3> &InOrigin, const std::array<double, 3> &InDirection, const std::array<float, 9> &InTriangle)
+    {
+        auto Sub = [&](const size_t a, const size_t b) { return std::array<double, 3>{InTriangle[a] - InTriangle[b], InTriangle[a + 1] - InTriangle[b + 1], InTriangle[a + 2] - InTriangle[b + 2]}; };
+        auto Cross = [](const std::array<double, 3> &a, const std::array<double, 3> &b) { return std::array<double, 3>{a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]}; };
+        auto Dot = [](const std::array<double, 3> &a, const std::array<double, 3> &b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; };
+
+        const std::array<double, 3> Edge1 = Sub(3, 0), Edge2 = Sub(6, 0);
+        const std::array<double, 3> P = Cross(InDirection, Edge2);
+        const double dblDet = Dot(Edge1, P);
+        if (std::abs(dblDet) < 1e-12)
+            return std::numeric_limits<double>::infinity();
+
+        const std::array<double, 3> T = {InOrigin[0] - InTriangle[0], InOrigin[1] - InTriangle[1], InOrigin[2] - InTriangle[2]};
+        const double dblU = Dot(T, P) / dblDet;
+        const std::array<double, 3> Q = Cross(T, Edge1);
+        const double dblV = Dot(InDirection, Q) / dblDet;
+        const double dblT = Dot(Edge2, Q) / dblDet;
+        if (dblU < 0 || dblV < 0 || dblU + dblV > 1 || dblT < 0)
+            return std::numeric_limits<double>::infinity();
+        return dblT;
+    }
+
+    ///< Appends a value's bytes, in the layout ObjBvh::Save writes
+    template <typename T>
+    void Append(std::string &OutBytes, const T &InValue)
+    {
+        OutBytes.append(reinterpret_cast<const char *>(&InValue), sizeof(T));
+    }
+
+    /**
+     * @brief Builds the bytes of a cache file holding the given nodes, and one triangle per leaf slot they can refer to
+     */
+    std::string MakeCacheFile(const std::vector<XPAsset::ObjBvhNode> &InNodes, const uint32_t InTriangles)
+    {
+        std::string strBytes("XPBVHBIN", 8);
+        Append(strBytes, uint32_t{1}); //Version
+        Append(strBytes, uint64_t{0}); //Key
+        Append(strBytes, static_cast<uint64_t>(InNodes.size()));
+        for (const XPAsset::ObjBvhNode &Node : InNodes)
+            Append(strBytes, Node);
+        Append(strBytes, static_cast<uint64_t>(InTriangles));
+        for (uint32_t i = 0; i < InTriangles; i++)
+            Append(strBytes, XPAsset::ObjBvh::Triangle{{0, 0, 0, 1, 0, 0, 0, 0, 1}, i * 3, 0});
+        return strBytes;
+    }
+}
+
+TEST_CASE("Raycast finds the same nearest hit as testing every triangle", "[bvh]")
+{
+    std::mt19937 Rng(4);
+    const XPAsset::Obj Obj = MakeRandomObj(Rng, 2000);
+    XPAsset::ObjBvh Bvh;
+    Bvh.Build(Obj);
+    REQUIRE(Bvh.GetTriangleCount() == 2000);
+
+    std::uniform_real_distribution<double> Coord(-10, 110);
+    for (int iRay = 0; iRay < 500; iRay++)
+    {
+        const std::array<double, 3> Origin = {Coord(Rng), Coord(Rng), Coord(Rng)};
+        const std::array<double, 3> Target = {Coord(Rng), Coord(Rng), Coord(Rng)};
+        const std::array<double, 3> Direction = {Target[0] - Origin[0], Target[1] - Origin[1], Target[2] - Origin[2]};
+
+        double dblNearest = std::numeric_limits<double>::infinity();
+        for (const XPAsset::ObjBvh::Triangle &Triangle : Bvh.GetTriangles())
+            dblNearest = std::min(dblNearest, IntersectTriangle(Origin, Direction, Triangle.arrPositions));
+
+        XPAsset::ObjRayHit Hit;
+        const bool bHit = Bvh.Raycast(Origin, Direction, std::numeric_limits<double>::infinity(), Hit);
+        REQUIRE(bHit == std::isfinite(dblNearest));
+        if (bHit)
+            CHECK(std::abs(Hit.dblDistance - dblNearest) <= 1e-9 * std::max(1.0, dblNearest));
+    }
+}
+
+TEST_CASE("A cached tree round trips, and one with a shared child is rejected", "[bvh]")
+{
+    const XPTest::ScratchDir Dir("bvh_cache");
+
+    SECTION("Built tree")
+    {
+        std::mt19937 Rng(5);
+        XPAsset::ObjBvh Bvh;
+        Bvh.Build(MakeRandomObj(Rng, 500));
+        const std::filesystem::path pCache = Dir.GetPath() / "built.xpbvh";
+        REQUIRE(Bvh.Save(pCache));
+
+        XPAsset::ObjBvh Loaded;
+        REQUIRE(Loaded.Load(pCache));
+        CHECK(Loaded.GetNodeCount() == Bvh.GetNodeCount());
+        CHECK(std::memcmp(Loaded.GetNodes().data(), Bvh.GetNodes().data(), Bvh.GetNodeCount() * sizeof(XPAsset::ObjBvhNode)) == 0);
+    }
+
+    ///< Root with two leaves
+    const XPAsset::ObjBvhNode Root{{0, 0, 0}, 2, {1, 1, 1}, 0};
+    const XPAsset::ObjBvhNode Leaf0{{0, 0, 0}, 0, {1, 1, 1}, 1};
+    const XPAsset::ObjBvhNode Leaf1{{0, 0, 0}, 1, {1, 1, 1}, 1};
+
+    SECTION("Hand built tree")
+    {
+        XPAsset::ObjBvh Loaded;
+        REQUIRE(Loaded.Load(Dir.Write("valid.xpbvh", MakeCacheFile({Root, Leaf0, Leaf1}, 2))));
+        CHECK(Loaded.GetNodeCount() == 3);
+    }
+
+    SECTION("Shared child")
+    {
+        ///< Node 3 is the right child of both the root and node 1. With two parents, its depth could hide behind the shallower one.
+        const XPAsset::ObjBvhNode SharedRoot{{0, 0, 0}, 3, {1, 1, 1}, 0};
+        const XPAsset::ObjBvhNode Inner{{0, 0, 0}, 3, {1, 1, 1}, 0};
+        XPAsset::ObjBvh Loaded;
+        CHECK_FALSE(Loaded.Load(Dir.Write("shared.xpbvh", MakeCacheFile({SharedRoot, Inner, Leaf0, Leaf1}, 2))));
+        CHECK(Loaded.IsEmpty());
+    }
+
+    SECTION("Leaf past the triangles")
+    {
+        XPAsset::ObjBvh Loaded;
+        CHECK_FALSE(Loaded.Load(Dir.Write("leaf.xpbvh", MakeCacheFile({Root, Leaf0, Leaf1}, 1))));
+    }
+}
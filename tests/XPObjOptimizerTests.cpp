@@ -0,0 +1,118 @@
+//Module:	XPObjOptimizerTests
+//Author:	Connor Russell
+//Date:		10/17/2026 1:41:27 AM
+//Purpose:	Regression tests for OptimizeObj
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+#include <tests/XPTest.h>
+#include <xplib/include/XPObjOptimizer.h>
+
+namespace
+{
+    using TrianglePositions = std::array<double, 9>;
+
+    /**
+     * @brief Gets the triangles a draw call draws, by vertex position and in sorted order, so renumbering and reordering don't matter
+     */
+    std::vector<TrianglePositions> GetTriangles(const XPAsset::Obj &InObj, const XPAsset::ObjDrawCall &InCall)
+    {
+        std::vector<TrianglePositions> vctTriangles;
+        for (size_t i = InCall.idxStart; i + 3 <= InCall.idxEnd; i += 3)
+        {
+            TrianglePositions Triangle{};
+            for (size_t k = 0; k < 3; k++)
+            {
+                const XPAsset::Vertex &V = InObj.Vertices[InObj.Indices[i + k]];
+                Triangle[k * 3] = V.X;
+                Triangle[k * 3 + 1] = V.Y;
+                Triangle[k * 3 + 2] = V.Z;
+            }
+            vctTriangles.push_back(Triangle);
+        }
+        std::ranges::sort(vctTriangles);
+        return vctTriangles;
+    }
+
+    /**
+     * @brief Makes an object with random triangles over a few vertices, so the optimizer has reuse to find
+     */
+    XPAsset::Obj MakeRandomObj(std::mt19937 &InOutRng, const size_t InVertices, const size_t InIndices)
+    {
+        XPAsset::Obj Obj;
+        for (size_t i = 0; i < InVertices; i++)
+            Obj.Vertices.push_back({static_cast<double>(i), static_cast<double>(InOutRng() % 100), static_cast<double>(InOutRng() % 100), 0, 1, 0, 0, 0});
+        for (size_t i = 0; i < InIndices; i++)
+            Obj.Indices.push_back(InOutRng() % InVertices);
+        return Obj;
+    }
+
+    /**
+     * @brief Optimizes an object and checks that every draw call still draws the same triangles
+     */
+    void CheckTrianglesKept(XPAsset::Obj &InOutObj)
+    {
+        const XPAsset::Obj Before = InOutObj;
+        XPAsset::OptimizeObj(InOutObj);
+
+        REQUIRE(InOutObj.DrawCalls.size() == Before.DrawCalls.size());
+        for (size_t i = 0; i < Before.DrawCalls.size(); i++)
+        {
+            INFO("Draw call [" << Before.DrawCalls[i].idxStart << ", " << Before.DrawCalls[i].idxEnd << ")");
+            CHECK(GetTriangles(InOutObj, InOutObj.DrawCalls[i]) == GetTriangles(Before, Before.DrawCalls[i]));
+        }
+    }
+}
+
+TEST_CASE("Nested draw calls keep their triangles", "[optimizer]")
+{
+    ///< [3,6) lies inside [0,36) on a triangle boundary, [10,22) inside it off one. Neither is next to [0,36) once sorted.
+    std::mt19937 Rng(1);
+    XPAsset::Obj Obj = MakeRandomObj(Rng, 24, 36);
+    for (const auto &[idxStart, idxEnd] : {std::pair<size_t, size_t>{0, 36}, {3, 6}, {10, 22}})
+    {
+        XPAsset::ObjDrawCall Call{};
+        Call.idxStart = idxStart;
+        Call.idxEnd = idxEnd;
+        Obj.DrawCalls.push_back(Call);
+    }
+
+    CheckTrianglesKept(Obj);
+}
+
+TEST_CASE("Overlapping draw calls keep their triangles", "[optimizer]")
+{
+    std::mt19937 Rng(2);
+    for (int iObj = 0; iObj < 500; iObj++)
+    {
+        XPAsset::Obj Obj = MakeRandomObj(Rng, 40, 90);
+        const size_t uintCalls = 1 + Rng() % 5;
+        for (size_t i = 0; i < uintCalls; i++)
+        {
+            XPAsset::ObjDrawCall Call{};
+            Call.idxStart = Rng() % 88;
+            Call.idxEnd = Call.idxStart + 3 * (1 + Rng() % ((90 - Call.idxStart) / 3));
+            Obj.DrawCalls.push_back(Call);
+        }
+
+        CheckTrianglesKept(Obj);
+    }
+}
+
+TEST_CASE("Separate draw calls are reordered without losing triangles", "[optimizer]")
+{
+    std::mt19937 Rng(3);
+    XPAsset::Obj Obj = MakeRandomObj(Rng, 64, 600);
+    for (size_t idxStart = 0; idxStart < 600; idxStart += 150)
+    {
+        XPAsset::ObjDrawCall Call{};
+        Call.idxStart = idxStart;
+        Call.idxEnd = idxStart + 150;
+        Obj.DrawCalls.push_back(Call);
+    }
+
+    const double dblAcmrBefore = XPAsset::GetAcmr(Obj.Indices);
+    CheckTrianglesKept(Obj);
+    CHECK(XPAsset::GetAcmr(Obj.Indices) < dblAcmrBefore);
+}
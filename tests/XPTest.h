@@ -0,0 +1,60 @@
+//Module:	XPTest
+//Author:	Connor Russell
+//Date:		10/17/2026 1:14:02 AM
+//Purpose:	Common includes and helpers for the tests
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+namespace XPTest
+{
+	/**
+	 * @brief A folder under the temp directory, emptied when created and removed when destroyed
+	 */
+	class ScratchDir
+	{
+	public:
+	    explicit ScratchDir(const std::string_view InName) : pRoot(std::filesystem::temp_directory_path() / "xplib_tests" / InName)
+	    {
+	        std::filesystem::remove_all(pRoot);
+	        std::filesystem::create_directories(pRoot);
+	    }
+
+	    ~ScratchDir()
+	    {
+	        std::error_code ec;
+	        std::filesystem::remove_all(pRoot, ec);
+	    }
+
+	    ScratchDir(const ScratchDir &) = delete;
+	    ScratchDir &operator=(const ScratchDir &) = delete;
+
+	    /**
+	     * @brief Writes a file, creating its folders
+		 *
+		 * @param InRelativePath = Path under the folder
+		 * @param InContents = Contents
+		 * @returns The absolute path
+	     */
+	    std::filesystem::path Write(const std::filesystem::path &InRelativePath, const std::string_view InContents) const
+	    {
+	        const std::filesystem::path pFile = pRoot / InRelativePath;
+	        std::filesystem::create_directories(pFile.parent_path());
+	        std::ofstream ofs(pFile, std::ios::binary);
+	        ofs.write(InContents.data(), static_cast<std::streamsize>(InContents.size()));
+	        return pFile;
+	    }
+
+	    [[nodiscard]] const std::filesystem::path &GetPath() const { return pRoot; }
+
+	private:
+	    std::filesystem::path pRoot;
+	};
+}
@@ -0,0 +1,144 @@
+//Module:	FileUtils
+//Author:	Connor Russell
+//Date:		10/16/2026 9:12:40 AM
+//Purpose:	Provide simple functions to aid in reading and writing files without going through iostreams
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace FileUtils
+{
+	/**
+	 * @brief Read-only memory mapping of an entire file. The mapping is released when the object is destroyed.
+	 * Empty files open successfully and expose an empty view.
+	 */
+	class MappedFile
+	{
+	public:
+	    MappedFile() = default;
+	    ~MappedFile();
+
+	    MappedFile(const MappedFile &) = delete;
+	    MappedFile &operator=(const MappedFile &) = delete;
+	    MappedFile(MappedFile &&InOther) noexcept;
+	    MappedFile &operator=(MappedFile &&InOther) noexcept;
+
+	    /**
+	     * @brief Maps the file into memory, closing any previous mapping first
+		 *
+		 * @param InPath = Path to the file
+		 * @returns True on success, false on failure
+	     */
+	    bool Open(const std::filesystem::path &InPath);
+
+	    /**
+	     * @brief Releases the mapping. Safe to call on a closed file.
+	     */
+	    void Close();
+
+	    [[nodiscard]] bool IsOpen() const { return bOpen; }
+	    [[nodiscard]] const char *Data() const { return pData; }
+	    [[nodiscard]] size_t Size() const { return sizeData; }
+	    [[nodiscard]] std::string_view View() const { return {pData, sizeData}; }
+
+	private:
+	    const char *pData{nullptr};
+	    size_t sizeData{0};
+	    bool bOpen{false};
+	#ifdef _WIN32
+	    void *hFile{nullptr};
+	    void *hMapping{nullptr};
+	#endif
+	};
+
+	/**
+	 * @brief Builds a binary file in memory. Values are written in native byte order, these files are caches for the machine that wrote them, not an interchange format.
+	 */
+	class BinaryWriter
+	{
+	public:
+	    /**
+	     * @brief Appends a trivially copyable value
+	     */
+	    template <typename T>
+	    void Write(const T &InValue)
+	    {
+	        static_assert(std::is_trivially_copyable_v<T>, "BinaryWriter::Write needs a trivially copyable type");
+	        strBuffer.append(reinterpret_cast<const char *>(&InValue), sizeof(T));
+	    }
+
+	    /**
+	     * @brief Appends raw bytes
+	     */
+	    void WriteBytes(const void *InData, const size_t InSize) { strBuffer.append(static_cast<const char *>(InData), InSize); }
+
+	    /**
+	     * @brief Appends a string as a 32-bit length followed by its bytes
+	     */
+	    void WriteString(std::string_view InString);
+
+	    /**
+	     * @brief Appends a path as a UTF-8 string, so it reads back the same regardless of the system code page
+	     */
+	    void WritePath(const std::filesystem::path &InPath);
+
+	    [[nodiscard]] const std::string &GetBuffer() const { return strBuffer; }
+
+	    /**
+	     * @brief Saves the buffer. It is written to a temporary file first and renamed over InPath, so readers never see a half written file.
+		 *
+		 * @param InPath = File to write
+		 * @returns True on success, false on failure
+	     */
+	    [[nodiscard]] bool SaveToFile(const std::filesystem::path &InPath) const;
+
+	private:
+	    std::string strBuffer;
+	};
+
+	/**
+	 * @brief Reads values back out of a buffer made by BinaryWriter. Reading past the end fails, and once a read fails every following read fails too,
+	 * so callers can read a whole record and check IsGood() once.
+	 */
+	class BinaryReader
+	{
+	public:
+	    explicit BinaryReader(const std::string_view InData) : svData(InData) {}
+
+	    /**
+	     * @brief Reads a trivially copyable value
+	     */
+	    template <typename T>
+	    bool Read(T &OutValue)
+	    {
+	        static_assert(std::is_trivially_copyable_v<T>, "BinaryReader::Read needs a trivially copyable type");
+	        return ReadBytes(&OutValue, sizeof(T));
+	    }
+
+	    /**
+	     * @brief Reads raw bytes
+	     */
+	    bool ReadBytes(void *OutData, size_t InSize);
+
+	    /**
+	     * @brief Reads a string written by WriteString
+	     */
+	    bool ReadString(std::string &OutString);
+
+	    /**
+	     * @brief Reads a path written by WritePath
+	     */
+	    bool ReadPath(std::filesystem::path &OutPath);
+
+	    [[nodiscard]] bool IsGood() const { return bGood; }
+	    [[nodiscard]] size_t GetRemaining() const { return svData.size(); }
+
+	private:
+	    std::string_view svData;
+	    bool bGood{true};
+	};
+} // namespace FileUtils
@@ -0,0 +1,81 @@
+//Module:	HashUtils
+//Author:	Connor Russell
+//Date:		10/16/2026 1:21:08 PM
+//Purpose:	Provide stable hashes. Unlike std::hash these give the same value on every platform and run, so they can be saved to disk.
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+namespace HashUtils
+{
+	static constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+	static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+	/**
+	 * @brief 64-bit FNV-1a over a run of bytes
+	 *
+	 * @param InData = Bytes to hash
+	 * @param InSize = Number of bytes
+	 * @param InSeed = Running hash to continue from. Use FNV_OFFSET to start a new hash.
+	 * @returns The hash
+	 */
+	constexpr uint64_t Fnv1a(const char *InData, const size_t InSize, uint64_t InSeed = FNV_OFFSET)
+	{
+	    for (size_t i = 0; i < InSize; i++)
+	    {
+	        InSeed ^= static_cast<uint8_t>(InData[i]);
+	        InSeed *= FNV_PRIME;
+	    }
+	    return InSeed;
+	}
+
+	/**
+	 * @brief 64-bit FNV-1a over a string
+	 */
+	constexpr uint64_t Fnv1a(const std::string_view InString, const uint64_t InSeed = FNV_OFFSET)
+	{
+	    return Fnv1a(InString.data(), InString.size(), InSeed);
+	}
+
+	/**
+	 * @brief Folds a value into a running hash
+	 *
+	 * @param InSeed = Running hash
+	 * @param InValue = Value to add
+	 * @returns The combined hash
+	 */
+	constexpr uint64_t Combine(const uint64_t InSeed, const uint64_t InValue)
+	{
+	    uint64_t Hash = InSeed;
+	    for (int i = 0; i < 8; i++)
+	    {
+	        Hash ^= (InValue >> (i * 8)) & 0xFF;
+	        Hash *= FNV_PRIME;
+	    }
+	    return Hash;
+	}
+
+	/**
+	 * @brief Scrambles a 64-bit value so every output bit depends on every input bit (the splitmix64 finalizer). Use it to turn a hash into random bits.
+	 */
+	constexpr uint64_t Mix64(uint64_t InValue)
+	{
+	    InValue ^= InValue >> 30;
+	    InValue *= 0xBF58476D1CE4E5B9ull;
+	    InValue ^= InValue >> 27;
+	    InValue *= 0x94D049BB133111EBull;
+	    InValue ^= InValue >> 31;
+	    return InValue;
+	}
+
+	/**
+	 * @brief Transparent string hasher for unordered containers, so lookups can take a string_view or const char* without building a std::string.
+	 * Use with std::equal_to<>.
+	 */
+	struct StringHash
+	{
+	    using is_transparent = void;
+
+	    size_t operator()(const std::string_view InString) const noexcept { return static_cast<size_t>(Fnv1a(InString)); }
+	};
+}; // namespace HashUtils
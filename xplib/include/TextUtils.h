@@ -3,20 +3,197 @@
 //Date:		10/8/2024 7:40:54 PM
 //Purpose:	Provide a simple functions to aid in parsing text
 #pragma once
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <initializer_list>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <vector>
+#include <xplib/include/HashUtils.h>
 
 namespace TextUtils
 {
 	/**
-	 * @brief Reads an entire line into tokens based on delimiting chars. Delimiting char/newline are removed from stream.
+	 * @brief A set of ASCII delimiter characters, tested with one lookup into a 256 bit table. Bytes with the high bit set are never delimiters, they are ignored when building the set.
+	 */
+	class DelimiterSet
+	{
+	public:
+	    constexpr DelimiterSet() = default;
+
+	    constexpr DelimiterSet(const std::initializer_list<char> InChars)
+	    {
+	        for (const char c : InChars)
+	            Add(c);
+	    }
+
+	    constexpr void Add(const char InChar)
+	    {
+	        const auto uintChar = static_cast<unsigned char>(InChar);
+	        if (uintChar < 0x80)
+	            arrBits[uintChar >> 6] |= uint64_t{1} << (uintChar & 63);
+	    }
+
+	    [[nodiscard]] constexpr bool Contains(const char InChar) const
+	    {
+	        const auto uintChar = static_cast<unsigned char>(InChar);
+	        return (arrBits[uintChar >> 6] >> (uintChar & 63)) & 1;
+	    }
+
+	private:
+	    std::array<uint64_t, 4> arrBits{};
+	};
+
+	///< ' ', '\t', '\n' and '\r'
+	inline constexpr DelimiterSet WHITESPACE{' ', '\t', '\n', '\r'};
+
+	/**
+	 * @brief Takes the next token off the front of a string, without allocating. Leading delimiters are skipped, and the delimiter ending the token is consumed.
+	 * A byte right after one with the high bit set is never a delimiter, so UTF-8 sequences stay inside their token.
+	 *
+	 * @param InOutRest = Text left to tokenize. Advanced past the token and its delimiter.
+	 * @param OutToken = Set to the token, a view into InOutRest's buffer
+	 * @param InDelimiters = Delimiters
+	 * @returns True if a token was found, false if only delimiters were left
+	 */
+	bool NextToken(std::string_view &InOutRest, std::string_view &OutToken, const DelimiterSet &InDelimiters = WHITESPACE);
+
+	/**
+	 * @brief Splits a string into tokens without allocating, as long as OutTokens has the capacity. Empty tokens are skipped. Same rules as NextToken.
+	 *
+	 * @param InString = String to tokenize. The tokens point into it, so it must outlive them.
+	 * @param OutTokens = Cleared, then filled with the tokens. Reuse it between calls so its capacity is kept.
+	 * @param InDelimiters = Delimiters
+	 * @returns The number of tokens
+	 */
+	size_t TokenizeString(std::string_view InString, std::vector<std::string_view> &OutTokens, const DelimiterSet &InDelimiters = WHITESPACE);
+
+	/**
+	 * @brief Reads an entire line into tokens based on delimiting chars. Same rules as NextToken, but every token is copied. Prefer the string_view overload in hot loops.
 	 *
 	 * @param InString String to read from
-	 * @param InStream Input stream to read from
-	 * @param DelimitingChars Characters to use as delimiters. If empty, defaults to whitespace (' ', '\t', '\n', '\r')
-	 * @returns Pointer to vector of strings that will hold the tokens (not cleared before adding tokens)
+	 * @param DelimitingChars Characters to use as delimiters. Must be ASCII.
+	 * @returns The tokens
      */
-	std::vector<std::string> TokenizeString(const std::string &InString, std::vector<char> DelimitingChars);
+	std::vector<std::string> TokenizeString(const std::string &InString, const std::vector<char> &DelimitingChars);
+
+	/**
+	 * @brief Gets what follows a token on its line, trimmed of whitespace. For trailing arguments that may contain spaces, like real paths in a library.txt.
+	 *
+	 * @param InLine = Line the token was taken from
+	 * @param InToken = Token, a view into InLine
+	 * @returns A view into InLine, empty if nothing but whitespace follows the token
+	 */
+	std::string_view GetRestOfLine(std::string_view InLine, std::string_view InToken);
+
+	/**
+	 * @brief Parses a number the way stof/stod/stoi would, without allocating: a leading '+' is accepted and trailing characters are ignored
+	 *
+	 * @param InToken = Token to parse
+	 * @param OutValue = Parsed value. Left unchanged on failure.
+	 * @returns True if a number was read, false if there were no digits or it was out of range (where stof/stod/stoi throw)
+	 */
+	template <typename T>
+	bool ParseNumber(std::string_view InToken, T &OutValue)
+	{
+	    if (InToken.size() > 1 && InToken[0] == '+' && InToken[1] != '-')
+	        InToken.remove_prefix(1);
+
+	    const auto [ptr, ec] = std::from_chars(InToken.data(), InToken.data() + InToken.size(), OutValue);
+	    return ec == std::errc();
+	}
+
+	/**
+	 * @brief A keyword and the value it stands for, for KeywordTable
+	 */
+	template <typename T>
+	class Keyword
+	{
+	public:
+	    std::string_view svText;
+	    T Value{};
+	};
+
+	/**
+	 * @brief Maps a token to the value of its keyword in one step: one hash, one slot, one string compare. The hash is perfect for the keywords it was built from,
+	 * the seed that makes it so is searched for at compile time. Declare it constexpr next to its keyword list:
+	 *
+	 * constexpr TextUtils::Keyword<Command> KEYWORDS[] = {{"EXPORT", Command::Export}, {"REGION", Command::Region}};
+	 * constexpr TextUtils::KeywordTable COMMANDS(KEYWORDS, Command::Unknown);
+	 *
+	 * Duplicate keywords fail to compile.
+	 */
+	template <typename T, size_t N>
+	class KeywordTable
+	{
+	public:
+	    consteval KeywordTable(const Keyword<T> (&InKeywords)[N], const T InUnknown)
+	    {
+	        for (size_t i = 0; i < N; i++)
+	        {
+	            for (size_t j = i + 1; j < N; j++)
+	            {
+	                if (InKeywords[i].svText == InKeywords[j].svText)
+	                    throw "KeywordTable: a keyword is listed twice";
+	            }
+	        }
+
+	        while (true)
+	        {
+	            if (uintSeed > 10000)
+	                throw "KeywordTable: no perfect hash found, the table is meant for tens of keywords";
+
+	            std::array<bool, SLOTS> arrUsed{};
+	            bool bCollision = false;
+	            for (const auto &Entry : InKeywords)
+	            {
+	                const size_t idx = GetSlot(Entry.svText, uintSeed);
+	                bCollision = bCollision || arrUsed[idx];
+	                arrUsed[idx] = true;
+	            }
+	            if (!bCollision)
+	                break;
+	            uintSeed++;
+	        }
+
+	        ///< Empty slots hold the unknown value, and an empty keyword no token can match
+	        for (auto &Slot : arrSlots)
+	            Slot.Value = InUnknown;
+	        for (const auto &Entry : InKeywords)
+	            arrSlots[GetSlot(Entry.svText, uintSeed)] = Entry;
+	        UnknownValue = InUnknown;
+	    }
+
+	    /**
+	     * @brief Finds a token's value
+		 *
+		 * @param InToken = Token, case sensitive
+		 * @returns The keyword's value, or the unknown value if the token isn't a keyword
+	     */
+	    [[nodiscard]] constexpr T Find(const std::string_view InToken) const
+	    {
+	        const Keyword<T> &Entry = arrSlots[GetSlot(InToken, uintSeed)];
+	        return !InToken.empty() && Entry.svText == InToken ? Entry.Value : UnknownValue;
+	    }
+
+	private:
+	    ///< 4 slots per keyword, so a collision free seed turns up within a few tries
+	    static constexpr size_t SLOTS = std::bit_ceil(N * 4);
+	    static constexpr int SLOT_BITS = std::countr_zero(SLOTS);
+
+	    ///< The top bits of FNV-1a are the best mixed
+	    static constexpr size_t GetSlot(const std::string_view InText, const uint64_t InSeed)
+	    {
+	        return static_cast<size_t>(HashUtils::Fnv1a(InText, HashUtils::FNV_OFFSET ^ InSeed) >> (64 - SLOT_BITS));
+	    }
+
+	    std::array<Keyword<T>, SLOTS> arrSlots{};
+	    uint64_t uintSeed{0};
+	    T UnknownValue{};
+	};
 
 	/**
 	 * @brief Trims whitespace from the beginning and end of a string. Does not modify the original string. Whitespace is ' ', '\t', '\n', '\r'
@@ -0,0 +1,29 @@
+//Module:	ThreadUtils
+//Author:	Connor Russell
+//Date:		10/16/2026 11:02:17 AM
+//Purpose:	Provide simple functions to spread work across threads
+#pragma once
+#include <cstddef>
+#include <functional>
+
+namespace ThreadUtils
+{
+	/**
+	 * @brief Runs InFunc(i) for every i in [0, InCount) on a pool of worker threads, and blocks until they are all done.
+	 * Indices are handed out one at a time so uneven items balance themselves. The calling thread works too.
+	 * If a worker throws, no further indices are handed out and the first exception is rethrown on the calling thread.
+	 *
+	 * @param InCount = Number of items
+	 * @param InFunc = Work function, called exactly once per index. Must be safe to call concurrently.
+	 * @param InMaxThreads = Upper bound on the number of threads used. 0 uses std::thread::hardware_concurrency()
+	 */
+	void ParallelFor(size_t InCount, const std::function<void(size_t)> &InFunc, size_t InMaxThreads = 0);
+
+	/**
+	 * @brief Gets the number of threads ParallelFor would use for a given upper bound
+	 *
+	 * @param InMaxThreads = Upper bound, 0 for no bound
+	 * @returns The thread count, always at least 1
+	 */
+	size_t GetWorkerCount(size_t InMaxThreads = 0);
+}; // namespace ThreadUtils
@@ -4,6 +4,7 @@
 //Purpose:
 #pragma once
 #include <string>
+#include <string_view>
 
 namespace XPLayerGroups
 {
@@ -20,13 +21,13 @@ namespace XPLayerGroups
 	extern const int CARS;
 
     /**
-     * @brief Resolves a layer group to a vertical offset
+     * @brief Resolves a layer group to a vertical offset. Doesn't allocate.
 	 *
-	 * @param InGroup = Layer group
+	 * @param InGroup = Layer group. Surrounding whitespace is ignored, unknown groups resolve as terrain.
 	 * @param InOffset = Offset from group
 	 * @return Vertical offset for proper layering
      */
-    int Resolve(std::string InGroup, int InOffset);
+    int Resolve(std::string_view InGroup, int InOffset);
 
     /**
      * @brief Resolves a vertical offset to a layer group
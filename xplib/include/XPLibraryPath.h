@@ -3,11 +3,16 @@
 //Date:		10/12/2024 2:32:01 PM
 //Purpose:	Provides abstractions for the X-Plane library system's paths and conditions
 #pragma once
+#include <bit>
+#include <cstdint>
 #include <filesystem>
 #include <map>
 #include <string>
 #include <tuple>
 #include <vector>
+#include <xplib/include/HashUtils.h>
+#include <xplib/include/XPPathTable.h>
+#include <xplib/include/XPProfile.h>
 
 
 namespace XPLibrary
@@ -17,33 +22,63 @@ namespace XPLibrary
 	static constexpr char SEASON_WINTER = 'w';
 	static constexpr char SEASON_FALL = 'f';
 	static constexpr char SEASON_SPRING = 'p';
+
+	///< A real path as a package PathId in the high 32 bits and a relative PathId in the low 32 bits. 0 is the empty path.
+	using RealPathId = uint64_t;
+
+	///< Numeric ID of a region in a VirtualFileSystem's region table
+	using RegionId = uint32_t;
+	static constexpr RegionId INVALID_REGION = UINT32_MAX;
 	
 	/**
 	 * @brief DefinitionPaths are the individual paths that make up a definition.
 	 * They consist of their relative path, and their base path (base path being the parent folder of the library.txt, or the scenery package they are from).
-	 * Concat to get the absolute path
+	 * Concat to get the absolute path. Both are interned in the PathTable, so a DefinitionPath is only a couple of IDs.
 	 */
 	class DefinitionPath
 	{
 	public:
 	    ///< Package path (i.e. the package)
-	    std::filesystem::path pPackagePath;
-	    ///< Full real path
-	    std::filesystem::path pRealPath;
+	    PathId idPackagePath{0};
 	    ///< Relative path
-	    std::filesystem::path pPath;
+	    PathId idPath{0};
 
         void SetPath(const std::filesystem::path &InBasePath, const std::filesystem::path &InRelativePath)
 	    {
-	        pPackagePath = InBasePath;
-	        pRealPath = InBasePath / InRelativePath;
-	        pPath = InRelativePath;
+	        SetPath(InternPath(InBasePath), InRelativePath);
+	    }
+
+	    ///< Overload for callers that add many paths from the same package, and intern it once
+        void SetPath(const PathId InBasePath, const std::filesystem::path &InRelativePath)
+	    {
+	        idPackagePath = InBasePath;
+	        idPath = InternPath(InRelativePath);
 	    }
+
+	    ///< Package path (i.e. the package)
+	    [[nodiscard]] const std::filesystem::path &GetPackagePath() const { return ResolvePath(idPackagePath); }
+	    ///< Relative path
+	    [[nodiscard]] const std::filesystem::path &GetPath() const { return ResolvePath(idPath); }
+	    ///< Full real path, built on demand
+	    [[nodiscard]] std::filesystem::path GetRealPath() const { return idPath == 0 ? std::filesystem::path() : GetPackagePath() / GetPath(); }
+	    ///< Full real path as a single ID, for comparing and grouping without building the path
+	    [[nodiscard]] RealPathId GetRealPathId() const { return static_cast<RealPathId>(idPackagePath) << 32 | idPath; }
 	
 	    ///< Whether it's from a library. If false it's local to that package.
 	    bool bFromLibrary{false};
 	};
 	
+	/**
+	 * @brief Builds the real path for a RealPathId
+	 */
+	inline std::filesystem::path ResolveRealPath(const RealPathId InId)
+	{
+	    DefinitionPath DefPath;
+	    DefPath.idPackagePath = static_cast<PathId>(InId >> 32);
+	    DefPath.idPath = static_cast<PathId>(InId);
+	    return DefPath.GetRealPath();
+	}
+	
 	/**
 	 * @brief DefinitionOptions is a container that holds all objects that are valid under certain circumstances,
 	 * and would be randomly intermixed based on a weighted system.
@@ -55,6 +90,16 @@ namespace XPLibrary
 	
 	    ///< The options for the definition
 	    std::vector<std::pair<double, DefinitionPath>> vctOptions;
+
+	    ///< Alias table entry. Column i picks option i with dblProbability, otherwise option idxAlias.
+	    struct AliasEntry
+	    {
+	        double dblProbability{1};
+	        uint32_t idxAlias{0};
+	    };
+
+	    ///< Alias table for O(1) picks. Only used while it matches vctOptions, see BuildAliasTable.
+	    std::vector<AliasEntry> vctAlias;
 	
 	public:
 	    /**
@@ -67,27 +112,28 @@ namespace XPLibrary
 	    {
 	        vctOptions.emplace_back(InRatio, InPath);
 	        dblTotalRatio += InRatio;
+	        vctAlias.clear();
 	    }
-	
+
 	    /**
-	     * @brief Gets a random option based on the ratios
-		 */
-        DefinitionPath GetRandomOption()
-	    {
-	        if (vctOptions.empty())
-                return {};
+	     * @brief Builds the alias table, making PickOption O(1). Must be called again after the options change.
+		 * VirtualFileSystem does this for every definition it builds.
+	     */
+	    void BuildAliasTable();
 
-            double dblRand = static_cast<double>(rand()) / RAND_MAX * dblTotalRatio;
-	
-	        for (auto &[fst, snd] : vctOptions)
-	        {
-	            dblRand -= fst;
-	            if (dblRand <= 0)
-                    return snd;
-            }
+	    /**
+	     * @brief Picks an option based on the ratios, the same way every time for the same seed. Thread-safe.
+		 * O(1) once BuildAliasTable has been called, otherwise a linear scan. The two can pick differently for the same seed.
+		 *
+		 * @param InSeed = Seed, e.g. from MakePlacementSeed
+		 * @returns The option, or an empty path if there are none
+	     */
+	    [[nodiscard]] DefinitionPath PickOption(uint64_t InSeed) const;
 	
-	        return vctOptions[0].second;
-	    }
+	    /**
+	     * @brief Gets a random option based on the ratios. Thread-safe, but not reproducible, use PickOption for that.
+		 */
+        [[nodiscard]] DefinitionPath GetRandomOption() const;
 	
 	    /**
 	     * @brief Resets the options. Useful for EXPORT_EXCLUDE where you're overwriting every other option
@@ -96,6 +142,7 @@ namespace XPLibrary
 	    {
 	        vctOptions.clear();
 	        dblTotalRatio = 0;
+	        vctAlias.clear();
 	    }
 	
 	    /**
@@ -104,10 +151,34 @@ namespace XPLibrary
         [[nodiscard]] size_t GetOptionCount() const { return vctOptions.size(); }
 	
 	    /**
-	     * @brief Returns the options, along with their weights
+	     * @brief Returns the options, along with their weights. Call BuildAliasTable again after changing weights through this.
 		 */
         std::vector<std::pair<double, DefinitionPath>> &GetOptions() { return vctOptions; }
+        [[nodiscard]] const std::vector<std::pair<double, DefinitionPath>> &GetOptions() const { return vctOptions; }
+
+	    /**
+	     * @brief Adds the options and the alias table to a memory count. The count is the options, the alias table only adds bytes.
+		 */
+        void AddMemoryUsage(ProfileUtils::MemoryUsage &InOutUsage) const
+	    {
+	        InOutUsage.AddVector(vctOptions);
+	        InOutUsage.uintBytes += vctAlias.size() * sizeof(AliasEntry);
+	        InOutUsage.uintCapacity += vctAlias.capacity() * sizeof(AliasEntry);
+	    }
 	};
+
+	/**
+	 * @brief Makes a stable seed for a placement, so the same definition at the same spot always gets the same variant, on every run and every thread
+	 *
+	 * @param InDefinitionHash = Definition::uintPathHash
+	 * @param InLat = Latitude of the placement
+	 * @param InLon = Longitude of the placement
+	 * @returns The seed
+	 */
+	inline uint64_t MakePlacementSeed(const uint64_t InDefinitionHash, const double InLat, const double InLon)
+	{
+	    return HashUtils::Combine(HashUtils::Combine(InDefinitionHash, std::bit_cast<uint64_t>(InLat)), std::bit_cast<uint64_t>(InLon));
+	}
 	
 	/**
 	 * @brief The region parameters. These are referenced by the definitions, and are used to determine if an object is compatible with a region. They have their own data structure so they can be shared. Should be used in a map with the name being the key
@@ -140,6 +211,9 @@ namespace XPLibrary
 	public:
 	    ///< The region name
 	    std::string strRegionName;
+
+	    ///< The region's ID, assigned by the VirtualFileSystem once the definition is built
+	    RegionId idRegion{INVALID_REGION};
 	
 	    DefinitionOptions dSummer;
 	    DefinitionOptions dWinter;
@@ -149,23 +223,42 @@ namespace XPLibrary
 	    DefinitionOptions dBackup;
 	
 	    /**
-	     * @brief Returns the path for the given season. If the season is not found, the default path is returned.
+	     * @brief Returns the options for the given season. If the season is not found, the default options are returned, or the backups if there are no defaults.
 		 */
-        DefinitionPath GetVersion(const char InSeason)
+        [[nodiscard]] const DefinitionOptions &GetSeasonOptions(const char InSeason) const
 	    {
 	        switch (InSeason)
 	        {
 				case 's':
-				case 'd': return dSummer.GetRandomOption();
-				case 'w': return dWinter.GetRandomOption();
-				case 'f': return dFall.GetRandomOption();
-				case 'p': return dSpring.GetRandomOption();
+				case 'd': return dSummer;
+				case 'w': return dWinter;
+				case 'f': return dFall;
+				case 'p': return dSpring;
 	        }
 	
 	        if (dDefault.GetOptionCount() != 0)
-                return dDefault.GetRandomOption();
+                return dDefault;
 
-            return dBackup.GetRandomOption();
+            return dBackup;
+	    }
+
+	    /**
+	     * @brief Returns the path for the given season. If the season is not found, the default path is returned.
+		 */
+        [[nodiscard]] DefinitionPath GetVersion(const char InSeason) const { return GetSeasonOptions(InSeason).GetRandomOption(); }
+
+	    /**
+	     * @brief Returns the path for the given season, picked with a seed so it is the same every time. If the season is not found, the default path is returned.
+		 */
+        [[nodiscard]] DefinitionPath GetVersion(const char InSeason, const uint64_t InSeed) const { return GetSeasonOptions(InSeason).PickOption(InSeed); }
+
+	    /**
+	     * @brief Builds the alias tables of every season
+		 */
+        void BuildAliasTables()
+	    {
+	        for (DefinitionOptions *pOptions : {&dSummer, &dWinter, &dFall, &dSpring, &dDefault, &dBackup})
+	            pOptions->BuildAliasTable();
 	    }
 	};
 	
@@ -180,9 +273,21 @@ namespace XPLibrary
 	
 	    ///Whether this is a private asset. A single instance of it being private will make *all* variants private.
 	    bool bIsPrivate{false};
+
+	    ///Stable hash of the virtual path, used to seed variant picks. Set by the VirtualFileSystem, computed on the fly if 0.
+	    uint64_t uintPathHash{0};
+
+	    /**
+	     * @brief Gets the seed for placing this definition at a location
+	     */
+        [[nodiscard]] uint64_t GetPlacementSeed(const double InLat, const double InLon) const
+	    {
+	        return MakePlacementSeed(uintPathHash != 0 ? uintPathHash : HashUtils::Fnv1a(pVirtual.generic_string()), InLat, InLon);
+	    }
 	
 	    /**
 	     * @brief Returns the path for the given season. If the season is not found, the default path is returned.
+		 * The variant is picked with GetPlacementSeed, so the same location always gets the same variant.
 		 *
 		 * @param InRegionDefinitions = The region definitions to use
 		 * @param Inlat = The latitude of the object
@@ -190,18 +295,18 @@ namespace XPLibrary
 		 * @param InSeason = Optional, the season to get this asset for
 		 * @returns The absolute asset path
 	     */
-        std::filesystem::path GetPath(const std::map<std::string, XPLibrary::Region> &InRegionDefinitions, const double Inlat, const double InLon, const char InSeason = XPLibrary::SEASON_DEFAULT)
+        [[nodiscard]] std::filesystem::path GetPath(const std::map<std::string, XPLibrary::Region> &InRegionDefinitions, const double Inlat, const double InLon, const char InSeason = XPLibrary::SEASON_DEFAULT) const
 	    {
 	        if (vctRegionalDefs.empty())
                 return "";
 
-            for (auto &r : vctRegionalDefs)
+            for (const auto &r : vctRegionalDefs)
 	        {
-	            ///< Get the region
-                if (const auto ThisRegion = InRegionDefinitions.find(r.strRegionName); ThisRegion->second.CompatibleWith(Inlat, InLon))
+	            ///< Get the region. Regions that were never defined can't match anything.
+                if (const auto ThisRegion = InRegionDefinitions.find(r.strRegionName); ThisRegion != InRegionDefinitions.end() && ThisRegion->second.CompatibleWith(Inlat, InLon))
 	            {
-	                auto DefPath = r.GetVersion(InSeason);
-	                return DefPath.pRealPath;
+	                auto DefPath = r.GetVersion(InSeason, GetPlacementSeed(Inlat, InLon));
+	                return DefPath.GetRealPath();
 	            }
 	        }
 	
@@ -223,7 +328,7 @@ namespace XPLibrary
 	        ///< Add the region since it doesn't exist
 	        RegionalDefinitions NewRegion;
 	        NewRegion.strRegionName = InRegionName;
-	        vctRegionalDefs.push_back(NewRegion);
+	        vctRegionalDefs.push_back(std::move(NewRegion));
 	
 	        return vctRegionalDefs.size() - 1;
 	    }
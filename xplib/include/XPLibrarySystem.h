@@ -4,41 +4,276 @@
 //Purpose:
 
 #pragma once
+#include <cstdint>
 #include <filesystem>
 #include <map>
+#include <set>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
+#include <xplib/include/HashUtils.h>
 #include <xplib/include/XPLibraryPath.h>
+#include <xplib/include/XPProfile.h>
+#include <xplib/include/XPRegionIndex.h>
 
 namespace XPLibrary
 {
 
+	/**
+	 * @brief A library.txt found while scanning, with the size and modification time used to tell whether it changed
+	 */
+	class LibraryFile
+	{
+	public:
+	    std::filesystem::path pPackagePath; ///< The folder the library.txt is in
+	    std::filesystem::path pLibraryPath; ///< The library.txt itself
+	    uintmax_t uintSize{0};
+	    int64_t intModified{0}; ///< last_write_time, in file clock ticks
+
+	    /**
+	     * @brief Whether the file has the same size and modification time as another scan of it
+	     */
+	    [[nodiscard]] bool SameStamp(const LibraryFile &InOther) const { return uintSize == InOther.uintSize && intModified == InOther.intModified; }
+	};
+
+	/**
+	 * @brief What parsing one library.txt took, to find slow packs
+	 */
+	class LibraryFileStats
+	{
+	public:
+	    std::filesystem::path pLibraryPath;
+	    uint64_t uintBytes{0};
+	    uint64_t uintLines{0};
+	    uint64_t uintDefinitions{0}; ///< Virtual paths the file exports to
+	    uint64_t uintRegions{0};     ///< Regions the file defines
+	    double dblParseMs{0};        ///< Wall time on the worker that parsed it
+	    ProfileUtils::MemoryUsage Memory; ///< Heap held by the parse result, which is kept for Reload. The count is the definitions in it.
+	};
+
+	/**
+	 * @brief What the last LoadFileSystem or Reload did, and how long each phase took. Times are wall time in milliseconds.
+	 */
+	class LoadStats
+	{
+	public:
+	    bool bFromSnapshot{false};
+	    uint64_t uintLibraryFilesScanned{0}; ///< library.txt files found
+	    uint64_t uintPackageFilesScanned{0}; ///< Real files found in the current package
+	    uint64_t uintLibraryFilesParsed{0};  ///< Reload only parses the files that changed
+	    uint64_t uintBytesRead{0};           ///< library.txt and snapshot bytes
+	    uint64_t uintLinesParsed{0};
+	    uint64_t uintDefinitionsCreated{0}; ///< Definitions built, read from the snapshot, or rebuilt by Reload
+	    uint64_t uintRegions{0};            ///< Regions after the load
+
+	    double dblScanMs{0};     ///< Finding library.txt and package files
+	    double dblSnapshotMs{0}; ///< Reading and writing the snapshot
+	    double dblParseMs{0};    ///< Parsing library.txt files, across all workers
+	    double dblBuildMs{0};    ///< Merging definitions, building regions and the indices
+	    double dblTotalMs{0};
+
+	    ///< Every library.txt parsed, in priority order. Sort by dblParseMs to find the slow ones.
+	    std::vector<LibraryFileStats> vctFiles;
+	};
+
+	/**
+	 * @brief Everything a single library.txt contributes. Each file is parsed into one of these on its own, so files can be parsed in parallel, then they are merged in priority order.
+	 */
+	class LibraryFileResult
+	{
+	public:
+	    ///< Definitions this file touched, holding only this file's options. Transparent, so it can be searched with a string_view.
+	    std::map<std::string, Definition, std::less<>> mDefinitions;
+
+	    ///< Virtual path/region pairs whose default options were reset by an EXPORT_EXCLUDE. Options from earlier files are dropped on merge.
+	    std::set<std::pair<std::string, std::string>> setDefaultResets;
+
+	    ///< Regions in the order the file saved them. The first file to save a name wins, same as std::map::insert.
+	    std::vector<std::pair<std::string, Region>> vctRegions;
+
+	    LibraryFileStats Stats;
+	};
+
+	/**
+	 * @brief Refers to a definition in a VirtualFileSystem without copying it. Handles stay valid across Reload for as long as the virtual path still exists,
+	 * and are invalidated by LoadFileSystem.
+	 */
+	class DefinitionHandle
+	{
+	public:
+	    static constexpr uint32_t INVALID = UINT32_MAX;
+
+	    ///< Index into the file system's definitions
+	    uint32_t uintIndex{INVALID};
+
+	    [[nodiscard]] bool IsValid() const { return uintIndex != INVALID; }
+	    explicit operator bool() const { return IsValid(); }
+	    bool operator==(const DefinitionHandle &InOther) const = default;
+	};
+
+	/**
+	 * @brief Placements grouped by the asset they resolved to, so each unique asset can be loaded once and instanced.
+	 * Group i is asset vctAssets[i], placed at the indices vctPlacements[vctOffsets[i]] to vctPlacements[vctOffsets[i + 1]], in their original order.
+	 */
+	class PlacementGroups
+	{
+	public:
+	    std::vector<RealPathId> vctAssets;
+	    std::vector<uint32_t> vctOffsets;
+	    std::vector<uint32_t> vctPlacements;
+
+	    [[nodiscard]] size_t GetGroupCount() const { return vctAssets.size(); }
+
+	    ///< Indices of the placements in group InGroup
+	    [[nodiscard]] std::span<const uint32_t> GetPlacements(const size_t InGroup) const
+	    {
+	        return std::span(vctPlacements).subspan(vctOffsets[InGroup], vctOffsets[InGroup + 1] - vctOffsets[InGroup]);
+	    }
+	};
+
+	/**
+	 * @brief Groups resolved placements by asset. Unresolved placements (0) are left out.
+	 *
+	 * @param InPaths = Output of VirtualFileSystem::ResolvePlacements
+	 * @returns The groups, ordered by RealPathId
+	 */
+	PlacementGroups GroupPlacementsByAsset(std::span<const RealPathId> InPaths);
+
+	/**
+	 * @brief Memory a VirtualFileSystem holds, by category. Interned real paths live in the process-wide PathTable and aren't included, see PathTable::GetMemoryUsage.
+	 */
+	class FileSystemMemoryStats
+	{
+	public:
+	    ProfileUtils::MemoryUsage Definitions;         ///< The definitions array. The count is live definitions, the bytes include tombstones.
+	    ProfileUtils::MemoryUsage RegionalDefinitions; ///< Every definition's regional definitions
+	    ProfileUtils::MemoryUsage Options;             ///< Every season's options and alias table. The count is options.
+	    ProfileUtils::MemoryUsage PathStrings;         ///< Virtual paths and region names, in the definitions, regions and lookups. The count is strings.
+	    ProfileUtils::MemoryUsage Regions;             ///< Regions by name, the region table, their conditions and the spatial grid. The count is regions by name.
+	    ProfileUtils::MemoryUsage Lookups;             ///< Virtual path and region name hash tables. The count is entries.
+	    ProfileUtils::MemoryUsage ReloadState;         ///< Scanned files, the parse results kept for Reload, and the load stats. The count is library.txt files, see LibraryFileStats::Memory for each.
+
+	    /**
+	     * @brief Sums every category
+	     */
+	    [[nodiscard]] ProfileUtils::MemoryUsage GetTotal() const;
+	};
+
 	class VirtualFileSystem
 	{
 	private:
-	    ///vPaths - A vector of VirtualPaths
+	    ///vPaths - A vector of VirtualPaths. Removed definitions are left as empty tombstones so the indices of the others don't move.
 	    std::vector<Definition> vctDefinitions;
 	    std::map<std::string, Region> mRegions;
 
+	    ///Virtual path -> index into vctDefinitions, for live definitions only
+	    std::unordered_map<std::string, uint32_t, HashUtils::StringHash, std::equal_to<>> mDefinitionIndex;
+
+	    ///Regions compiled by ID. The table only grows, so an ID keeps meaning the same name across Reload. Names that are used but not (or no longer) defined hold an empty region.
+	    std::vector<Region> vctRegionTable;
+	    std::unordered_map<std::string, RegionId, HashUtils::StringHash, std::equal_to<>> mRegionIds;
+	    RegionIndex RegionGrid;
+
+	    ///Inputs of the last LoadFileSystem, kept so Reload can scan them again
+	    std::filesystem::path pXpRootPath;
+	    std::filesystem::path pCurrentPackagePath;
+	    std::filesystem::path pSnapshotPath;
+	    std::vector<std::filesystem::path> vctCustomSceneryPacks;
+	    bool bHasLoaded{false};
+
+	    ///What the last scan found. vctLibraryResults is indexed like vctLibraryFiles, and is empty after a snapshot load since nothing was parsed.
+	    std::vector<std::filesystem::path> vctPackageFiles;
+	    std::vector<LibraryFile> vctLibraryFiles;
+	    std::vector<LibraryFileResult> vctLibraryResults;
+
+	    ///Whether the last LoadFileSystem was satisfied from a snapshot
+	    bool bLoadedFromSnapshot{false};
+
+	    ///What the last LoadFileSystem or Reload did
+	    LoadStats Stats;
+
+	    bool SaveSnapshot(const std::filesystem::path &InPath, uint64_t InKey) const;
+	    bool LoadSnapshot(const std::filesystem::path &InPath, uint64_t InKey);
+
+	    void RebuildIndex();
+	    void RebuildAll();
+	    void RebuildDefinitions(const std::set<std::string> &InPaths);
+	    void RebuildRegions(const std::set<std::string> &InNames);
+	    void RebuildRegionTable();
+	    RegionId GetOrAddRegionId(const std::string &InName);
+	    void FinalizeDefinition(Definition &InOutDefinition);
+
 	public:
 	    /**
 	     * @brief LoadFileSystem - Loads the files from the Library.txt and real paths into the vPaths vector
+		 * library.txt files are parsed in parallel, then merged in priority order, so the result is the same on every run.
 		 *
 		 * @param InXpRootPath = The root path of the X-Plane installation
 		 * @param InCurrentPackagePath = A path to the current package. All files that exist here will be added as well.
 		 * @param InCustomSceneryPacks = A vector of paths to custom scenery packs. These should be ordered based on the scenery_packs.ini, with the first element being the highest priority scenery
+		 * @param InSnapshotPath = Optional binary snapshot of the result. If the set of library.txt files, their sizes and modification times, and the arguments
+		 * all match the ones the snapshot was written for, it is read instead of parsing any text. Otherwise everything is parsed and the snapshot is rewritten.
 	     */
 	    void LoadFileSystem(const std::filesystem::path &InXpRootPath,
                             const std::filesystem::path &InCurrentPackagePath, const std::vector<std::filesystem::path>
-                            &InCustomSceneryPacks);
+                            &InCustomSceneryPacks, const std::filesystem::path &InSnapshotPath = {});
+
+	    /**
+	     * @brief WasLoadedFromSnapshot - Returns whether the last LoadFileSystem read its snapshot instead of parsing
+	     */
+	    [[nodiscard]] bool WasLoadedFromSnapshot() const { return bLoadedFromSnapshot; }
+
+	    /**
+	     * @brief GetLoadStats - Returns the counters and phase times of the last LoadFileSystem or Reload
+	     */
+	    [[nodiscard]] const LoadStats &GetLoadStats() const { return Stats; }
+
+	    /**
+	     * @brief GetMemoryStats - Returns the memory the file system holds, by category. Walks the definitions without allocating or locking,
+		 * a few milliseconds for a full install, so it can be polled from a live process to check budgets.
+	     */
+	    [[nodiscard]] FileSystemMemoryStats GetMemoryStats() const;
+
+	    /**
+	     * @brief Reload - Rescans the inputs of the last LoadFileSystem and updates the file system in place. Only library.txt files that were added,
+	     * removed, or whose size or modification time changed are parsed again, and only the definitions and regions they touch are rebuilt.
+	     * The result is the same as calling LoadFileSystem again with the same arguments.
+	     *
+	     * @returns The virtual paths whose definitions were rebuilt, added or removed, sorted. Empty if nothing changed or nothing was loaded yet.
+	     */
+	    std::vector<std::string> Reload();
+
+	    /**
+	     * @brief FindDefinition - Looks up a virtual path. O(1), and doesn't allocate.
+		 *
+		 * @param InPath = The virtual path to find
+		 * @returns A handle to the definition, or an invalid handle if the path doesn't exist
+	     */
+	    [[nodiscard]] DefinitionHandle FindDefinition(std::string_view InPath) const;
+
+	    /**
+	     * @brief GetDefinition - Returns a view of the definition a handle refers to
+		 *
+		 * @param InHandle = Handle from FindDefinition
+		 * @returns The definition. An empty definition is returned for invalid or stale handles.
+		 * The reference is valid until the next LoadFileSystem or Reload.
+	     */
+	    [[nodiscard]] const Definition &GetDefinition(DefinitionHandle InHandle) const;
 
 	    /**
 	     * @brief GetDefinition - Returns the definition of a given path
 		 *
 		 * @param InPath = The path to get the definition of
-		 * @returns The definition of the given path
+		 * @returns Copy of the definition of the given path. Prefer FindDefinition in hot loops, this copies every option.
 	     */
-	    Definition GetDefinition(const std::string &InPath);
+	    [[nodiscard]] Definition GetDefinition(const std::string &InPath) const;
+
+	    /**
+	     * @brief GetRegions - Returns all regions by name, for Definition::GetPath
+	     */
+	    [[nodiscard]] const std::map<std::string, Region> &GetRegions() const { return mRegions; }
 
 	    /**
 	     * @brief GetRegion - Returns the region of a given path
@@ -47,6 +282,78 @@ namespace XPLibrary
 		 * @returns Copy of the region of the given path. An empty region will be returned if the region does not exist
 	     */
 	    Region GetRegion(const std::string &InPath) const;
+
+	    /**
+	     * @brief FindRegion - Looks up a region's ID by name
+		 *
+		 * @param InName = Region name
+		 * @returns The ID, or INVALID_REGION if no definition uses the name and it was never defined
+	     */
+	    [[nodiscard]] RegionId FindRegion(std::string_view InName) const;
+
+	    /**
+	     * @brief GetRegionById - Returns a region by ID
+		 *
+		 * @param InId = Region ID
+		 * @returns The region. Unknown IDs and undefined regions return an empty region, which is compatible with nothing.
+	     */
+	    [[nodiscard]] const Region &GetRegionById(RegionId InId) const;
+
+	    /**
+	     * @brief GetCompatibleRegions - Finds every region compatible with a point, using the spatial index
+		 *
+		 * @param InLat = Latitude
+		 * @param InLon = Longitude
+		 * @param OutMask = Set to the compatible regions. Reuse it between calls to avoid allocating.
+	     */
+	    void GetCompatibleRegions(double InLat, double InLon, RegionMask &OutMask) const;
+
+	    /**
+	     * @brief ResolveRegionalDefinition - Finds the highest priority regional definition whose region is in the mask
+		 *
+		 * @param InHandle = Definition to resolve
+		 * @param InMask = Compatible regions, from GetCompatibleRegions
+		 * @returns The regional definition, or nullptr if none is compatible
+	     */
+	    [[nodiscard]] const RegionalDefinitions *ResolveRegionalDefinition(DefinitionHandle InHandle, const RegionMask &InMask) const;
+
+	    /**
+	     * @brief GetPath - Same as Definition::GetPath, but regions are found by ID through the spatial index instead of by name
+		 *
+		 * @param InHandle = Definition to resolve
+		 * @param InMask = Compatible regions, from GetCompatibleRegions. Compute it once per location and reuse it for every definition placed there.
+		 * @param InLat = The latitude of the object, seeds the variant pick
+		 * @param InLon = The longitude of the object, seeds the variant pick
+		 * @param InSeason = Optional, the season to get this asset for
+		 * @returns The absolute asset path, or an empty path if no region is compatible
+	     */
+	    [[nodiscard]] std::filesystem::path GetPath(DefinitionHandle InHandle, const RegionMask &InMask, double InLat, double InLon, char InSeason = SEASON_DEFAULT) const;
+
+	    /**
+	     * @brief GetPath - Same as Definition::GetPath, but regions are found by ID through the spatial index instead of by name
+		 *
+		 * @param InHandle = Definition to resolve
+		 * @param InLat = The latitude of the object
+		 * @param InLon = The longitude of the object
+		 * @param InSeason = Optional, the season to get this asset for
+		 * @returns The absolute asset path, or an empty path if no region is compatible
+	     */
+	    [[nodiscard]] std::filesystem::path GetPath(DefinitionHandle InHandle, double InLat, double InLon, char InSeason = SEASON_DEFAULT) const;
+
+	    /**
+	     * @brief ResolvePlacements - Resolves many placements at once. Same result as calling GetPath for each (variants are seeded by placement,
+		 * so the thread count doesn't matter), but placements are bucketed by grid cell
+		 * so region bounds are tested over whole buckets with vectorized loops, and buckets are resolved in parallel.
+		 *
+		 * @param InDefinitions = Definition of each placement
+		 * @param InLat = Latitude of each placement
+		 * @param InLon = Longitude of each placement
+		 * @param InSeasons = Season of each placement, or empty for SEASON_DEFAULT
+		 * @param OutPaths = Resolved real path of each placement, 0 where no region is compatible. Use ResolveRealPath to build the path, or GroupPlacementsByAsset.
+		 * @throws std::invalid_argument if the arrays aren't all the same size
+	     */
+	    void ResolvePlacements(std::span<const DefinitionHandle> InDefinitions, std::span<const double> InLat, std::span<const double> InLon,
+	                           std::span<const char> InSeasons, std::span<RealPathId> OutPaths) const;
 	};
 
 }
@@ -4,22 +4,132 @@
 //Purpose:
 
 #pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stop_token>
+#include <string_view>
+#include <vector>
 #include <xplib/include/XPAsset.h>
 #include <xplib/include/XPLayerGroups.h>
+#include <xplib/include/XPProfile.h>
 
 namespace XPAsset
 {
+    /**
+     * @brief Selects how Obj::Load reads the file
+     */
+	enum class ObjParseMode
+	{
+	    Stream,       //Line by line through std::ifstream/std::stringstream. Kept as the reference implementation.
+	    MemoryMapped  //Maps the file and walks it with string_view cursors, numbers go through std::from_chars. No per line allocations.
+	                  //Throughput target is 150 MB/s or better per core on a warm page cache.
+	};
+
+    /**
+     * @brief Selects how Obj::Load stores the geometry
+     */
+	enum class ObjStorage
+	{
+	    Double, //Vertices and Indices, 64 bytes per vertex and 8 per index. Easy to edit.
+	    Compact //CompactMesh only, in float32 and 16 or 32-bit indices, ready to upload. Vertices and Indices are left empty.
+	};
+
+    /**
+     * @brief Vertex layout of a compact mesh
+     */
+	enum class ObjVertexLayout
+	{
+	    Interleaved, //One struct per vertex: position, normal, UV
+	    SoA          //All positions, then all normals, then all UVs
+	};
+
+    /**
+     * @brief Where Obj::Load keeps compiled (binary) copies of parsed objects
+     */
+	enum class ObjCompiledCache
+	{
+	    Off,          //Always parse the text
+	    BesideSource, //house.obj is compiled to house.obj.xpobj in the same folder
+	    Directory     //Compiled files go in ObjLoadOptions::pCompiledCacheDir, named after the source path's hash
+	};
+
+    /**
+     * @brief Which ATTR_LOD bands Obj::Load keeps
+     */
+	enum class ObjLodSelection
+	{
+	    All,      //Every draw call
+	    Distance, //Draw calls whose LOD range contains ObjLoadOptions::dblLodDistance
+	    Farthest  //Draw calls in the LOD with the largest far distance, the least detailed one. For map-wide views.
+	};
+
+    /**
+     * @brief Options for Obj::Load
+     */
+	class ObjLoadOptions
+	{
+	public:
+	    ObjParseMode Mode{ObjParseMode::MemoryMapped};
+	    ObjStorage Storage{ObjStorage::Double};
+
+	    //These only apply to ObjStorage::Compact
+	    ObjVertexLayout Layout{ObjVertexLayout::Interleaved};
+	    bool bQuantizeNormals{false}; //Store normals octahedral encoded in two snorm16s (4 bytes) instead of three floats (12 bytes)
+	    bool bQuantizeUVs{false};     //Store UVs as two half floats (4 bytes) instead of two floats (8 bytes)
+
+	    std::stop_token StopToken; //Checked while parsing. When stop is requested the load gives up and returns false.
+
+	    //A compiled copy is used when its source has the same size and modification time, or the same content hash, and it was written with the same storage options.
+	    //Otherwise the text is parsed and the compiled copy rewritten. Failing to write it isn't an error.
+	    ObjCompiledCache CompiledCache{ObjCompiledCache::Off};
+	    std::filesystem::path pCompiledCacheDir; //Only used with ObjCompiledCache::Directory. Created if missing.
+
+	    //Anything but All drops the other LODs' draw calls, and the vertices and indices only they use, so only the selected band stays in memory.
+	    //Draw calls outside any ATTR_LOD, and objects without LODs, are always kept.
+	    ObjLodSelection Lods{ObjLodSelection::All};
+	    double dblLodDistance{0}; //Meters. Only used with ObjLodSelection::Distance.
+
+	    //Runs OptimizeObj (XPObjOptimizer.h) with its default options after the LOD selection, before the compact conversion.
+	    //Costs more than the parse itself, pair it with a compiled cache so it only runs once per obj.
+	    bool bOptimize{false};
+	};
+
+    /**
+     * @brief Axis aligned box and bounding sphere of some vertices, in the object's coordinates (Y as stored in Obj::Vertices).
+     * Empty bounds have arrMin above arrMax and a negative radius.
+     */
+	class ObjBounds
+	{
+	public:
+	    std::array<double, 3> arrMin{std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+	    std::array<double, 3> arrMax{-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+	    std::array<double, 3> arrCenter{0, 0, 0}; //Sphere center, the middle of the box
+	    double dblRadius{-1};                    //Sphere radius, the distance to the farthest vertex from the center
+
+	    [[nodiscard]] bool IsEmpty() const { return dblRadius < 0; }
+	};
+
     /**
      * @brief Represents a draw call (TRIS) in an X-Plane obj8 file
      */
 	class ObjDrawCall
 	{
 	public:
-	    size_t idxStart;                           //Zero based start index of the first vertex
-	    size_t idxEnd;                             //Zero based end vertex to draw to
+	    size_t idxStart;                           //First index in Obj::Indices (TRIS offset)
+	    size_t idxEnd;                             //One past the last index (TRIS offset + count)
 	    int intLayerGroup{XPLayerGroups::OBJECTS}; //Layer group
 	    bool bDraped{false};                       //Is this draw call in the object draped?
 
+	    //ATTR_LOD the draw call is in. Visible from dblLodNear up to (not including) dblLodFar meters.
+	    int intLod{-1}; //Zero based, in file order. -1 when the draw call isn't in any LOD.
+	    double dblLodNear{0};
+	    double dblLodFar{std::numeric_limits<double>::infinity()};
+
+	    ObjBounds Bounds; //Of the vertices the draw call's indices use. Filled by Obj::Load.
+
 	    //There theoretically could be other properties, but are not implemented here.
 	};
 
@@ -41,6 +151,88 @@ namespace XPAsset
 	    double V;
 	};
 
+    /**
+     * @brief Format of one attribute in a compact mesh
+     */
+	enum class ObjAttributeFormat : uint8_t
+	{
+	    Float3,      //3 x float32
+	    Float2,      //2 x float32
+	    OctSnorm16x2, //Unit vector, octahedral encoded in 2 x int16, normalized to [-1, 1]
+	    Half2        //2 x float16
+	};
+
+    /**
+     * @brief Where one attribute lives in a compact mesh's vertex data. Attribute of vertex i is at uintOffset + i * uintStride.
+     * Maps directly onto glVertexAttribPointer / D3D input layouts / Vulkan vertex bindings.
+     */
+	class ObjVertexAttribute
+	{
+	public:
+	    uint32_t uintOffset{0};
+	    uint32_t uintStride{0};
+	    ObjAttributeFormat Format{ObjAttributeFormat::Float3};
+	};
+
+    /**
+     * @brief GPU-ready copy of an object's geometry. Positions are float32, normals and UVs are float32 or quantized,
+     * and indices are 16-bit when every index fits, 32-bit otherwise.
+     */
+	class ObjCompactMesh
+	{
+	public:
+	    std::vector<std::byte> vctVertexData; //Vertex buffer, laid out as described by the attributes
+	    std::vector<std::byte> vctIndexData;  //Index buffer, uintIndexSize bytes per index
+	    ObjVertexAttribute Position;
+	    ObjVertexAttribute Normal;
+	    ObjVertexAttribute UV;
+	    ObjVertexLayout Layout{ObjVertexLayout::Interleaved};
+	    uint32_t uintVertexCount{0};
+	    uint32_t uintIndexCount{0};
+	    uint32_t uintIndexSize{4}; //2 or 4
+
+	    /**
+	     * @brief Builds a compact mesh from double precision geometry
+		 *
+		 * @param InVertices = Vertices
+		 * @param InIndices = Indices
+		 * @param InOptions = Layout and quantization
+		 * @returns The mesh
+	     */
+	    static ObjCompactMesh Build(const std::vector<Vertex> &InVertices, const std::vector<size_t> &InIndices, const ObjLoadOptions &InOptions);
+
+	    //Decoders, for tools and tests. Renderers should upload the buffers as they are.
+	    [[nodiscard]] std::array<float, 3> GetPosition(size_t InVertex) const;
+	    [[nodiscard]] std::array<float, 3> GetNormal(size_t InVertex) const;
+	    [[nodiscard]] std::array<float, 2> GetUV(size_t InVertex) const;
+	    [[nodiscard]] uint32_t GetIndex(size_t InIndex) const;
+
+	    //Heap bytes held by the buffers
+	    [[nodiscard]] size_t GetMemoryUsage() const { return vctVertexData.capacity() + vctIndexData.capacity(); }
+	};
+
+    /**
+     * @brief Memory held by objects, by category. Sum several objects' stats with += to budget a set of them.
+     */
+	class ObjMemoryStats
+	{
+	public:
+	    ProfileUtils::MemoryUsage Objects;         //The Obj objects themselves. The count is objects.
+	    ProfileUtils::MemoryUsage Vertices;        //Vertices
+	    ProfileUtils::MemoryUsage Indices;         //Indices
+	    ProfileUtils::MemoryUsage DrawCalls;       //DrawCalls
+	    ProfileUtils::MemoryUsage CompactVertices; //CompactMesh vertex buffer. The count is vertices.
+	    ProfileUtils::MemoryUsage CompactIndices;  //CompactMesh index buffer. The count is indices.
+	    ProfileUtils::MemoryUsage PathStrings;     //The real path and texture paths. The count is paths.
+
+	    /**
+	     * @brief Sums every category
+	     */
+	    [[nodiscard]] ProfileUtils::MemoryUsage GetTotal() const;
+
+	    ObjMemoryStats &operator+=(const ObjMemoryStats &InOther);
+	};
+
     /**
      * @brief Represents an X-Plane obj8 file
 	 */
@@ -51,6 +243,8 @@ namespace XPAsset
 	    std::vector<size_t> Indices;           //Indices. These are zero based indicies of verticies
 	    std::vector<XPAsset::ObjDrawCall>
 	        DrawCalls; //These are draw calls that point to the indicies, and contain state data
+	    ObjCompactMesh CompactMesh; //Only filled with ObjStorage::Compact. Draw calls index into it the same way as into Indices.
+	    ObjBounds Bounds;           //Of every vertex. Filled by Obj::Load, so culling and placement checks never need to touch the vertices.
 
 	    //All paths are relative to the obj path
 	    std::filesystem::path pDrapedBaseTex;   //The draped base texture
@@ -61,15 +255,186 @@ namespace XPAsset
 	    bool bHasDrapedNormalTex{false};   //Material is typically in the b/alpha channel
 	    bool bHasDrapedMaterialTex{false}; //Only set if the material is in a separate texture
 
-	    void *Refcon; //A reference to an object that can be used to store additional data acociated with this object
+	    void *Refcon{nullptr}; //A reference to an object that can be used to store additional data acociated with this object
+
+	    /**
+	     * @brief Loads the object
+		 *
+		 * @param InPath = Path to the obj
+		 * @param InMode = How to read the file. Both modes produce identical Vertices, Indices and DrawCalls.
+		 * @returns True on success, false on failure
+	     */
+	    bool Load(const std::filesystem::path &InPath, ObjParseMode InMode = ObjParseMode::MemoryMapped);
 
 	    /**
 	     * @brief Loads the object
 		 *
 		 * @param InPath = Path to the obj
+		 * @param InOptions = How to read the file, and how to store the geometry
+		 * @returns True on success, false on failure
+	     */
+	    bool Load(const std::filesystem::path &InPath, const ObjLoadOptions &InOptions);
+
+	    /**
+	     * @brief Recomputes Bounds and every draw call's bounds from Vertices and Indices. Load already does this, call it after editing the geometry.
+		 * Does nothing with ObjStorage::Compact, where Vertices is empty and the bounds from Load stand.
+	     */
+	    void ComputeBounds();
+
+	    /**
+	     * @brief Estimates the memory used by the object, itself included, in bytes
+	     */
+	    [[nodiscard]] size_t GetMemoryUsage() const;
+
+	    /**
+	     * @brief Gets the memory the object holds, by category. Only reads sizes, so it is cheap enough to poll.
+	     */
+	    [[nodiscard]] ObjMemoryStats GetMemoryStats() const;
+
+	    /**
+	     * @brief Gets where Load keeps the compiled copy of an obj
+		 *
+		 * @param InPath = Path to the obj
+		 * @param InOptions = Load options
+		 * @returns The compiled path, empty if InOptions.CompiledCache is Off
+	     */
+	    static std::filesystem::path GetCompiledPath(const std::filesystem::path &InPath, const ObjLoadOptions &InOptions);
+
+	private:
+	    bool LoadCompiled(const std::filesystem::path &InPath, const std::filesystem::path &InCompiledPath, const ObjLoadOptions &InOptions);
+	    bool SaveCompiled(const std::filesystem::path &InPath, const std::filesystem::path &InCompiledPath, const ObjLoadOptions &InOptions, uint64_t InSourceHash) const;
+
+	    bool SelectLods(const ObjLoadOptions &InOptions);
+
+	    bool LoadStream(const std::filesystem::path &InPath, const std::stop_token &InStop);
+	    bool LoadMapped(const std::filesystem::path &InPath, const std::stop_token &InStop);
+
+	    void MakeMeVirtual() override {}
+	};
+
+    /**
+     * @brief Selects how much of an obj ReadObj reads
+     */
+	enum class ObjReadMode
+	{
+	    Full,         //Every command, geometry included
+	    SkipGeometry, //VT, VLINE, VLIGHT, IDX and IDX10 lines are skipped without being parsed. Attributes and draw calls are still reported.
+	    Probe         //Stops at the end of the header: after POINT_COUNTS and the texture commands around it, or at the first geometry line
+	};
+
+    /**
+     * @brief Texture commands reported to ObjVisitor::OnTexture
+     */
+	enum class ObjTextureSlot
+	{
+	    Base,         //TEXTURE
+	    Normal,       //TEXTURE_NORMAL
+	    Lit,          //TEXTURE_LIT
+	    DrapedBase,   //TEXTURE_DRAPED
+	    DrapedNormal  //TEXTURE_DRAPED_NORMAL
+	};
+
+    /**
+     * @brief Table sizes from POINT_COUNTS
+     */
+	class ObjPointCounts
+	{
+	public:
+	    size_t uintVertices{0};     //VT lines
+	    size_t uintLineVertices{0}; //VLINE lines
+	    size_t uintLights{0};       //VLIGHT lines
+	    size_t uintIndices{0};      //Indices, IDX counts one and IDX10 ten
+	};
+
+    /**
+     * @brief Receives the commands of an obj as ReadObj parses them, in file order, without anything being stored.
+     * Every callback does nothing by default, override the ones you need. Return false from any of them to stop reading.
+     */
+	class ObjVisitor
+	{
+	public:
+	    virtual ~ObjVisitor() = default;
+
+	    ///< TEXTURE*. InPath is as written, relative to the obj. For TEXTURE_DRAPED_NORMAL it's the path after the tile ratio.
+	    virtual bool OnTexture(ObjTextureSlot /*InSlot*/, std::string_view /*InPath*/) { return true; }
+
+	    virtual bool OnPointCounts(const ObjPointCounts &/*InCounts*/) { return true; }
+
+	    ///< VT, with the values as written (Obj::Load replaces Y, this doesn't)
+	    virtual bool OnVertex(const Vertex &/*InVertex*/) { return true; }
+
+	    ///< IDX and IDX10
+	    virtual bool OnIndices(std::span<const size_t> /*InIndices*/) { return true; }
+
+	    ///< ATTR_layer_group and ATTR_layer_group_draped, resolved with XPLayerGroups::Resolve
+	    virtual bool OnLayerGroup(int /*InLayerGroup*/, bool /*InDraped*/) { return true; }
+
+	    ///< ATTR_draped and ATTR_no_draped
+	    virtual bool OnDraped(bool /*InDraped*/) { return true; }
+
+	    ///< TRIS offset count, as written
+	    virtual bool OnTris(size_t /*InOffset*/, size_t /*InCount*/) { return true; }
+
+	    ///< ATTR_LOD near far
+	    virtual bool OnLod(double /*InNear*/, double /*InFar*/) { return true; }
+
+	    ///< Any other command, the header lines and comments included. InArgs is the rest of the line, trimmed.
+	    virtual bool OnCommand(std::string_view /*InCommand*/, std::string_view /*InArgs*/) { return true; }
+	};
+
+    /**
+     * @brief Reads an obj, passing each command to a visitor. Nothing is stored, so memory use doesn't grow with the obj.
+	 *
+	 * @param InPath = Path to the obj. It's memory mapped, so a probe only touches the pages it reads.
+	 * @param InVisitor = Receives the commands
+	 * @param InMode = How much of the file to read
+	 * @param InStop = Gives up and returns false when stop is requested
+	 * @returns True if the file was read, or the visitor or the probe stopped early. False if it couldn't be opened, a number was malformed, or it was cancelled.
+     */
+	bool ReadObj(const std::filesystem::path &InPath, ObjVisitor &InVisitor, ObjReadMode InMode = ObjReadMode::Full, const std::stop_token &InStop = {});
+
+    /**
+     * @brief Reads obj text already in memory, passing each command to a visitor
+	 *
+	 * @param InText = Contents of an obj
+	 * @param InVisitor = Receives the commands
+	 * @param InMode = How much of the text to read
+	 * @param InStop = Gives up and returns false when stop is requested
+	 * @returns The same as ReadObj
+     */
+	bool ReadObjText(std::string_view InText, ObjVisitor &InVisitor, ObjReadMode InMode = ObjReadMode::Full, const std::stop_token &InStop = {});
+
+    /**
+     * @brief What can be learned about an obj without loading its geometry, for catalog and validation passes.
+     * Loading it in Probe mode reads the header only, SkipGeometry also walks the attributes and draw calls.
+     */
+	class ObjHeader
+	{
+	public:
+	    //Paths are as written, relative to the obj. Empty when the obj doesn't have the texture.
+	    std::filesystem::path pBaseTex;
+	    std::filesystem::path pNormalTex;
+	    std::filesystem::path pLitTex;
+	    std::filesystem::path pDrapedBaseTex;
+	    std::filesystem::path pDrapedNormalTex;
+
+	    ObjPointCounts Counts;
+	    bool bHasPointCounts{false};
+
+	    //Only filled by SkipGeometry and Full
+	    int intLayerGroup{XPLayerGroups::TERRAIN}; //Last ATTR_layer_group, like Obj::intLayerGroup
+	    std::vector<int> vctDrapedLayerGroups;     //Every ATTR_layer_group_draped, in file order
+	    size_t uintDrawCalls{0};
+	    size_t uintDrapedDrawCalls{0};             //TRIS between ATTR_draped and ATTR_no_draped
+
+	    /**
+	     * @brief Reads the header of an obj
+		 *
+		 * @param InPath = Path to the obj
+		 * @param InMode = Probe for the header only, SkipGeometry to also count draw calls and read layer groups
 		 * @returns True on success, false on failure
 	     */
-	    bool Load(const std::filesystem::path &InPath);
+	    bool Load(const std::filesystem::path &InPath, ObjReadMode InMode = ObjReadMode::Probe);
 	};
 
 }
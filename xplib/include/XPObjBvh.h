@@ -0,0 +1,159 @@
+//Module:	XPObjBvh
+//Author:	Connor Russell
+//Date:		10/16/2026 11:52:40 PM
+//Purpose:	Bounding volume hierarchy over an object's triangles, for ray, segment and box queries in logarithmic time
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include <xplib/include/XPObj.h>
+
+namespace XPAsset
+{
+    /**
+     * @brief A triangle of an object
+     */
+	class ObjTriangleRef
+	{
+	public:
+	    size_t idxIndex{0};    //First of the triangle's three indices in Obj::Indices (or CompactMesh)
+	    size_t idxDrawCall{0}; //Draw call the triangle belongs to
+	};
+
+    /**
+     * @brief Where a ray hit an object
+     */
+	class ObjRayHit
+	{
+	public:
+	    ObjTriangleRef Triangle;
+	    double dblDistance{0}; //Along the ray, in the units of the ray direction's length (meters for a unit direction)
+	    double dblU{0};        //Barycentric coordinates of the hit: P = (1 - U - V) * P0 + U * P1 + V * P2
+	    double dblV{0};
+	};
+
+    /**
+     * @brief Node of an ObjBvh, 32 bytes so two share a cache line. The left child of an interior node is the node right after it.
+     */
+	class ObjBvhNode
+	{
+	public:
+	    std::array<float, 3> arrMin;
+	    uint32_t uintIndex; //Interior: index of the right child. Leaf: first triangle.
+	    std::array<float, 3> arrMax;
+	    uint32_t uintCount; //Triangles in a leaf, 0 for interior nodes
+
+	    [[nodiscard]] bool IsLeaf() const { return uintCount != 0; }
+	};
+
+    /**
+     * @brief Bounding volume hierarchy over the triangles an object's draw calls describe. Built with a binned surface area heuristic.
+     * Keeps its own float copy of the triangles, so it works for both storage modes and doesn't need the object once built.
+     * Triangles are double sided. Positions are the object's (Y as stored in Obj::Vertices).
+     */
+	class ObjBvh
+	{
+	public:
+	    /**
+	     * @brief Triangle as the BVH stores it, in leaf order
+	     */
+	    class Triangle
+	    {
+	    public:
+	        std::array<float, 9> arrPositions; //P0, P1, P2
+	        uint32_t idxIndex;
+	        uint32_t idxDrawCall;
+	    };
+
+	    /**
+	     * @brief Builds the hierarchy, replacing anything built or loaded before
+		 *
+		 * @param InObj = Loaded object. Draw calls with ranges outside the indices, and indices outside the vertices, are skipped.
+	     */
+	    void Build(const Obj &InObj);
+
+	    /**
+	     * @brief Loads the hierarchy from a cache file if it was built from the same triangles, otherwise builds it and rewrites the file.
+		 * The triangles are gathered and hashed either way, which is far cheaper than building. Failing to write the file isn't an error.
+		 *
+		 * @param InObj = Loaded object
+		 * @param InCachePath = Cache file, GetCachePath(obj path) keeps it next to the obj
+		 * @returns True if it came from the cache
+	     */
+	    bool BuildCached(const Obj &InObj, const std::filesystem::path &InCachePath);
+
+	    /**
+	     * @brief Writes the hierarchy to a file
+		 *
+		 * @returns True on success
+	     */
+	    bool Save(const std::filesystem::path &InPath) const;
+
+	    /**
+	     * @brief Reads a hierarchy written by Save
+		 *
+		 * @returns True on success. On false the hierarchy is unchanged.
+	     */
+	    bool Load(const std::filesystem::path &InPath);
+
+	    /**
+	     * @brief Gets where BuildCached keeps the hierarchy of an obj: house.obj -> house.obj.xpbvh
+	     */
+	    static std::filesystem::path GetCachePath(const std::filesystem::path &InObjPath);
+
+	    /**
+	     * @brief Finds the nearest triangle a ray hits
+		 *
+		 * @param InOrigin = Ray origin
+		 * @param InDirection = Ray direction. Doesn't need to be unit length, distances are in multiples of it.
+		 * @param InMaxDistance = Hits farther than this are ignored
+		 * @param OutHit = The nearest hit
+		 * @returns True if anything was hit
+	     */
+	    bool Raycast(const std::array<double, 3> &InOrigin, const std::array<double, 3> &InDirection, double InMaxDistance, ObjRayHit &OutHit) const;
+
+	    /**
+	     * @brief Finds the triangle a segment hits nearest its start
+		 *
+		 * @param InStart = Segment start
+		 * @param InEnd = Segment end
+		 * @param OutHit = The nearest hit. The distance is in meters from InStart.
+		 * @returns True if anything was hit
+	     */
+	    bool IntersectSegment(const std::array<double, 3> &InStart, const std::array<double, 3> &InEnd, ObjRayHit &OutHit) const;
+
+	    /**
+	     * @brief Checks whether a segment hits anything. Stops at the first hit found, so it's cheaper than IntersectSegment for clearance checks.
+	     */
+	    [[nodiscard]] bool SegmentHitsAnything(const std::array<double, 3> &InStart, const std::array<double, 3> &InEnd) const;
+
+	    /**
+	     * @brief Finds the triangles that overlap a box. The triangles themselves are tested, not only their bounds.
+		 *
+		 * @param InMin = Box minimum
+		 * @param InMax = Box maximum
+		 * @param OutTriangles = Appended to, in no particular order
+		 * @returns Number of triangles appended
+	     */
+	    size_t QueryAabb(const std::array<double, 3> &InMin, const std::array<double, 3> &InMax, std::vector<ObjTriangleRef> &OutTriangles) const;
+
+	    [[nodiscard]] bool IsEmpty() const { return vctNodes.empty(); }
+	    [[nodiscard]] size_t GetTriangleCount() const { return vctTriangles.size(); }
+	    [[nodiscard]] size_t GetNodeCount() const { return vctNodes.size(); }
+	    [[nodiscard]] const std::vector<ObjBvhNode> &GetNodes() const { return vctNodes; }
+	    [[nodiscard]] const std::vector<Triangle> &GetTriangles() const { return vctTriangles; }
+
+	    ///< Heap bytes held
+	    [[nodiscard]] size_t GetMemoryUsage() const { return vctNodes.capacity() * sizeof(ObjBvhNode) + vctTriangles.capacity() * sizeof(Triangle); }
+
+	private:
+	    bool Traverse(const std::array<double, 3> &InOrigin, const std::array<double, 3> &InDirection, double InMaxDistance, bool InAnyHit, ObjRayHit &OutHit) const;
+	    void BuildFromTriangles(std::vector<Triangle> &&InTriangles, uint64_t InKey);
+
+	    std::vector<ObjBvhNode> vctNodes;
+	    std::vector<Triangle> vctTriangles;
+	    uint64_t uintKey{0}; //Hash of the triangles it was built from, in draw call order
+	};
+}
@@ -0,0 +1,141 @@
+//Module:	XPObjCache
+//Author:	Connor Russell
+//Date:		10/16/2026 7:42:16 PM
+//Purpose:	Shares loaded objects, so an obj is only parsed once however many placements use it, and byte-identical copies in different packages share one instance
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <xplib/include/HashUtils.h>
+#include <xplib/include/XPObj.h>
+
+namespace XPAsset
+{
+	/**
+	 * @brief Counters for an ObjCache. Every Get that isn't cancelled counts as exactly one of hit, content hit, miss or failure.
+	 */
+	class ObjCacheStats
+	{
+	public:
+	    uint64_t uintHits{0};        ///< Path was cached and unchanged on disk
+	    uint64_t uintContentHits{0}; ///< Path wasn't cached, but a byte-identical file was, so it was shared instead of parsed
+	    uint64_t uintMisses{0};      ///< Parsed from disk
+	    uint64_t uintFailures{0};    ///< Couldn't be read or parsed
+	    uint64_t uintEvictions{0};   ///< Objects dropped to stay in budget
+	    size_t uintResidentBytes{0}; ///< Estimated memory held by the cached objects
+	    size_t uintObjects{0};       ///< Unique objects cached
+	    size_t uintPaths{0};         ///< Paths mapped to them
+	};
+
+	/**
+	 * @brief Thread-safe cache of loaded objects with a memory budget. Objects are keyed by canonical path, and by the hash of their contents,
+	 * so byte-identical files share one instance. The least recently used objects are evicted when the budget is exceeded.
+	 *
+	 * Objects are handed out as shared_ptr<const Obj>, so they stay valid after eviction for as long as the caller holds them.
+	 * A shared object's pReal is the first path it was loaded from. Texture paths in it are relative, resolve them against the path you asked for.
+	 */
+	class ObjCache
+	{
+	public:
+	    static constexpr size_t DEFAULT_BUDGET = size_t{512} << 20;
+
+	    /**
+	     * @brief Creates a cache
+		 *
+		 * @param InByteBudget = Memory the cached objects may use, in bytes. The most recently used object is always kept, even if it alone is over budget.
+		 * @param InOptions = How objects are loaded
+	     */
+	    explicit ObjCache(size_t InByteBudget = DEFAULT_BUDGET, const ObjLoadOptions &InOptions = {});
+
+	    /**
+	     * @brief Gets an object, loading it if it isn't cached. A cached path is reloaded if its size or modification time changed.
+		 *
+		 * @param InPath = Path to the obj
+		 * @param InStop = Abandons the parse when stop is requested. Cancelled loads aren't counted as failures.
+		 * @returns The object, or nullptr if it couldn't be loaded or was cancelled
+	     */
+	    std::shared_ptr<const Obj> Get(const std::filesystem::path &InPath, const std::stop_token &InStop = {});
+
+	    /**
+	     * @brief Changes the budget, evicting as needed
+	     */
+	    void SetByteBudget(size_t InByteBudget);
+
+	    [[nodiscard]] size_t GetByteBudget() const;
+
+	    /**
+	     * @brief Gets the estimated memory held by the cached objects, in bytes
+	     */
+	    [[nodiscard]] size_t GetResidentBytes() const;
+
+	    /**
+	     * @brief Gets the memory held by the cached objects, by category. Each unique object is counted once, however many paths share it.
+	     */
+	    [[nodiscard]] ObjMemoryStats GetMemoryStats() const;
+
+	    /**
+	     * @brief Gets a snapshot of the counters
+	     */
+	    [[nodiscard]] ObjCacheStats GetStats() const;
+
+	    /**
+	     * @brief Drops every cached object. Counters are kept.
+	     */
+	    void Clear();
+
+	private:
+	    ///< Identifies file contents. The size is kept beside the hash so a collision also needs equal sizes.
+	    class ContentKey
+	    {
+	    public:
+	        uint64_t uintHash{0};
+	        uint64_t uintSize{0};
+
+	        bool operator==(const ContentKey &) const = default;
+	    };
+
+	    class ContentKeyHash
+	    {
+	    public:
+	        size_t operator()(const ContentKey &InKey) const noexcept { return static_cast<size_t>(HashUtils::Combine(InKey.uintHash, InKey.uintSize)); }
+	    };
+
+	    class ContentEntry
+	    {
+	    public:
+	        std::shared_ptr<const Obj> pObj;
+	        size_t uintBytes{0};
+	        std::list<ContentKey>::iterator itLru;
+	        std::vector<std::string> vctPaths; ///< Keys in mPaths that point here, removed with it
+	    };
+
+	    class PathEntry
+	    {
+	    public:
+	        ContentKey Key;
+	        uintmax_t uintSize{0};
+	        int64_t intModified{0};
+	    };
+
+	    ///< Drops least recently used objects until in budget. Caller holds mtxCache.
+	    void Trim();
+
+	    ///< Records InPath as pointing at InKey, and marks it most recently used. Caller holds mtxCache.
+	    void Touch(const std::string &InPath, const ContentKey &InKey, const PathEntry &InStamp);
+
+	    ObjLoadOptions Options;
+	    mutable std::mutex mtxCache;
+	    size_t uintBudget;
+	    std::unordered_map<std::string, PathEntry, HashUtils::StringHash, std::equal_to<>> mPaths;
+	    std::unordered_map<ContentKey, ContentEntry, ContentKeyHash> mContents;
+	    std::list<ContentKey> lstLru; ///< Most recently used at the front
+	    ObjCacheStats Stats;
+	};
+}
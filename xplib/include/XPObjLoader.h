@@ -0,0 +1,167 @@
+//Module:	XPObjLoader
+//Author:	Connor Russell
+//Date:		10/16/2026 8:31:52 PM
+//Purpose:	Loads objects in the background, nearest (highest priority) first, so a streaming viewer never blocks on Obj::Load
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <xplib/include/XPObj.h>
+#include <xplib/include/XPObjCache.h>
+
+namespace XPAsset
+{
+	/**
+	 * @brief How an asynchronous load ended
+	 */
+	enum class ObjLoadStatus
+	{
+	    Loaded,
+	    Failed,   //The file couldn't be read or parsed
+	    Cancelled //Cancelled while queued or in flight, or the loader was destroyed first
+	};
+
+	/**
+	 * @brief Result of an asynchronous load
+	 */
+	class ObjLoadResult
+	{
+	public:
+	    ObjLoadStatus Status{ObjLoadStatus::Failed};
+	    std::shared_ptr<const Obj> pObj; //Only set when Loaded
+	};
+
+	/**
+	 * @brief Handle to a queued load. The future is shared, so it can be copied to anyone waiting on the object.
+	 */
+	class ObjLoadRequest
+	{
+	public:
+	    static constexpr uint64_t INVALID = 0;
+
+	    uint64_t uintId{INVALID};                 //Pass to SetPriority and Cancel
+	    std::shared_future<ObjLoadResult> Result; //Always becomes ready, even when the load is cancelled
+	};
+
+	/**
+	 * @brief Bounded pool of worker threads loading objects from a priority queue. Higher priorities load first, equal priorities in request order.
+	 * Requests can be reprioritized while queued, and cancelled while queued or in flight. In flight loads check for cancellation as they parse.
+	 * Futures were chosen over coroutines so callers can poll, wait, or hand the result to another thread without an executor.
+	 */
+	class AsyncObjLoader
+	{
+	public:
+	    /**
+	     * @brief Creates a loader that loads each request with Obj::Load
+		 *
+		 * @param InOptions = How objects are loaded. The stop token is supplied by the loader.
+		 * @param InMaxThreads = Upper bound on the number of worker threads. 0 uses std::thread::hardware_concurrency()
+	     */
+	    explicit AsyncObjLoader(const ObjLoadOptions &InOptions = {}, size_t InMaxThreads = 0);
+
+	    /**
+	     * @brief Creates a loader that goes through a cache, so repeated and duplicate objects are only parsed once
+		 *
+		 * @param InCache = Cache to load through. Must outlive the loader.
+		 * @param InMaxThreads = Upper bound on the number of worker threads. 0 uses std::thread::hardware_concurrency()
+	     */
+	    explicit AsyncObjLoader(ObjCache &InCache, size_t InMaxThreads = 0);
+
+	    /**
+	     * @brief Cancels everything still queued or in flight, and joins the workers
+	     */
+	    ~AsyncObjLoader();
+
+	    AsyncObjLoader(const AsyncObjLoader &) = delete;
+	    AsyncObjLoader &operator=(const AsyncObjLoader &) = delete;
+
+	    /**
+	     * @brief Queues an object to load
+		 *
+		 * @param InPath = Path to the obj
+		 * @param InPriority = Higher loads first
+		 * @returns The request
+	     */
+	    ObjLoadRequest Load(const std::filesystem::path &InPath, int InPriority = 0);
+
+	    /**
+	     * @brief Changes the priority of a queued request
+		 *
+		 * @param InId = Request ID
+		 * @param InPriority = New priority
+		 * @returns True if the request was still queued, false if it had already started, finished or been cancelled
+	     */
+	    bool SetPriority(uint64_t InId, int InPriority);
+
+	    /**
+	     * @brief Cancels a request. A queued request resolves as Cancelled right away. An in flight one stops at its next cancellation check,
+		 * unless it finishes first, in which case it resolves as Loaded.
+		 *
+		 * @param InId = Request ID
+		 * @returns True if the request was queued or in flight, false if it had already finished or been cancelled
+	     */
+	    bool Cancel(uint64_t InId);
+
+	    /**
+	     * @brief Gets the number of requests waiting for a worker
+	     */
+	    [[nodiscard]] size_t GetQueuedCount() const;
+
+	    /**
+	     * @brief Gets the number of requests being loaded right now
+	     */
+	    [[nodiscard]] size_t GetInFlightCount() const;
+
+	    /**
+	     * @brief Gets the number of worker threads
+	     */
+	    [[nodiscard]] size_t GetWorkerCount() const { return vctWorkers.size(); }
+
+	private:
+	    class Job
+	    {
+	    public:
+	        std::filesystem::path pPath;
+	        int intPriority{0};
+	        bool bStarted{false};
+	        std::stop_source Stop;
+	        std::promise<ObjLoadResult> Promise;
+	    };
+
+	    ///< Queue order. Highest priority first, then lowest ID, which is request order.
+	    class QueueKey
+	    {
+	    public:
+	        int intPriority;
+	        uint64_t uintId;
+
+	        bool operator<(const QueueKey &InOther) const { return intPriority != InOther.intPriority ? intPriority > InOther.intPriority : uintId < InOther.uintId; }
+	    };
+
+	    void Start(size_t InMaxThreads);
+	    void WorkerMain();
+	    [[nodiscard]] std::shared_ptr<const Obj> LoadOne(const std::filesystem::path &InPath, const std::stop_token &InStop) const;
+
+	    ObjLoadOptions Options;
+	    ObjCache *pCache{nullptr};
+
+	    mutable std::mutex mtxQueue;
+	    std::condition_variable cvQueue;
+	    std::set<QueueKey> setQueue;
+	    std::unordered_map<uint64_t, std::shared_ptr<Job>> mJobs; ///< Queued and in flight
+	    uint64_t uintNextId{ObjLoadRequest::INVALID + 1};
+	    size_t uintInFlight{0};
+	    bool bStopping{false};
+
+	    std::vector<std::thread> vctWorkers;
+	};
+}
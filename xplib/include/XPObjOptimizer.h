@@ -0,0 +1,58 @@
+//Module:	XPObjOptimizer
+//Author:	Connor Russell
+//Date:		10/16/2026 10:58:34 PM
+//Purpose:	Reorders a loaded object's geometry for the GPU: duplicate vertices merged, triangles in vertex cache order, vertices in fetch order
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <xplib/include/XPObj.h>
+
+namespace XPAsset
+{
+    /**
+     * @brief Which steps OptimizeObj runs
+     */
+	class ObjOptimizeOptions
+	{
+	public:
+	    bool bMergeDuplicates{true};   //Merge vertices that are bit for bit identical
+	    bool bReorderTriangles{true};  //Reorder the triangles of each draw call for the post-transform vertex cache (Forsyth's algorithm)
+	    bool bReorderVertices{true};   //Renumber vertices in the order the index buffer first uses them, so fetches walk the vertex buffer forwards
+	    uint32_t uintCacheSize{16};    //FIFO cache size ACMR is measured with. 16 is typical of current GPUs.
+	};
+
+    /**
+     * @brief What OptimizeObj did. ACMR (average cache miss ratio) is vertex shader runs per triangle: 3 is no reuse at all, 0.5 is the best a regular grid gets.
+     */
+	class ObjOptimizeStats
+	{
+	public:
+	    size_t uintVerticesBefore{0};
+	    size_t uintVerticesAfter{0};
+	    size_t uintTriangles{0}; //Triangles in the draw calls, the ones ACMR is measured over
+	    double dblAcmrBefore{0};
+	    double dblAcmrAfter{0};
+	};
+
+    /**
+     * @brief Optimizes an object's Vertices and Indices in place. Every draw call still draws the same triangles, from the same idxStart/idxEnd range,
+     * only their order and the vertex numbering change. A draw call keeps its triangle order if it isn't whole triangles, or overlaps another range
+     * other than by lying inside it on a triangle boundary.
+     * Does nothing to objects loaded with ObjStorage::Compact, which have no Vertices and Indices left to optimize.
+	 *
+	 * @param InOutObj = Loaded object
+	 * @param InOptions = Steps to run
+	 * @returns What changed
+     */
+	ObjOptimizeStats OptimizeObj(Obj &InOutObj, const ObjOptimizeOptions &InOptions = {});
+
+    /**
+     * @brief Simulates a FIFO post-transform vertex cache over a triangle list
+	 *
+	 * @param InIndices = Triangle list. A trailing partial triangle is ignored.
+	 * @param InCacheSize = Cache entries
+	 * @returns Cache misses per triangle, 0 for an empty list
+     */
+	double GetAcmr(std::span<const size_t> InIndices, uint32_t InCacheSize = 16);
+}
@@ -0,0 +1,89 @@
+//Module:	XPPathTable
+//Author:	Connor Russell
+//Date:		10/16/2026 4:05:51 PM
+//Purpose:	Interns the paths used by the library system, so each unique path is stored once and referred to by a small ID
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace XPLibrary
+{
+	///< ID of an interned path. 0 is always the empty path.
+	using PathId = uint32_t;
+
+	/**
+	 * @brief Process-wide table of interned paths. Interning is thread-safe, and resolving an ID never locks.
+	 * Paths are never removed, so an ID stays valid, and its path reference stays stable, for the life of the process.
+	 */
+	class PathTable
+	{
+	public:
+	    ///< Paths are stored in fixed size chunks that never move, so readers don't need a lock
+	    static constexpr size_t CHUNK_BITS = 14;
+	    static constexpr size_t CHUNK_SIZE = size_t{1} << CHUNK_BITS;
+	    static constexpr size_t MAX_CHUNKS = 4096;
+
+	    /**
+	     * @brief Gets the process-wide table
+	     */
+	    static PathTable &Get();
+
+	    PathTable();
+	    ~PathTable();
+	    PathTable(const PathTable &) = delete;
+	    PathTable &operator=(const PathTable &) = delete;
+
+	    /**
+	     * @brief Interns a path
+		 *
+		 * @param InPath = Path to intern. Paths are compared by their native string, no normalization is done.
+		 * @returns The ID for the path. The same path always gets the same ID.
+	     */
+	    PathId Intern(const std::filesystem::path &InPath);
+
+	    /**
+	     * @brief Gets the path for an ID
+		 *
+		 * @param InId = ID from Intern
+		 * @returns The path. The reference stays valid for the life of the process.
+	     */
+	    [[nodiscard]] const std::filesystem::path &Resolve(PathId InId) const;
+
+	    /**
+	     * @brief Gets the number of interned paths, including the empty path
+	     */
+	    [[nodiscard]] size_t Size() const { return uintCount.load(std::memory_order_acquire); }
+
+	    /**
+	     * @brief Estimates the heap memory used by the table, in bytes
+	     */
+	    [[nodiscard]] size_t GetMemoryUsage() const;
+
+	private:
+	    using NativeView = std::basic_string_view<std::filesystem::path::value_type>;
+
+	    ///< Guards mIds and appending. Readers of existing IDs don't take it.
+	    mutable std::shared_mutex mtxTable;
+	    ///< Keys view the stored paths, so each string is only held once
+	    std::unordered_map<NativeView, PathId> mIds;
+	    std::unique_ptr<std::atomic<std::filesystem::path *>[]> pChunks;
+	    std::atomic<size_t> uintCount{0};
+	    size_t uintStringBytes{0}; ///< Heap bytes held by the stored strings and their component arrays, guarded by mtxTable
+	};
+
+	/**
+	 * @brief Interns a path in the process-wide table
+	 */
+	inline PathId InternPath(const std::filesystem::path &InPath) { return PathTable::Get().Intern(InPath); }
+
+	/**
+	 * @brief Resolves an ID from the process-wide table
+	 */
+	inline const std::filesystem::path &ResolvePath(const PathId InId) { return PathTable::Get().Resolve(InId); }
+}
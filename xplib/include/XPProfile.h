@@ -0,0 +1,142 @@
+//Module:	XPProfile
+//Author:	Connor Russell
+//Date:		10/16/2026 9:42:10 PM
+//Purpose:	Profiling zones around the hot paths, a stopwatch for the load statistics, and memory accounting for the memory statistics.
+//			Zones only exist when the library is built with XP_SCENERY_LIB_WITH_TRACY, otherwise the macros compile to nothing.
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if defined(XPLIB_WITH_TRACY)
+#include <tracy/Tracy.hpp>
+
+///< Opens a zone named InName (a string literal) until the end of the scope
+#define XPLIB_ZONE(InName) ZoneScopedN(InName)
+
+///< Attaches a std::string, like the file being worked on, to the zone opened in this scope. Not evaluated when zones are off.
+#define XPLIB_ZONE_TEXT(InString)                           \
+    do                                                      \
+    {                                                       \
+        const auto &strZoneText_ = (InString);              \
+        ZoneText(strZoneText_.data(), strZoneText_.size()); \
+    } while (false)
+#else
+#define XPLIB_ZONE(InName) ((void)0)
+#define XPLIB_ZONE_TEXT(InString) ((void)0)
+#endif
+
+namespace ProfileUtils
+{
+	/**
+	 * @brief Measures wall time since it was created or last restarted
+	 */
+	class Stopwatch
+	{
+	public:
+	    void Restart() { tpStart = std::chrono::steady_clock::now(); }
+
+	    ///< Milliseconds elapsed
+	    [[nodiscard]] double GetMs() const { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tpStart).count(); }
+
+	private:
+	    std::chrono::steady_clock::time_point tpStart{std::chrono::steady_clock::now()};
+	};
+
+	/**
+	 * @brief Heap memory held by one kind of data. Bytes is what the items need, capacity is what is allocated for them, unused vector capacity included.
+	 * Tree and hash table nodes are estimated from their value size plus the usual links, allocator bookkeeping isn't counted.
+	 */
+	class MemoryUsage
+	{
+	public:
+	    uint64_t uintCount{0};    ///< Items counted
+	    uint64_t uintBytes{0};    ///< Bytes the items need
+	    uint64_t uintCapacity{0}; ///< Bytes allocated for them, at least uintBytes
+
+	    ///< Adds a vector's element storage. Heap owned by the elements themselves has to be added separately.
+	    template <typename T>
+	    void AddVector(const std::vector<T> &InVector)
+	    {
+	        uintCount += InVector.size();
+	        uintBytes += InVector.size() * sizeof(T);
+	        uintCapacity += InVector.capacity() * sizeof(T);
+	    }
+
+	    ///< Adds a string's buffer. Short strings that fit inside the string object own no heap, so only their count is added.
+	    template <typename TChar>
+	    void AddString(const std::basic_string<TChar> &InString)
+	    {
+	        uintCount++;
+	        AddStringBuffer(InString);
+	    }
+
+	    ///< Adds a path's string. libstdc++ also keeps the components of a path with more than one in their own array, each with its own string.
+	    void AddPath(const std::filesystem::path &InPath)
+	    {
+	        AddString(InPath.native());
+#if defined(__GLIBCXX__)
+	        size_t uintComponents = 0;
+	        for (auto it = InPath.begin(); it != InPath.end() && uintComponents < 2; ++it)
+	            uintComponents++;
+	        if (uintComponents < 2)
+	            return;
+
+	        uintComponents = 0;
+	        for (const auto &Component : InPath)
+	        {
+	            AddStringBuffer(Component.native());
+	            uintComponents++;
+	        }
+	        ///< Array header, then each component's path and offset
+	        AddBytes(0, 2 * sizeof(int) + uintComponents * (sizeof(std::filesystem::path) + sizeof(size_t)));
+#endif
+	    }
+
+	    ///< Adds the nodes of a std::map or std::set: the value plus a color and three links each
+	    template <typename TValue>
+	    void AddTreeNodes(const size_t InNodes)
+	    {
+	        AddBytes(InNodes, InNodes * (sizeof(TValue) + 4 * sizeof(void *)));
+	    }
+
+	    ///< Adds an unordered container's nodes (the value plus a next pointer and cached hash each) and its bucket array
+	    template <typename TContainer>
+	    void AddHashTable(const TContainer &InContainer)
+	    {
+	        AddBytes(InContainer.size(), InContainer.size() * (sizeof(typename TContainer::value_type) + 2 * sizeof(void *)));
+	        AddBytes(0, InContainer.bucket_count() * sizeof(void *));
+	    }
+
+	    ///< Adds storage that is exactly as big as it needs to be
+	    void AddBytes(const uint64_t InCount, const uint64_t InBytes)
+	    {
+	        uintCount += InCount;
+	        uintBytes += InBytes;
+	        uintCapacity += InBytes;
+	    }
+
+	    MemoryUsage &operator+=(const MemoryUsage &InOther)
+	    {
+	        uintCount += InOther.uintCount;
+	        uintBytes += InOther.uintBytes;
+	        uintCapacity += InOther.uintCapacity;
+	        return *this;
+	    }
+
+	private:
+	    template <typename TChar>
+	    void AddStringBuffer(const std::basic_string<TChar> &InString)
+	    {
+	        const auto uintObject = reinterpret_cast<uintptr_t>(&InString);
+	        const auto uintData = reinterpret_cast<uintptr_t>(InString.data());
+	        if (uintData >= uintObject && uintData < uintObject + sizeof(InString))
+	            return;
+	        uintBytes += (InString.size() + 1) * sizeof(TChar);
+	        uintCapacity += (InString.capacity() + 1) * sizeof(TChar);
+	    }
+	};
+}
@@ -0,0 +1,106 @@
+//Module:	XPRegionIndex
+//Author:	Connor Russell
+//Date:		10/16/2026 5:02:44 PM
+//Purpose:	Provides a lat/lon grid over the regions, so finding the regions compatible with a point doesn't have to test every region
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <xplib/include/XPLibraryPath.h>
+
+namespace XPLibrary
+{
+	/**
+	 * @brief Set of region IDs, one bit per region
+	 */
+	class RegionMask
+	{
+	public:
+	    /**
+	     * @brief Clears the mask and sizes it for InRegionCount regions
+	     */
+	    void Reset(const size_t InRegionCount) { vctBits.assign(GetWordCount(InRegionCount), 0); }
+
+	    void Set(const RegionId InId) { vctBits[InId / 64] |= uint64_t{1} << (InId % 64); }
+
+	    ///< IDs past the end of the mask are never set
+	    [[nodiscard]] bool Test(const RegionId InId) const { return Test(vctBits, InId); }
+
+	    ///< Number of 64-bit words needed for InRegionCount regions
+	    static constexpr size_t GetWordCount(const size_t InRegionCount) { return (InRegionCount + 63) / 64; }
+
+	    ///< Tests a mask stored as raw words, as written by RegionIndex::GetCompatibleInCell
+	    static bool Test(const std::span<const uint64_t> InWords, const RegionId InId) { return InId / 64 < InWords.size() && (InWords[InId / 64] >> (InId % 64) & 1) != 0; }
+
+	private:
+	    std::vector<uint64_t> vctBits;
+	};
+
+	/**
+	 * @brief 1x1 degree grid over the regions' bounds. Each cell lists the regions that contain the whole cell, which need no test,
+	 * and the regions that only overlap it, which are tested with Region::CompatibleWith. Lookups cost the number of regions touching the cell, not the total.
+	 */
+	class RegionIndex
+	{
+	public:
+	    static constexpr int ROWS = 180;
+	    static constexpr int COLUMNS = 360;
+	    static constexpr int CELL_COUNT = ROWS * COLUMNS;
+	    static constexpr int OFF_GRID = -1; ///< Cell of points outside the grid, or NaN
+
+	    /**
+	     * @brief Builds the grid
+		 *
+		 * @param InRegions = Region table, indexed by RegionId. Must outlive the index, or until the next Build.
+	     */
+	    void Build(const std::vector<Region> &InRegions);
+
+	    /**
+	     * @brief Finds every region compatible with a point. The same as calling Region::CompatibleWith on every region.
+		 *
+		 * @param InLat = Latitude
+		 * @param InLon = Longitude
+		 * @param OutMask = Set to the compatible regions
+	     */
+	    void GetCompatible(double InLat, double InLon, RegionMask &OutMask) const;
+
+	    /**
+	     * @brief Gets the grid cell of a point
+		 *
+		 * @returns The cell index, or OFF_GRID
+	     */
+	    [[nodiscard]] static int GetCellIndex(double InLat, double InLon);
+
+	    /**
+	     * @brief Finds the compatible regions for many points in the same cell. The bounds tests run over all points at once without branches,
+		 * so the compiler can vectorize them. Same results as GetCompatible for each point.
+		 *
+		 * @param InCell = Cell every point is in, from GetCellIndex
+		 * @param InLat = Latitudes
+		 * @param InLon = Longitudes
+		 * @param InWords = Mask words per point, from RegionMask::GetWordCount(GetRegionCount())
+		 * @param OutMasks = InWords words per point. Point i's mask is [i * InWords, (i + 1) * InWords).
+	     */
+	    void GetCompatibleInCell(int InCell, std::span<const double> InLat, std::span<const double> InLon, size_t InWords, std::span<uint64_t> OutMasks) const;
+
+	    /**
+	     * @brief Gets the number of regions in the table the index was built from
+	     */
+	    [[nodiscard]] size_t GetRegionCount() const { return pRegions == nullptr ? 0 : pRegions->size(); }
+
+	    /**
+	     * @brief Estimates the heap memory used by the index, in bytes
+	     */
+	    [[nodiscard]] size_t GetMemoryUsage() const;
+
+	private:
+	    const std::vector<Region> *pRegions{nullptr};
+
+	    ///< Per cell lists, stored flat. Cell c's entries are [vctOffsets[c], vctOffsets[c + 1]).
+	    std::vector<uint32_t> vctInsideOffsets;
+	    std::vector<RegionId> vctInside;
+	    std::vector<uint32_t> vctPartialOffsets;
+	    std::vector<RegionId> vctPartial;
+	};
+}
@@ -3,4 +3,7 @@
 //Date:		10/8/2024 8:36:09 PM
 //Purpose:	Provides a single header that includes all the utility functions from the library
 #pragma once
+#include <xplib/include/FileUtils.h>
+#include <xplib/include/HashUtils.h>
 #include <xplib/include/TextUtils.h>
+#include <xplib/include/ThreadUtils.h>
@@ -0,0 +1,262 @@
+//Module:	FileUtils
+//Author:	Connor Russell
+//Date:		10/16/2026 9:14:02 AM
+//Purpose:	Implements FileUtils.h
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <system_error>
+#include <utility>
+#include <xplib/include/FileUtils.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+FileUtils::MappedFile::~MappedFile()
+{
+    Close();
+}
+
+FileUtils::MappedFile::MappedFile(MappedFile &&InOther) noexcept
+{
+    *this = std::move(InOther);
+}
+
+FileUtils::MappedFile &FileUtils::MappedFile::operator=(MappedFile &&InOther) noexcept
+{
+    if (this == &InOther)
+        return *this;
+
+    Close();
+    pData = std::exchange(InOther.pData, nullptr);
+    sizeData = std::exchange(InOther.sizeData, 0);
+    bOpen = std::exchange(InOther.bOpen, false);
+#ifdef _WIN32
+    hFile = std::exchange(InOther.hFile, nullptr);
+    hMapping = std::exchange(InOther.hMapping, nullptr);
+#endif
+    return *this;
+}
+
+/**
+ * @brief Maps the file into memory, closing any previous mapping first
+ *
+ * @param InPath = Path to the file
+ * @returns True on success, false on failure
+ */
+bool FileUtils::MappedFile::Open(const std::filesystem::path &InPath)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE File = CreateFileW(InPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (File == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER Size;
+    if (!GetFileSizeEx(File, &Size))
+    {
+        CloseHandle(File);
+        return false;
+    }
+
+    ///< Zero length files can't be mapped, but are still valid files
+    if (Size.QuadPart == 0)
+    {
+        CloseHandle(File);
+        bOpen = true;
+        return true;
+    }
+
+    HANDLE Mapping = CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (Mapping == nullptr)
+    {
+        CloseHandle(File);
+        return false;
+    }
+
+    const void *View = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+    if (View == nullptr)
+    {
+        CloseHandle(Mapping);
+        CloseHandle(File);
+        return false;
+    }
+
+    hFile = File;
+    hMapping = Mapping;
+    pData = static_cast<const char *>(View);
+    sizeData = static_cast<size_t>(Size.QuadPart);
+#else
+    const int intFd = ::open(InPath.c_str(), O_RDONLY);
+    if (intFd < 0)
+        return false;
+
+    struct stat Stat{};
+    if (::fstat(intFd, &Stat) != 0)
+    {
+        ::close(intFd);
+        return false;
+    }
+
+    ///< Zero length files can't be mapped, but are still valid files
+    if (Stat.st_size == 0)
+    {
+        ::close(intFd);
+        bOpen = true;
+        return true;
+    }
+
+    void *View = ::mmap(nullptr, static_cast<size_t>(Stat.st_size), PROT_READ, MAP_PRIVATE, intFd, 0);
+    ::close(intFd); ///< The mapping keeps its own reference to the file
+
+    if (View == MAP_FAILED)
+        return false;
+
+    ::madvise(View, static_cast<size_t>(Stat.st_size), MADV_SEQUENTIAL);
+
+    pData = static_cast<const char *>(View);
+    sizeData = static_cast<size_t>(Stat.st_size);
+#endif
+
+    bOpen = true;
+    return true;
+}
+
+/**
+ * @brief Releases the mapping. Safe to call on a closed file.
+ */
+void FileUtils::MappedFile::Close()
+{
+#ifdef _WIN32
+    if (pData != nullptr)
+        UnmapViewOfFile(pData);
+    if (hMapping != nullptr)
+        CloseHandle(hMapping);
+    if (hFile != nullptr)
+        CloseHandle(hFile);
+    hMapping = nullptr;
+    hFile = nullptr;
+#else
+    if (pData != nullptr)
+        ::munmap(const_cast<char *>(pData), sizeData);
+#endif
+
+    pData = nullptr;
+    sizeData = 0;
+    bOpen = false;
+}
+
+/**
+ * @brief Appends a string as a 32-bit length followed by its bytes
+ */
+void FileUtils::BinaryWriter::WriteString(const std::string_view InString)
+{
+    Write(static_cast<uint32_t>(InString.size()));
+    WriteBytes(InString.data(), InString.size());
+}
+
+/**
+ * @brief Appends a path as a UTF-8 string, so it reads back the same regardless of the system code page
+ */
+void FileUtils::BinaryWriter::WritePath(const std::filesystem::path &InPath)
+{
+    const std::u8string strPath = InPath.u8string();
+    WriteString({reinterpret_cast<const char *>(strPath.data()), strPath.size()});
+}
+
+/**
+ * @brief Saves the buffer. It is written to a temporary file first and renamed over InPath, so readers never see a half written file.
+ *
+ * @param InPath = File to write
+ * @returns True on success, false on failure
+ */
+bool FileUtils::BinaryWriter::SaveToFile(const std::filesystem::path &InPath) const
+{
+    std::error_code ec;
+    if (InPath.has_parent_path())
+        std::filesystem::create_directories(InPath.parent_path(), ec);
+
+    ///< Unique per writer, so two threads saving the same file can't write into each other's temporary
+    static std::atomic<uint64_t> uintNextTemp{0};
+    std::filesystem::path pTemp = InPath;
+    pTemp += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + "." + std::to_string(uintNextTemp++) + ".tmp";
+
+    {
+        std::ofstream ofsFile(pTemp, std::ios::binary | std::ios::trunc);
+        if (!ofsFile.is_open())
+            return false;
+
+        ofsFile.write(strBuffer.data(), static_cast<std::streamsize>(strBuffer.size()));
+        if (!ofsFile.good())
+        {
+            ofsFile.close();
+            std::filesystem::remove(pTemp, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(pTemp, InPath, ec);
+    if (ec)
+    {
+        std::filesystem::remove(pTemp, ec);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reads raw bytes
+ */
+bool FileUtils::BinaryReader::ReadBytes(void *OutData, const size_t InSize)
+{
+    if (!bGood || svData.size() < InSize)
+    {
+        bGood = false;
+        return false;
+    }
+
+    if (InSize != 0)
+        std::memcpy(OutData, svData.data(), InSize);
+    svData.remove_prefix(InSize);
+    return true;
+}
+
+/**
+ * @brief Reads a string written by WriteString
+ */
+bool FileUtils::BinaryReader::ReadString(std::string &OutString)
+{
+    uint32_t uintLength = 0;
+    if (!Read(uintLength) || svData.size() < uintLength)
+    {
+        bGood = false;
+        return false;
+    }
+
+    OutString.assign(svData.data(), uintLength);
+    svData.remove_prefix(uintLength);
+    return true;
+}
+
+/**
+ * @brief Reads a path written by WritePath
+ */
+bool FileUtils::BinaryReader::ReadPath(std::filesystem::path &OutPath)
+{
+    std::string strPath;
+    if (!ReadString(strPath))
+        return false;
+
+    OutPath = std::filesystem::path(std::u8string(strPath.begin(), strPath.end()));
+    return true;
+}
@@ -4,122 +4,109 @@
 //Purpose:	Implements TextUtils.h
 #include <algorithm>
 #include <iostream>
-#include <sstream>
 #include <xplib/include/TextUtils.h>
 
 
 /**
- * @brief Reads a string from a stream until a given character is reached. Returns the character that was read, or ASCII EOF (4) if the end of the file was reached
+ * @brief NextToken - Takes the next token off the front of a string, without allocating
  *
- * @param inStream Stream to get the next token from
- * @param OutString Pointer to string object to hold the output
- * @param Delimeters Delimiting chars to read to, and are thrown out at start. String must be sorted beforehand so we can do a binary search. Must be a standard ASCII character, no UTF-8
- * @returns The delimiting character that ended the token, or -1 if EOF was reached
+ * Leading delimiters are skipped, then the token runs until the next delimiter, which is consumed.
+ * A byte right after one with the high bit set is never treated as a delimiter, so multi-byte UTF-8 characters can't be split.
+ * Delimiters are ASCII, so the byte before the first one looked at is never part of a UTF-8 sequence.
+ *
+ * @param InOutRest String to read from. Advanced past the token and the delimiter that ended it.
+ * @param OutToken Set to the token
+ * @param InDelimiters Delimiters
+ * @returns True if a token was found
  */
-static char ReadNextToken(std::istream &inStream, std::string *OutString, std::vector<char> Delimeters)
+bool TextUtils::NextToken(std::string_view &InOutRest, std::string_view &OutToken, const DelimiterSet &InDelimiters)
 {
-    ///< Define a token buffer
-    std::string strTokenBuffer;
+    const char *pData = InOutRest.data();
+    const size_t uintSize = InOutRest.size();
+
+    ///< Skip leading delimiters
+    size_t idx = 0;
+    while (idx < uintSize && InDelimiters.Contains(pData[idx]))
+        idx++;
+    if (idx == uintSize)
+    {
+        InOutRest = {};
+        return false;
+    }
 
-    ///< Define a delimiter token
-    char chrDelimeter = 0;
+    ///< Read to the next delimiter that doesn't follow a UTF-8 byte
+    const size_t idxStart = idx++;
+    while (idx < uintSize && ((pData[idx - 1] & 0x80) != 0 || !InDelimiters.Contains(pData[idx])))
+        idx++;
 
-    ///< Define flags
-    bool bStartedToken = false; ///< Whether we've started the token
-    bool bNextIsUtf8 = false;   ///< Whether the next char is a UTF-8 sequence. We have two flags because when we cle
-    bool bInUtf8 = false;       ///< Whether we're in a UTF-8 sequence
+    OutToken = InOutRest.substr(idxStart, idx - idxStart);
+    InOutRest.remove_prefix(idx < uintSize ? idx + 1 : uintSize);
+    return true;
+}
 
-    ///< Read until we can't
-    while (inStream.good())
-    {
-        chrDelimeter = inStream.get();
-
-        ///< Check if we've started token
-        if (bStartedToken)
-        {
-            ///< Check if this is a delimeter, if we're not in a UTF-8 sequence
-            if (!bInUtf8 && std::ranges::binary_search(Delimeters, chrDelimeter))
-            {
-                *OutString = strTokenBuffer;
-                return chrDelimeter;
-            }
-
-            ///< Otherwise, this char is good, add it to the token buffer
-            strTokenBuffer += chrDelimeter;
-        }
-
-        ///< Otherwise check if this is not a delimeter (or is utf8 which automatically means it's not a delimeter). If that is the case, set that we've started token
-        else if (bInUtf8 || !std::ranges::binary_search(Delimeters, chrDelimeter))
-        {
-            ///< Save this char, then set token started
-            strTokenBuffer += chrDelimeter;
-            bStartedToken = true;
-        }
-
-        ///< Set whether we are in an utf-8 sequence. We can get away with not checking earlier because there will be no delimeter that matches.
-        if (chrDelimeter & 0b10000000)
-        {
-            bInUtf8 = true;
-        }
-        else
-        {
-            bInUtf8 = false;
-        }
-
-        ///< Peek to set flags
-        inStream.peek();
-    }
+/**
+ * @brief TokenizeString - Splits a string into views of its tokens
+ *
+ * @param InString String to tokenize
+ * @param OutTokens Cleared, then filled with the tokens
+ * @param InDelimiters Delimiters
+ * @returns The number of tokens
+ */
+size_t TextUtils::TokenizeString(std::string_view InString, std::vector<std::string_view> &OutTokens, const DelimiterSet &InDelimiters)
+{
+    OutTokens.clear();
 
-    ///< We reached the end of the file. Return the token
-    *OutString = strTokenBuffer;
+    std::string_view svToken;
+    while (NextToken(InString, svToken, InDelimiters))
+        OutTokens.push_back(svToken);
 
-    ///< Return -1 to indicate EOF
-    return -1;
+    return OutTokens.size();
+}
+
+/**
+ * @brief GetRestOfLine - Gets what follows a token on its line, trimmed of whitespace
+ *
+ * @param InLine Line the token was taken from
+ * @param InToken Token, a view into InLine
+ * @returns A view into InLine
+ */
+std::string_view TextUtils::GetRestOfLine(const std::string_view InLine, const std::string_view InToken)
+{
+    const size_t idxTokenEnd = static_cast<size_t>(InToken.data() + InToken.size() - InLine.data());
+    const std::string_view svRest = InLine.substr(std::min(idxTokenEnd, InLine.size()));
+
+    const size_t idxStart = svRest.find_first_not_of(" \t\n\r");
+    if (idxStart == std::string_view::npos)
+        return {};
+    return svRest.substr(idxStart, svRest.find_last_not_of(" \t\n\r") - idxStart + 1);
 }
 
 /**
  * @brief Reads an entire line into tokens based on delimiting chars. Delimiting char/newline are removed from stream.
  *
  * This function will read the entire string, and return a vector of tokens. The tokens are separated by the delimiting characters.
- * If the delimiting characters are empty, it defaults to whitespace (' ', '\t', '\n', '\r').
  * If the string contains UTF-8 characters, it will handle them correctly, treating them as a single token.
  * If a token is empty, it will not be added to the output vector.
  * If the input string is empty, it will return an empty vector.
  *
  * @param InString String to read from
- * @param DelimitingChars Characters to use as delimiters. If empty, defaults to whitespace (' ', '\t', '\n', '\r').
+ * @param DelimitingChars Characters to use as delimiters.
  *
  * @note This should be a standard ASCII character, no UTF-8.
- * @returns A vector of strings that will hold the tokens. The vector is not cleared before adding tokens, so it can be used to append to an existing vector.
+ * @returns A vector of strings that will hold the tokens.
  *
  */
-std::vector<std::string> TextUtils::TokenizeString(const std::string &InString, std::vector<char> DelimitingChars)
+std::vector<std::string> TextUtils::TokenizeString(const std::string &InString, const std::vector<char> &DelimitingChars)
 {
-    ///< Get the stream
-    std::stringstream inStream(InString);
-
-    ///< Buffers
-    std::string strTokenBuffer;         ///< Current token
-    std::vector<std::string> OutTokens; ///< Output tokens
-
-    ///< Sort the delimiters
-    std::ranges::sort(DelimitingChars);
-
-    ///< Read until the end of the stream
-    while (ReadNextToken(inStream, &strTokenBuffer, DelimitingChars) != -1)
-    {
-        if (!strTokenBuffer.empty())
-            OutTokens.push_back(strTokenBuffer);
-
-        strTokenBuffer.clear();
-    }
-
-    ///< Add the last token
-    if (!strTokenBuffer.empty())
-        OutTokens.push_back(strTokenBuffer);
-
-    ///< Peek to set flags
-    inStream.peek();
+    DelimiterSet Delimiters;
+    for (const char c : DelimitingChars)
+        Delimiters.Add(c);
+
+    std::vector<std::string> OutTokens;
+    std::string_view svRest = InString;
+    std::string_view svToken;
+    while (NextToken(svRest, svToken, Delimiters))
+        OutTokens.emplace_back(svToken);
 
     return OutTokens;
 }
@@ -0,0 +1,91 @@
+//Module:	ThreadUtils
+//Author:	Connor Russell
+//Date:		10/16/2026 11:04:40 AM
+//Purpose:	Implements ThreadUtils.h
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <xplib/include/ThreadUtils.h>
+
+/**
+ * @brief Gets the number of threads ParallelFor would use for a given upper bound
+ *
+ * @param InMaxThreads = Upper bound, 0 for no bound
+ * @returns The thread count, always at least 1
+ */
+size_t ThreadUtils::GetWorkerCount(const size_t InMaxThreads)
+{
+    size_t uintThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    if (InMaxThreads != 0)
+        uintThreads = std::min(uintThreads, InMaxThreads);
+    return uintThreads;
+}
+
+/**
+ * @brief Runs InFunc(i) for every i in [0, InCount) on a pool of worker threads, and blocks until they are all done.
+ *
+ * @param InCount = Number of items
+ * @param InFunc = Work function, called exactly once per index. Must be safe to call concurrently.
+ * @param InMaxThreads = Upper bound on the number of threads used. 0 uses std::thread::hardware_concurrency()
+ */
+void ThreadUtils::ParallelFor(const size_t InCount, const std::function<void(size_t)> &InFunc, const size_t InMaxThreads)
+{
+    if (InCount == 0)
+        return;
+
+    ///< Shared state
+    std::atomic<size_t> uintNext{0};
+    std::atomic<bool> bFailed{false};
+    std::exception_ptr FirstException;
+    std::mutex mtxException;
+
+    ///< Each worker pulls indices until they run out or someone fails
+    auto Worker = [&]() {
+        while (!bFailed.load(std::memory_order_relaxed))
+        {
+            const size_t idx = uintNext.fetch_add(1, std::memory_order_relaxed);
+            if (idx >= InCount)
+                return;
+
+            try
+            {
+                InFunc(idx);
+            }
+            catch (...)
+            {
+                std::lock_guard Lock(mtxException);
+                if (!FirstException)
+                    FirstException = std::current_exception();
+                bFailed = true;
+            }
+        }
+    };
+
+    ///< Spin up the helpers, the calling thread is the last worker
+    const size_t uintThreads = std::min(GetWorkerCount(InMaxThreads), InCount);
+    std::vector<std::thread> vctThreads;
+    vctThreads.reserve(uintThreads - 1);
+    for (size_t i = 1; i < uintThreads; i++)
+    {
+        ///< If the system won't give us more threads, make do with the ones we have
+        try
+        {
+            vctThreads.emplace_back(Worker);
+        }
+        catch (...)
+        {
+            break;
+        }
+    }
+
+    Worker();
+
+    for (auto &t : vctThreads)
+        t.join();
+
+    if (FirstException)
+        std::rethrow_exception(FirstException);
+}
@@ -17,6 +17,25 @@ const int XPLayerGroups::OBJECTS = 93;
 const int XPLayerGroups::LIGHT_OBJECTS = 104;
 const int XPLayerGroups::CARS = 115;
 
+namespace
+{
+	///< Base offset of each group by name
+	constexpr TextUtils::Keyword<int> LAYER_GROUP_KEYWORDS[] = {
+	    {"terrain", XPLayerGroups::TERRAIN},
+	    {"beaches", XPLayerGroups::BEACHES},
+	    {"shoulders", XPLayerGroups::SHOULDERS},
+	    {"taxiways", XPLayerGroups::TAXIWAYS},
+	    {"runways", XPLayerGroups::RUNWAYS},
+	    {"markings", XPLayerGroups::MARKINGS},
+	    {"airports", XPLayerGroups::AIRPORTS},
+	    {"roads", XPLayerGroups::ROADS},
+	    {"objects", XPLayerGroups::OBJECTS},
+	    {"light_objects", XPLayerGroups::LIGHT_OBJECTS},
+	    {"cars", XPLayerGroups::CARS},
+	};
+	constexpr TextUtils::KeywordTable LAYER_GROUPS(LAYER_GROUP_KEYWORDS, XPLayerGroups::TERRAIN);
+}
+
 /**
  * @brief Resolves a layer group to a vertical InOffset
  *
@@ -28,37 +47,15 @@ const int XPLayerGroups::CARS = 115;
  * @param InOffset Offset from group
  * @returns Vertical InOffset for proper layering
  */
-int XPLayerGroups::Resolve(std::string InGroup, const int InOffset)
+int XPLayerGroups::Resolve(std::string_view InGroup, const int InOffset)
 {
     ///< Remove whitespace just in case
-    InGroup = TextUtils::TrimWhitespace(InGroup);
+    const size_t idxStart = InGroup.find_first_not_of(" \t\n\r");
+    InGroup = idxStart == std::string_view::npos ? std::string_view() : InGroup.substr(idxStart, InGroup.find_last_not_of(" \t\n\r") - idxStart + 1);
 
     //Layer groups in order are: terrain, beaches, shoulders, taxiways, runways, markings, airports, roads, objects, light_objects, cars
     //Each layer group is 11 higher than the previous. The first group starts with 5. So group 1 is 5 + InOffset, 2 is 16 + InOffset, etc. Then is combined with InOffset for final layering.
-    if (InGroup == "terrain")
-        return 5 + InOffset;
-    if (InGroup == "beaches")
-        return 16 + InOffset;
-    if (InGroup == "shoulders")
-        return 27 + InOffset;
-    if (InGroup == "taxiways")
-        return 38 + InOffset;
-    if (InGroup == "runways")
-        return 49 + InOffset;
-    if (InGroup == "markings")
-        return 60 + InOffset;
-    if (InGroup == "airports")
-        return 71 + InOffset;
-    if (InGroup == "roads")
-        return 82 + InOffset;
-    if (InGroup == "objects")
-        return 93 + InOffset;
-    if (InGroup == "light_objects")
-        return 104 + InOffset;
-    if (InGroup == "cars")
-        return 115 + InOffset;
-
-    return 5 + InOffset;
+    return LAYER_GROUPS.Find(InGroup) + InOffset;
 }
 
 /**
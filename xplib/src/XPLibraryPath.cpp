@@ -0,0 +1,114 @@
+//Module:	XPLibraryPath
+//Author:	Connor Russell
+//Date:		10/16/2026 7:12:36 PM
+//Purpose:	Implements the weighted option picking in XPLibraryPath.h
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <random>
+#include <xplib/include/HashUtils.h>
+#include <xplib/include/XPLibraryPath.h>
+
+namespace XPLibrary
+{
+	/**
+	* @brief BuildAliasTable - Builds the alias table (Vose's method), making PickOption O(1)
+	*/
+	void DefinitionOptions::BuildAliasTable()
+	{
+	    const size_t uintCount = vctOptions.size();
+	    vctAlias.assign(uintCount, AliasEntry());
+	    if (uintCount == 0)
+	        return;
+
+	    ///< Negative ratios are treated as 0. If nothing has any weight, the linear scan would always pick the first option, so do the same.
+	    double dblTotal = 0;
+	    for (const auto &[dblRatio, DefPath] : vctOptions)
+	        dblTotal += std::max(dblRatio, 0.0);
+	    if (!(dblTotal > 0))
+	    {
+	        for (auto &Entry : vctAlias)
+	            Entry = {0, 0};
+	        return;
+	    }
+
+	    ///< Scale the weights so the average is 1, then pair each small column with a large one.
+	    ///< The work lists come from a buffer on the stack, which fits 128 options, so building every definition's tables doesn't hit the heap.
+	    std::array<std::byte, 2048> arrScratch;
+	    std::pmr::monotonic_buffer_resource Scratch(arrScratch.data(), arrScratch.size());
+	    std::pmr::vector<double> vctScaled(uintCount, &Scratch);
+	    std::pmr::vector<uint32_t> vctSmall(&Scratch), vctLarge(&Scratch);
+	    vctSmall.reserve(uintCount);
+	    vctLarge.reserve(uintCount);
+	    for (size_t i = 0; i < uintCount; i++)
+	    {
+	        vctScaled[i] = std::max(vctOptions[i].first, 0.0) * static_cast<double>(uintCount) / dblTotal;
+	        (vctScaled[i] < 1 ? vctSmall : vctLarge).push_back(static_cast<uint32_t>(i));
+	    }
+
+	    while (!vctSmall.empty() && !vctLarge.empty())
+	    {
+	        const uint32_t idxSmall = vctSmall.back();
+	        const uint32_t idxLarge = vctLarge.back();
+	        vctSmall.pop_back();
+
+	        vctAlias[idxSmall] = {vctScaled[idxSmall], idxLarge};
+	        vctScaled[idxLarge] -= 1 - vctScaled[idxSmall];
+	        if (vctScaled[idxLarge] < 1)
+	        {
+	            vctLarge.pop_back();
+	            vctSmall.push_back(idxLarge);
+	        }
+	    }
+
+	    ///< Whatever is left is 1 up to rounding
+	    for (const uint32_t idx : vctSmall)
+	        vctAlias[idx] = {1, idx};
+	    for (const uint32_t idx : vctLarge)
+	        vctAlias[idx] = {1, idx};
+	}
+
+	/**
+	* @brief PickOption - Picks an option based on the ratios, the same way every time for the same seed
+	*
+	* @param InSeed = Seed
+	* @return The option, or an empty path if there are none
+	*/
+	DefinitionPath DefinitionOptions::PickOption(const uint64_t InSeed) const
+	{
+	    if (vctOptions.empty())
+	        return {};
+
+	    ///< High bits pick the column, low bits are the coin flip within it
+	    const uint64_t uintBits = HashUtils::Mix64(InSeed);
+	    const double dblFraction = static_cast<double>(uintBits & 0xFFFFFFFF) * 0x1p-32;
+
+	    if (vctAlias.size() == vctOptions.size())
+	    {
+	        const size_t idxColumn = static_cast<size_t>(((uintBits >> 32) * vctOptions.size()) >> 32);
+	        const AliasEntry &Entry = vctAlias[idxColumn];
+	        return vctOptions[dblFraction < Entry.dblProbability ? idxColumn : Entry.idxAlias].second;
+	    }
+
+	    ///< No table yet, fall back to walking the weights
+	    double dblRand = dblFraction * dblTotalRatio;
+	    for (const auto &[fst, snd] : vctOptions)
+	    {
+	        dblRand -= fst;
+	        if (dblRand <= 0)
+	            return snd;
+	    }
+
+	    return vctOptions[0].second;
+	}
+
+	/**
+	* @brief GetRandomOption - Gets a random option based on the ratios. Each thread has its own generator, so this is thread-safe.
+	*/
+	DefinitionPath DefinitionOptions::GetRandomOption() const
+	{
+	    thread_local std::mt19937_64 Generator{std::random_device{}()};
+	    return PickOption(Generator());
+	}
+}
@@ -4,28 +4,33 @@
 //Purpose:	Implements XPLibrarySystem.h
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <map>
+#include <memory_resource>
+#include <numeric>
+#include <set>
 #include <ranges>
-#include <sstream>
+#include <stdexcept>
 #include <filesystem>
+#include <tuple>
+#include <unordered_map>
+#include <xplib/include/FileUtils.h>
+#include <xplib/include/HashUtils.h>
 #include <xplib/include/TextUtils.h>
+#include <xplib/include/ThreadUtils.h>
 #include <xplib/include/XPLibrarySystem.h>
 #include <xplib/include/XPLibraryPath.h>
+#include <xplib/include/XPProfile.h>
 
 namespace fs = std::filesystem; //I'm lazy, so less typing
 
 namespace XPLibrary
 {
 
-	/**
-	* @brief LoadFileSystem - Loads the files from the Library.txt and real paths into the vPaths vector
-	*
-	* @param InXpRootPath = The root path of the X-Plane installation
-	* @param InCurrentPackagePath
-	* @param InCustomSceneryPacks = A vector of paths to custom scenery packs. These should be ordered based on the scenery_packs.ini, with the first element being the highest priority scenery
-	*/
-	void VirtualFileSystem::LoadFileSystem(const std::filesystem::path &InXpRootPath, const std::filesystem::path &InCurrentPackagePath, const std::vector<std::filesystem::path> &InCustomSceneryPacks)
+	namespace
 	{
 	    ///< Define our seasons
 	    const std::string SUM = "sum";
@@ -33,93 +38,176 @@ namespace XPLibrary
 	    const std::string SPR = "spr";
 	    const std::string FAL = "fal";
 
-	    std::map<std::string, Definition> mTempDefinitions;
-
-	    ///< Define a list of acceptable extensions to add to the library.txt
-	    std::vector<std::string> vctXPExtensions = {
-	        ".lin",
-	        ".pol",
-	        ".str",
-	        ".ter",
-	        ".net",
-	        ".obj",
-	        ".agb",
-	        ".ags",
-	        ".agp",
-	        ".bch",
-	        ".fac", // Facade files
-	        ".for"  // Forest files
+	    ///< library.txt commands the parser acts on
+	    enum class LibraryCommand
+	    {
+	        Unknown,
+	        Export,
+	        ExportExtend,
+	        ExportBackup,
+	        ExportRatio,
+	        ExportExclude,
+	        ExportSeason,
+	        ExportExtendSeason,
+	        ExportRatioSeason,
+	        ExportExcludeSeason,
+	        RegionDefine,
+	        RegionAll,
+	        RegionRect,
+	        RegionBitmap,
+	        RegionDref,
+	        Region,
+	        Public,
+	        Private
 	    };
-	    std::ranges::sort(vctXPExtensions);
 
-	    ///< We will first add a new region, region_all, which contains everything that is not regionalized.
-	    Region Region_All;
-	    mRegions.insert(std::make_pair("region_all", Region_All));
+	    constexpr TextUtils::Keyword<LibraryCommand> LIBRARY_KEYWORDS[] = {
+	        {"EXPORT", LibraryCommand::Export},
+	        {"EXPORT_EXTEND", LibraryCommand::ExportExtend},
+	        {"EXPORT_BACKUP", LibraryCommand::ExportBackup},
+	        {"EXPORT_RATIO", LibraryCommand::ExportRatio},
+	        {"EXPORT_EXCLUDE", LibraryCommand::ExportExclude},
+	        {"EXPORT_SEASON", LibraryCommand::ExportSeason},
+	        {"EXPORT_EXTEND_SEASON", LibraryCommand::ExportExtendSeason},
+	        {"EXPORT_RATIO_SEASON", LibraryCommand::ExportRatioSeason},
+	        {"EXPORT_EXCLUDE_SEASON", LibraryCommand::ExportExcludeSeason},
+	        {"REGION_DEFINE", LibraryCommand::RegionDefine},
+	        {"REGION_ALL", LibraryCommand::RegionAll},
+	        {"REGION_RECT", LibraryCommand::RegionRect},
+	        {"REGION_BITMAP", LibraryCommand::RegionBitmap},
+	        {"REGION_DREF", LibraryCommand::RegionDref},
+	        {"REGION", LibraryCommand::Region},
+	        {"PUBLIC", LibraryCommand::Public},
+	        {"PRIVATE", LibraryCommand::Private},
+	    };
+	    constexpr TextUtils::KeywordTable LIBRARY_COMMANDS(LIBRARY_KEYWORDS, LibraryCommand::Unknown);
+
+	    ///< Virtual path -> definition while RebuildAll merges the files. Its nodes and keys come from an arena that lives for the merge, the definitions are moved out at the end.
+	    using MergeDefinitionMap = std::pmr::map<std::pmr::string, Definition, std::less<>>;
+
+	    ///< Rough arena bytes per merged definition: the map node, the key, and the Definition itself
+	    constexpr size_t MERGE_BYTES_PER_DEFINITION = 192;
 
-	    ///< Lambda to get an iterator to a definition, or add it if it doesn't exist
-	    auto GetIteratorToDefinition = [&](const std::string &InPath) -> std::map<std::string, Definition>::iterator {
+	    /**
+	     * @brief Gets an iterator to a definition, or adds it if it doesn't exist. Works on a file's own map and on the merge map.
+	     */
+	    template <typename TDefinitionMap>
+	    typename TDefinitionMap::iterator FindOrAddDefinition(TDefinitionMap &InDefinitions, const std::string_view InPath)
+	    {
 	        ///< Find the definition
-	        auto it = mTempDefinitions.find(InPath);
-	        if (it == mTempDefinitions.end())
+	        auto it = InDefinitions.find(InPath);
+	        if (it == InDefinitions.end())
 	        {
-	            ///< Create the definition
+	            ///< Create the definition. The key is built from the view with the map's allocator.
 	            Definition Def;
 	            Def.pVirtual = InPath;
-	            mTempDefinitions.insert(std::make_pair(InPath, Def));
-
-	            it = mTempDefinitions.find(InPath);
+	            it = InDefinitions.emplace(InPath, std::move(Def)).first;
 	        }
 
 	        return it;
-	    };
+	    }
 
-	    //First load all the real files from the Current Package
-	    for (const auto &p : fs::recursive_directory_iterator(InCurrentPackagePath))
+	    /**
+	     * @brief Appends every option of one DefinitionOptions to another, keeping weights and order
+	     */
+	    void AppendOptions(DefinitionOptions &InOutTarget, const DefinitionOptions &InSource)
 	    {
-	        if (std::ranges::binary_search(vctXPExtensions, p.path().extension().string()))
-	        {
-	            //Define a new DefinitionPath
-	            DefinitionPath DefPath;
-	            DefPath.SetPath(InCurrentPackagePath, p.path().lexically_relative(InCurrentPackagePath));
+	        ///< Most options come from a single file, so size the vector for it once instead of growing it
+	        if (InOutTarget.GetOptionCount() == 0)
+	            InOutTarget.GetOptions().reserve(InSource.GetOptionCount());
+
+	        for (const auto &[dblRatio, DefPath] : InSource.GetOptions())
+	            InOutTarget.AddOption(DefPath, dblRatio);
+	    }
 
-	            //Get iterator to this def
-	            auto it = GetIteratorToDefinition(p.path().lexically_relative(InCurrentPackagePath).string());
-	            it->second.vctRegionalDefs[it->second.GetRegionalDefinitionIdx("region_all")].dDefault.AddOption(DefPath);
+	    /**
+	     * @brief Adds the heap a definition owns to the memory stats. The Definition object itself is counted with whatever holds it.
+	     */
+	    void AddDefinitionMemory(const Definition &InDefinition, FileSystemMemoryStats &InOutStats)
+	    {
+	        InOutStats.PathStrings.AddPath(InDefinition.pVirtual);
+	        InOutStats.RegionalDefinitions.AddVector(InDefinition.vctRegionalDefs);
+	        for (const auto &RegionalDef : InDefinition.vctRegionalDefs)
+	        {
+	            InOutStats.PathStrings.AddString(RegionalDef.strRegionName);
+	            for (const DefinitionOptions *pOptions : {&RegionalDef.dSummer, &RegionalDef.dWinter, &RegionalDef.dFall, &RegionalDef.dSpring, &RegionalDef.dDefault, &RegionalDef.dBackup})
+	                pOptions->AddMemoryUsage(InOutStats.Options);
 	        }
 	    }
 
-	    //Get a list of all library.txt files in the custom scenery packs, and in the resources directory (XpRoot/Resources/default scenery)
-	    //First path is the package, second path is the library.txt
-	    std::vector<std::pair<fs::path, fs::path>> vctLibs;
+	    /**
+	     * @brief Adds the heap a region's conditions own. The Region object itself is counted with whatever holds it.
+	     */
+	    void AddRegionMemory(const Region &InRegion, ProfileUtils::MemoryUsage &InOutUsage)
+	    {
+	        InOutUsage.AddVector(InRegion.Conditions);
+	        for (const auto &[strValue1, strOperator, strValue2] : InRegion.Conditions)
+	        {
+	            InOutUsage.AddString(strValue1);
+	            InOutUsage.AddString(strOperator);
+	            InOutUsage.AddString(strValue2);
+	        }
+	    }
 
-	    //Get the library.txts to process
+	    /**
+	     * @brief Gets the heap one library.txt's parse result holds. The count is the definitions in it.
+	     */
+	    ProfileUtils::MemoryUsage GetLibraryFileMemory(const LibraryFileResult &InResult)
 	    {
-	        for (auto &p : InCustomSceneryPacks)
+	        FileSystemMemoryStats FileStats;
+	        FileStats.Definitions.AddTreeNodes<std::pair<const std::string, Definition>>(InResult.mDefinitions.size());
+	        for (const auto &[strPath, Def] : InResult.mDefinitions)
 	        {
-	            for (auto &p2 : fs::recursive_directory_iterator(p, fs::directory_options::skip_permission_denied))
-	            {
-	                if (p2.path().filename() == "library.txt")
-	                    vctLibs.emplace_back(p2.path().parent_path(), p2.path());
-	            }
+	            FileStats.PathStrings.AddString(strPath);
+	            AddDefinitionMemory(Def, FileStats);
 	        }
 
-	        for (auto &p : fs::recursive_directory_iterator(InXpRootPath / "Resources" / "default scenery",
-	                                                        fs::directory_options::skip_permission_denied))
+	        FileStats.Definitions.AddTreeNodes<std::pair<std::string, std::string>>(InResult.setDefaultResets.size());
+	        for (const auto &[strPath, strRegion] : InResult.setDefaultResets)
 	        {
-	            if (p.path().filename() == "library.txt")
-	                vctLibs.emplace_back(p.path().parent_path(), p.path());
+	            FileStats.PathStrings.AddString(strPath);
+	            FileStats.PathStrings.AddString(strRegion);
 	        }
+
+	        FileStats.Regions.AddVector(InResult.vctRegions);
+	        for (const auto &[strName, FileRegion] : InResult.vctRegions)
+	        {
+	            FileStats.PathStrings.AddString(strName);
+	            AddRegionMemory(FileRegion, FileStats.Regions);
+	        }
+	        FileStats.PathStrings.AddPath(InResult.Stats.pLibraryPath);
+
+	        ProfileUtils::MemoryUsage Usage = FileStats.GetTotal();
+	        Usage.uintCount = InResult.mDefinitions.size();
+	        return Usage;
 	    }
 
-	    //Now we will process the library.txt files
-	    for (auto &[fst, snd] : vctLibs)
+	    /**
+	     * @brief Parses a single library.txt. Touches no shared state, so it is safe to call from multiple threads.
+	     *
+	     * @param InPackagePath = The folder the library.txt is in. Real paths are relative to this.
+	     * @param InLibraryPath = The library.txt
+	     * @returns What this file contributes to the file system
+	     */
+	    LibraryFileResult ParseLibraryFile(const fs::path &InPackagePath, const fs::path &InLibraryPath)
 	    {
+	        XPLIB_ZONE("ParseLibraryFile");
+	        XPLIB_ZONE_TEXT(InLibraryPath.string());
+	        const ProfileUtils::Stopwatch Timer;
+
+	        LibraryFileResult Result;
+	        Result.Stats.pLibraryPath = InLibraryPath;
+	        const PathId idPackagePath = InternPath(InPackagePath); ///< Every export in this file shares it
+	        auto GetIteratorToDefinition = [&](const std::string_view InPath) {
+	            return FindOrAddDefinition(Result.mDefinitions, InPath);
+	        };
+
 	        //Open the file
-	        std::ifstream ifsLib(snd);
+	        std::ifstream ifsLib(InLibraryPath);
 
-	        //Buffers
+	        //Buffers. tokens point into strBuffer, and are reused line to line so nothing is allocated once they've grown.
 	        std::string strBuffer;
-	        std::stringstream ssLineBuffer;
+	        std::vector<std::string_view> tokens;
 	        Region CurrentRegion;
 	        std::string strCurrentRegionDefName;
 	        std::string strCurrentRegionName = "region_all";
@@ -132,26 +220,39 @@ namespace XPLibrary
 	        //Read lines
 	        while (ifsLib.good())
 	        {
-	            //Get the line, put it into the string stream, and tokenize
+	            //Get the line and tokenize it
 	            std::getline(ifsLib, strBuffer);
+	            if (!ifsLib.fail())
+	            {
+	                Result.Stats.uintLines++;
+	                Result.Stats.uintBytes += strBuffer.size() + (ifsLib.eof() ? 0 : 1);
+	            }
 	            //std::replace(strBuffer.begin(), strBuffer.end(), '\t', ' ');	//Replace tabs with spaces so the string stream properly delimits
-	            ssLineBuffer.clear();
-	            ssLineBuffer.str(strBuffer);
-	            auto tokens = TextUtils::TokenizeString(strBuffer, {' ', '\t', '\n', '\r'});
+	            TextUtils::TokenizeString(strBuffer, tokens);
 
 	            //Skip non-commands
 	            if (strBuffer.starts_with("#"))
 	                continue;
 	            //Comments
+
+	            //Empty lines aren't commands, but they do end a region block
 	            if (tokens.empty())
+	            {
+	                if (bLastCommandWasRegion && !strCurrentRegionDefName.empty())
+	                {
+	                    Result.vctRegions.emplace_back(strCurrentRegionDefName, CurrentRegion);
+	                    strCurrentRegionDefName = "";
+	                }
+	                bLastCommandWasRegion = false;
 	                continue;
-	            //Empty lines
+	            }
 
 	            //Reset this command state
 	            bThisCommandWasRegion = false;
+	            const LibraryCommand Command = LIBRARY_COMMANDS.Find(tokens[0]);
 
 	            //Check the command
-	            if ((tokens[0] == "EXPORT" || tokens[0] == "EXPORT_EXTEND") && tokens.size() >= 3) //EXPORT and EXPORT_EXTEND actually behave pretty much identically in sim, so we will save the complexity and treat them the same here.
+	            if ((Command == LibraryCommand::Export || Command == LibraryCommand::ExportExtend) && tokens.size() >= 3) //EXPORT and EXPORT_EXTEND actually behave pretty much identically in sim, so we will save the complexity and treat them the same here.
 	            {
 	                //Create (or get) the definition for the virtual path
 	                auto it = GetIteratorToDefinition(tokens[1]);
@@ -163,20 +264,14 @@ namespace XPLibrary
 	                //Get the index of the current RegionalDefinition in this definition
 	                auto &RegionalDef = it->second.vctRegionalDefs[it->second.GetRegionalDefinitionIdx(strCurrentRegionName)];
 
-	                //Now we need to get the real path. We do this by removing the first 2 tokens from the stream, then we can getline
-	                ssLineBuffer >> strBuffer >> strBuffer;
-	                strBuffer.clear();
-	                std::getline(ssLineBuffer, strBuffer);
-	                strBuffer = TextUtils::TrimWhitespace(strBuffer);
-
-	                //Define our definition path
+	                //Define our definition path. The real path is the rest of the line after the first 2 tokens, since it can contain spaces.
 	                DefinitionPath DefPath;
-	                DefPath.SetPath(fst, strBuffer);
+	                DefPath.SetPath(idPackagePath, TextUtils::GetRestOfLine(strBuffer, tokens[1]));
 
 	                //This is a default path, so now we just need to add it as an option to the default definition
 	                RegionalDef.dDefault.AddOption(DefPath);
 	            }
-	            if (tokens[0] == "EXPORT_BACKUP" && tokens.size() >= 3)
+	            if (Command == LibraryCommand::ExportBackup && tokens.size() >= 3)
 	            {
 	                //Create (or get) the definition for the virtual path
 	                auto it = GetIteratorToDefinition(tokens[1]);
@@ -187,20 +282,14 @@ namespace XPLibrary
 	                //Get the index of the current RegionalDefinition in this definition
 	                auto &RegionalDef = it->second.vctRegionalDefs[it->second.GetRegionalDefinitionIdx(strCurrentRegionName)];
 
-	                //Now we need to get the real path. We do this by removing the first 2 tokens from the stream, then we can getline
-	                ssLineBuffer >> strBuffer >> strBuffer;
-	                strBuffer.clear();
-	                std::getline(ssLineBuffer, strBuffer);
-	                strBuffer = TextUtils::TrimWhitespace(strBuffer);
-
-	                //Define our definition path
+	                //Define our definition path. The real path is the rest of the line after the first 2 tokens, since it can contain spaces.
 	                DefinitionPath DefPath;
-	                DefPath.SetPath(fst, strBuffer);
+	                DefPath.SetPath(idPackagePath, TextUtils::GetRestOfLine(strBuffer, tokens[1]));
 
 	                //This is a backup path, so now we just need to add it as an option to the default definition
 	                RegionalDef.dBackup.AddOption(DefPath);
 	            }
-	            else if (tokens[0] == "EXPORT_RATIO" && tokens.size() >= 4)
+	            else if (Command == LibraryCommand::ExportRatio && tokens.size() >= 4)
 	            {
 	                //Format: EXPORT_RATIO <ratio> <virtual path> <real path>
 	                //Create (or get) the definition for the virtual path
@@ -212,31 +301,18 @@ namespace XPLibrary
 	                //Get the index of the current RegionalDefinition in this definition
 	                auto &RegionalDef = it->second.vctRegionalDefs[it->second.GetRegionalDefinitionIdx(strCurrentRegionName)];
 
-	                //Now we need to get the real path. We do this by removing the first 3 tokens from the stream, then we can getline
-	                ssLineBuffer >> strBuffer >> strBuffer >> strBuffer;
-	                strBuffer.clear();
-	                std::getline(ssLineBuffer, strBuffer);
-	                strBuffer = TextUtils::TrimWhitespace(strBuffer);
-
-	                //Define our definition path
+	                //Define our definition path. The real path is the rest of the line after the first 3 tokens, since it can contain spaces.
 	                DefinitionPath DefPath;
-	                DefPath.SetPath(fst, strBuffer);
+	                DefPath.SetPath(idPackagePath, TextUtils::GetRestOfLine(strBuffer, tokens[2]));
 
-	                //Get the ratio
+	                //Get the ratio. An unreadable one leaves the option at the default weight.
 	                double dblRatio = 1;
-	                try
-	                {
-	                    dblRatio = std::stod(tokens[2]);
-	                }
-	                catch (...)
-	                {
-	                    //TODO: Log something here
-	                }
+	                TextUtils::ParseNumber(tokens[1], dblRatio);
 
 	                //This is a default path, so now we just need to add it as an option to the default definition
 	                RegionalDef.dBackup.AddOption(DefPath, dblRatio);
 	            }
-	            else if (tokens[0] == "EXPORT_EXCLUDE")
+	            else if (Command == LibraryCommand::ExportExclude && tokens.size() >= 3)
 	            {
 	                //Create (or get) the definition for the virtual path
 	                auto it = GetIteratorToDefinition(tokens[1]);
@@ -247,48 +323,37 @@ namespace XPLibrary
 	                //Get the index of the current RegionalDefinition in this definition
 	                auto &RegionalDef = it->second.vctRegionalDefs[it->second.GetRegionalDefinitionIdx(strCurrentRegionName)];
 
-	                //Now we need to get the real path. We do this by removing the first 2 tokens from the stream, then we can getline
-	                ssLineBuffer >> strBuffer >> strBuffer;
-	                strBuffer.clear();
-	                std::getline(ssLineBuffer, strBuffer);
-	                strBuffer = TextUtils::TrimWhitespace(strBuffer);
-
-	                //Define our definition path
+	                //Define our definition path. The real path is the rest of the line after the first 2 tokens, since it can contain spaces.
 	                DefinitionPath DefPath;
-	                DefPath.SetPath(fst, strBuffer);
+	                DefPath.SetPath(idPackagePath, TextUtils::GetRestOfLine(strBuffer, tokens[1]));
 
-	                //Since this is an exclude, we need to reset the options first
+	                //Since this is an exclude, we need to reset the options first. Options from earlier files are dropped when merging.
 	                RegionalDef.dDefault.ResetOptions();
+	                Result.setDefaultResets.emplace(tokens[1], strCurrentRegionName);
 
 	                //This is a default path, so now we just need to add it as an option to the default definition
 	                RegionalDef.dDefault.AddOption(DefPath);
 	            }
-	            else if (tokens[0] == "REGION_DEFINE" && tokens.size() == 2)
+	            else if (Command == LibraryCommand::RegionDefine && tokens.size() == 2)
 	            {
 	                CurrentRegion = Region(); //Reset the region
-	                strCurrentRegionDefName = fst.string() + ":" + tokens[1];
+	                strCurrentRegionDefName = InPackagePath.string().append(":").append(tokens[1]);
 
 	                bLastCommandWasRegion = true;
 	                bThisCommandWasRegion = true;
 	            }
-	            else if (tokens[0] == "REGION_ALL")
+	            else if (Command == LibraryCommand::RegionAll)
 	            {
 	                //Nothing to do here - we leave the region with the default no conditions
 
 	                bLastCommandWasRegion = true;
 	                bThisCommandWasRegion = true;
 	            }
-	            else if (tokens[0] == "REGION_RECT" && tokens.size() == 5)
+	            else if (Command == LibraryCommand::RegionRect && tokens.size() == 5)
 	            {
 	                //Params here are w s e n. Save these in the region
-	                try
-	                {
-	                    CurrentRegion.dblWest = std::stod(tokens[1]);
-	                    CurrentRegion.dblSouth = std::stod(tokens[2]);
-	                    CurrentRegion.dblEast = std::stod(tokens[3]);
-	                    CurrentRegion.dblNorth = std::stod(tokens[4]);
-	                }
-	                catch (...)
+	                if (!TextUtils::ParseNumber(tokens[1], CurrentRegion.dblWest) || !TextUtils::ParseNumber(tokens[2], CurrentRegion.dblSouth) ||
+	                    !TextUtils::ParseNumber(tokens[3], CurrentRegion.dblEast) || !TextUtils::ParseNumber(tokens[4], CurrentRegion.dblNorth))
 	                {
 	                    //TODO: Log something here
 	                }
@@ -296,34 +361,34 @@ namespace XPLibrary
 	                bLastCommandWasRegion = true;
 	                bThisCommandWasRegion = true;
 	            }
-	            else if (tokens[0] == "REGION_BITMAP" && tokens.size() >= 2)
+	            else if (Command == LibraryCommand::RegionBitmap && tokens.size() >= 2)
 	            {
 	                //TODO: Implement a system that allows for REGION_BITMAPs to be used. We need to store the image data.
 
 	                bLastCommandWasRegion = true;
 	                bThisCommandWasRegion = true;
 	            }
-	            else if (tokens[0] == "REGION_DREF" &&
+	            else if (Command == LibraryCommand::RegionDref &&
 	                     tokens.size() == 4) //I don't *think* datarefs can have spaces? So there should be exactly 4 tokens
 	            {
 	                CurrentRegion.Conditions.emplace_back(tokens[1], tokens[2], tokens[3]); //The conditions are a tuple with 3 strings
 	                bLastCommandWasRegion = true;
 	                bThisCommandWasRegion = true;
 	            }
-	            else if (tokens[0] == "REGION" && tokens.size() == 2)
+	            else if (Command == LibraryCommand::Region && tokens.size() == 2)
 	            {
 	                //Check if there is an un-added region (we can tell by the name not being empty). If so, add it
 	                if (!strCurrentRegionDefName.empty())
 	                {
 	                    //Save the region and reset the name
-	                    mRegions.insert(std::make_pair(strCurrentRegionDefName, CurrentRegion));
+	                    Result.vctRegions.emplace_back(strCurrentRegionDefName, CurrentRegion);
 	                    strCurrentRegionDefName = "";
 	                }
 
 	                //Set the current region
-	                strCurrentRegionName = fst.string() + ":" + tokens[1];
+	                strCurrentRegionName = InPackagePath.string().append(":").append(tokens[1]);
 	            }
-	            else if ((tokens[0] == "EXPORT_SEASON" || tokens[0] == "EXPORT_EXTEND_SEASON") && tokens.size() >= 4)
+	            else if ((Command == LibraryCommand::ExportSeason || Command == LibraryCommand::ExportExtendSeason) && tokens.size() >= 4)
 	            {
 	                //Format: EXPORT_SEASON <seasons (comma-delimited)> <virtual path> <real path>
 	                //Create (or get) the definition for the virtual path
@@ -335,15 +400,9 @@ namespace XPLibrary
 	                //Get the index of the current RegionalDefinition in this definition
 	                auto &RegionalDef = it->second.vctRegionalDefs[it->second.GetRegionalDefinitionIdx(strCurrentRegionName)];
 
-	                //Now we need to get the real path. We do this by removing the first 3 tokens from the stream, then we can getline
-	                ssLineBuffer >> strBuffer >> strBuffer >> strBuffer;
-	                strBuffer.clear();
-	                std::getline(ssLineBuffer, strBuffer);
-	                strBuffer = TextUtils::TrimWhitespace(strBuffer);
-
-	                //Define our definition path
+	                //Define our definition path. The real path is the rest of the line after the first 3 tokens, since it can contain spaces.
 	                DefinitionPath DefPath;
-	                DefPath.SetPath(fst, strBuffer);
+	                DefPath.SetPath(idPackagePath, TextUtils::GetRestOfLine(strBuffer, tokens[2]));
 
 	                //Add this path to the options for the appropriate seasons
 	                if (tokens[1].find(SUM) != std::string::npos)
@@ -355,7 +414,7 @@ namespace XPLibrary
 	                if (tokens[1].find(FAL) != std::string::npos)
 	                    RegionalDef.dFall.AddOption(DefPath);
 	            }
-	            else if (tokens[0] == "EXPORT_RATIO_SEASON" && tokens.size() >= 5)
+	            else if (Command == LibraryCommand::ExportRatioSeason && tokens.size() >= 5)
 	            {
 	                //Format: EXPORT_RATIO_SEASON <seasons (comma-delimited)> <ratio> <virtual path> <real path>
 	                //Create (or get) the definition for the virtual path
@@ -367,38 +426,25 @@ namespace XPLibrary
 	                //Get the index of the current RegionalDefinition in this definition
 	                auto &RegionalDef = it->second.vctRegionalDefs[it->second.GetRegionalDefinitionIdx(strCurrentRegionName)];
 
-	                //Now we need to get the real path. We do this by removing the first 4 tokens from the stream, then we can getline
-	                ssLineBuffer >> strBuffer >> strBuffer >> strBuffer >> strBuffer;
-	                strBuffer.clear();
-	                std::getline(ssLineBuffer, strBuffer);
-	                strBuffer = TextUtils::TrimWhitespace(strBuffer);
-
-	                //Define our definition path
+	                //Define our definition path. The real path is the rest of the line after the first 4 tokens, since it can contain spaces.
 	                DefinitionPath DefPath;
-	                DefPath.SetPath(fst, strBuffer);
+	                DefPath.SetPath(idPackagePath, TextUtils::GetRestOfLine(strBuffer, tokens[3]));
 
-	                //Get the ratio
-	                try
-	                {
-	                    double dblRatio = 1;
-	                    dblRatio = std::stod(tokens[2]);
-	                }
-	                catch (...)
-	                {
-	                    //TODO: Log something here
-	                }
+	                //Get the ratio. An unreadable one leaves the option at the default weight.
+	                double dblRatio = 1;
+	                TextUtils::ParseNumber(tokens[2], dblRatio);
 
 	                //Add this path to the options for the appropriate seasons
 	                if (tokens[1].find(SUM) != std::string::npos)
-	                    RegionalDef.dSummer.AddOption(DefPath);
+	                    RegionalDef.dSummer.AddOption(DefPath, dblRatio);
 	                if (tokens[1].find(WIN) != std::string::npos)
-	                    RegionalDef.dWinter.AddOption(DefPath);
+	                    RegionalDef.dWinter.AddOption(DefPath, dblRatio);
 	                if (tokens[1].find(SPR) != std::string::npos)
-	                    RegionalDef.dSpring.AddOption(DefPath);
+	                    RegionalDef.dSpring.AddOption(DefPath, dblRatio);
 	                if (tokens[1].find(FAL) != std::string::npos)
-	                    RegionalDef.dFall.AddOption(DefPath);
+	                    RegionalDef.dFall.AddOption(DefPath, dblRatio);
 	            }
-	            else if (tokens[0] == "EXPORT_EXCLUDE_SEASON" && tokens.size() >= 4)
+	            else if (Command == LibraryCommand::ExportExcludeSeason && tokens.size() >= 4)
 	            {
 	                //Format: EXPORT_EXCLUDE <seasons (comma-delimited)> <virtual path> <real path>
 	                //Create (or get) the definition for the virtual path
@@ -410,18 +456,13 @@ namespace XPLibrary
 	                //Get the index of the current RegionalDefinition in this definition
 	                auto &RegionalDef = it->second.vctRegionalDefs[it->second.GetRegionalDefinitionIdx(strCurrentRegionName)];
 
-	                //Now we need to get the real path. We do this by removing the first 3 tokens from the stream, then we can getline
-	                ssLineBuffer >> strBuffer >> strBuffer >> strBuffer;
-	                strBuffer.clear();
-	                std::getline(ssLineBuffer, strBuffer);
-	                strBuffer = TextUtils::TrimWhitespace(strBuffer);
-
-	                //Define our definition path
+	                //Define our definition path. The real path is the rest of the line after the first 3 tokens, since it can contain spaces.
 	                DefinitionPath DefPath;
-	                DefPath.SetPath(fst, strBuffer);
+	                DefPath.SetPath(idPackagePath, TextUtils::GetRestOfLine(strBuffer, tokens[2]));
 
-	                //Since this is an exclude, we need to reset the options first
+	                //Since this is an exclude, we need to reset the options first. Options from earlier files are dropped when merging.
 	                RegionalDef.dDefault.ResetOptions();
+	                Result.setDefaultResets.emplace(tokens[2], strCurrentRegionName);
 
 	                //Add this path to the options for the appropriate seasons
 	                if (tokens[1].find(SUM) != std::string::npos)
@@ -433,11 +474,11 @@ namespace XPLibrary
 	                if (tokens[1].find(FAL) != std::string::npos)
 	                    RegionalDef.dFall.AddOption(DefPath);
 	            }
-	            else if (tokens[0] == "PUBLIC")
+	            else if (Command == LibraryCommand::Public)
 	            {
 	                bInPrivate = false;
 	            }
-	            else if (tokens[0] == "PRIVATE")
+	            else if (Command == LibraryCommand::Private)
 	            {
 	                bInPrivate = true;
 	            }
@@ -445,44 +486,976 @@ namespace XPLibrary
 	            //Handle multi-line commands
 
 	            //The end of a region command
-	            if (bLastCommandWasRegion && !bThisCommandWasRegion)
+	            if (bLastCommandWasRegion && !bThisCommandWasRegion && !strCurrentRegionDefName.empty())
 	            {
 	                //Save the region and reset the name
-	                mRegions.insert(std::make_pair(strCurrentRegionDefName, CurrentRegion));
+	                Result.vctRegions.emplace_back(strCurrentRegionDefName, CurrentRegion);
 	                strCurrentRegionDefName = "";
 	            }
+	            bLastCommandWasRegion = bThisCommandWasRegion;
 
 
 	            //Peek to set flags
 	            ifsLib.peek();
 	        }
+
+	        Result.Stats.uintDefinitions = Result.mDefinitions.size();
+	        Result.Stats.uintRegions = Result.vctRegions.size();
+	        Result.Stats.Memory = GetLibraryFileMemory(Result);
+	        Result.Stats.dblParseMs = Timer.GetMs();
+	        return Result;
+	    }
+
+	    /**
+	     * @brief Merges what one file contributed to a single definition into the combined definition. Must be called in priority order.
+	     */
+	    void MergeDefinition(Definition &InOutDefinition, const std::string &InPath, const Definition &InFileDefinition, const LibraryFileResult &InFile)
+	    {
+	        if (InFileDefinition.bIsPrivate)
+	            InOutDefinition.bIsPrivate = true;
+	        if (InOutDefinition.vctRegionalDefs.empty())
+	            InOutDefinition.vctRegionalDefs.reserve(InFileDefinition.vctRegionalDefs.size());
+
+	        ///< Regions are looked up (or appended) in the order this file first used them, which keeps vctRegionalDefs in the same order a sequential parse would give
+	        for (const auto &FileRegionalDef : InFileDefinition.vctRegionalDefs)
+	        {
+	            auto &RegionalDef = InOutDefinition.vctRegionalDefs[InOutDefinition.GetRegionalDefinitionIdx(FileRegionalDef.strRegionName)];
+
+	            if (InFile.setDefaultResets.contains({InPath, FileRegionalDef.strRegionName}))
+	                RegionalDef.dDefault.ResetOptions();
+
+	            AppendOptions(RegionalDef.dSummer, FileRegionalDef.dSummer);
+	            AppendOptions(RegionalDef.dWinter, FileRegionalDef.dWinter);
+	            AppendOptions(RegionalDef.dFall, FileRegionalDef.dFall);
+	            AppendOptions(RegionalDef.dSpring, FileRegionalDef.dSpring);
+	            AppendOptions(RegionalDef.dDefault, FileRegionalDef.dDefault);
+	            AppendOptions(RegionalDef.dBackup, FileRegionalDef.dBackup);
+	        }
 	    }
 
-	    //Add the temp definitions to the main definitions
+	    /**
+	     * @brief Merges one file's contribution into the combined definitions and regions. Must be called in priority order.
+	     */
+	    void MergeLibraryFile(MergeDefinitionMap &InOutDefinitions, std::map<std::string, Region> &InOutRegions, const LibraryFileResult &InFile)
+	    {
+	        for (const auto &[strPath, FileDef] : InFile.mDefinitions)
+	            MergeDefinition(FindOrAddDefinition(InOutDefinitions, strPath)->second, strPath, FileDef, InFile);
+
+	        for (const auto &Region : InFile.vctRegions)
+	            InOutRegions.insert(Region);
+	    }
+
+	    /**
+	     * @brief Adds a real file from the current package to its definition, as a default option in region_all
+	     */
+	    void AddPackageFile(Definition &InOutDefinition, const fs::path &InCurrentPackagePath, const fs::path &InRelativePath)
+	    {
+	        //Define a new DefinitionPath
+	        DefinitionPath DefPath;
+	        DefPath.SetPath(InCurrentPackagePath, InRelativePath);
+
+	        InOutDefinition.vctRegionalDefs[InOutDefinition.GetRegionalDefinitionIdx("region_all")].dDefault.AddOption(DefPath);
+	    }
+
+	    /**
+	     * @brief Finds all the real files in the current package, relative to it. Sorted so the result doesn't depend on directory order.
+	     */
+	    std::vector<fs::path> ScanPackageFiles(const fs::path &InCurrentPackagePath)
+	    {
+	        XPLIB_ZONE("ScanPackageFiles");
+
+	        ///< Define a list of acceptable extensions to add to the library.txt
+	        std::vector<std::string> vctXPExtensions = {
+	            ".lin",
+	            ".pol",
+	            ".str",
+	            ".ter",
+	            ".net",
+	            ".obj",
+	            ".agb",
+	            ".ags",
+	            ".agp",
+	            ".bch",
+	            ".fac", // Facade files
+	            ".for"  // Forest files
+	        };
+	        std::ranges::sort(vctXPExtensions);
+
+	        std::vector<fs::path> vctPackageFiles;
+	        std::error_code ec;
+	        for (const auto &p : fs::recursive_directory_iterator(InCurrentPackagePath, fs::directory_options::skip_permission_denied, ec))
+	        {
+	            if (std::ranges::binary_search(vctXPExtensions, p.path().extension().string()))
+	                vctPackageFiles.push_back(p.path().lexically_relative(InCurrentPackagePath));
+	        }
+	        std::ranges::sort(vctPackageFiles);
+
+	        return vctPackageFiles;
+	    }
+
+	    /**
+	     * @brief Gets a list of all library.txt files in the custom scenery packs, and in the resources directory (XpRoot/Resources/default scenery), in priority order.
+	     * Directory iteration order is up to the file system, so each pack's files are sorted to keep the merge order the same between runs.
+	     * Packs that don't exist (anymore) are skipped.
+	     */
+	    std::vector<LibraryFile> ScanLibraryFiles(const fs::path &InXpRootPath, const std::vector<fs::path> &InCustomSceneryPacks)
+	    {
+	        XPLIB_ZONE("ScanLibraryFiles");
+
+	        std::vector<LibraryFile> vctLibs;
+
+	        auto ScanFolder = [&](const fs::path &InFolder) {
+	            const size_t idxFirst = vctLibs.size();
+
+	            std::error_code ec;
+	            for (const auto &p : fs::recursive_directory_iterator(InFolder, fs::directory_options::skip_permission_denied, ec))
+	            {
+	                if (p.path().filename() != "library.txt")
+	                    continue;
+
+	                LibraryFile Lib;
+	                Lib.pPackagePath = p.path().parent_path();
+	                Lib.pLibraryPath = p.path();
+	                Lib.uintSize = p.file_size(ec);
+	                Lib.intModified = p.last_write_time(ec).time_since_epoch().count();
+	                vctLibs.push_back(std::move(Lib));
+	            }
+
+	            std::sort(vctLibs.begin() + static_cast<std::ptrdiff_t>(idxFirst), vctLibs.end(), [](const LibraryFile &InA, const LibraryFile &InB) {
+	                return std::tie(InA.pPackagePath, InA.pLibraryPath) < std::tie(InB.pPackagePath, InB.pLibraryPath);
+	            });
+	        };
+
+	        for (const auto &p : InCustomSceneryPacks)
+	            ScanFolder(p);
+	        ScanFolder(InXpRootPath / "Resources" / "default scenery");
+
+	        return vctLibs;
+	    }
+
+	    /**
+	     * @brief Parses the given library.txt files on the worker pool
+	     *
+	     * @param InLibs = All library files
+	     * @param InIndices = Indices into InLibs of the files to parse
+	     * @param OutResults = Results, indexed like InLibs. Only the entries in InIndices are written.
+	     */
+	    void ParseLibraryFiles(const std::vector<LibraryFile> &InLibs, const std::vector<size_t> &InIndices, std::vector<LibraryFileResult> &OutResults)
+	    {
+	        XPLIB_ZONE("ParseLibraryFiles");
+	        ThreadUtils::ParallelFor(InIndices.size(), [&](const size_t i) {
+	            const size_t idx = InIndices[i];
+	            OutResults[idx] = ParseLibraryFile(InLibs[idx].pPackagePath, InLibs[idx].pLibraryPath);
+	        });
+	    }
+
+	    /**
+	     * @brief Adds the stats of the files that were just parsed, in priority order
+	     *
+	     * @param InOutStats = Stats to add to
+	     * @param InResults = Parse results
+	     * @param InIndices = Indices into InResults of the files that were parsed, ascending
+	     */
+	    void AddParseStats(LoadStats &InOutStats, const std::vector<LibraryFileResult> &InResults, const std::vector<size_t> &InIndices)
+	    {
+	        InOutStats.uintLibraryFilesParsed += InIndices.size();
+	        for (const size_t idx : InIndices)
+	        {
+	            const LibraryFileStats &FileStats = InResults[idx].Stats;
+	            InOutStats.uintBytesRead += FileStats.uintBytes;
+	            InOutStats.uintLinesParsed += FileStats.uintLines;
+	            InOutStats.vctFiles.push_back(FileStats);
+	        }
+	    }
+
+	    ///< Snapshot file header. Bump the version whenever the layout below, or what the parser makes of the same text, changes.
+	    constexpr char SNAPSHOT_MAGIC[8] = {'X', 'P', 'L', 'I', 'B', 'V', 'F', 'S'};
+	    constexpr uint32_t SNAPSHOT_VERSION = 4;
+
+	    /**
+	     * @brief Folds a path into a running hash. The length goes in first so neighbouring paths can't run together.
+	     */
+	    uint64_t HashPath(const uint64_t InHash, const fs::path &InPath)
+	    {
+	        const std::u8string strPath = InPath.u8string();
+	        return HashUtils::Fnv1a(reinterpret_cast<const char *>(strPath.data()), strPath.size(), HashUtils::Combine(InHash, strPath.size()));
+	    }
+
+	    /**
+	     * @brief Computes the key a snapshot is valid for: the load arguments, the real files in the current package, and every library.txt with its size and modification time
+	     */
+	    uint64_t ComputeSnapshotKey(const fs::path &InXpRootPath, const fs::path &InCurrentPackagePath, const std::vector<fs::path> &InCustomSceneryPacks, const std::vector<fs::path> &InPackageFiles, const std::vector<LibraryFile> &InLibs)
+	    {
+	        uint64_t uintHash = HashUtils::Combine(HashUtils::FNV_OFFSET, SNAPSHOT_VERSION);
+	        uintHash = HashPath(uintHash, InXpRootPath);
+	        uintHash = HashPath(uintHash, InCurrentPackagePath);
+
+	        uintHash = HashUtils::Combine(uintHash, InCustomSceneryPacks.size());
+	        for (const auto &p : InCustomSceneryPacks)
+	            uintHash = HashPath(uintHash, p);
+
+	        uintHash = HashUtils::Combine(uintHash, InPackageFiles.size());
+	        for (const auto &p : InPackageFiles)
+	            uintHash = HashPath(uintHash, p);
+
+	        uintHash = HashUtils::Combine(uintHash, InLibs.size());
+	        for (const auto &Lib : InLibs)
+	        {
+	            uintHash = HashPath(uintHash, Lib.pLibraryPath);
+	            uintHash = HashUtils::Combine(uintHash, Lib.uintSize);
+	            uintHash = HashUtils::Combine(uintHash, static_cast<uint64_t>(Lib.intModified));
+	        }
+
+	        return uintHash;
+	    }
+
+	    /**
+	     * @brief Paths used by a snapshot. Each one is written once, and options refer to it by its index in the table.
+	     */
+	    class SnapshotPaths
+	    {
+	    public:
+	        ///< Gets the snapshot index for an interned path, adding it if needed
+	        uint32_t Add(const PathId InId)
+	        {
+	            const auto [it, bAdded] = mIndices.emplace(InId, static_cast<uint32_t>(vctIds.size()));
+	            if (bAdded)
+	                vctIds.push_back(InId);
+	            return it->second;
+	        }
+
+	        void Write(FileUtils::BinaryWriter &InWriter) const
+	        {
+	            InWriter.Write(static_cast<uint32_t>(vctIds.size()));
+	            for (const PathId id : vctIds)
+	                InWriter.WritePath(ResolvePath(id));
+	        }
+
+	    private:
+	        std::unordered_map<PathId, uint32_t> mIndices;
+	        std::vector<PathId> vctIds;
+	    };
+
+	    void WriteOptions(FileUtils::BinaryWriter &InWriter, SnapshotPaths &InPaths, const DefinitionOptions &InOptions)
+	    {
+	        InWriter.Write(static_cast<uint32_t>(InOptions.GetOptions().size()));
+	        for (const auto &[dblRatio, DefPath] : InOptions.GetOptions())
+	        {
+	            InWriter.Write(dblRatio);
+	            InWriter.Write(InPaths.Add(DefPath.idPackagePath));
+	            InWriter.Write(InPaths.Add(DefPath.idPath));
+	            InWriter.Write(static_cast<uint8_t>(DefPath.bFromLibrary));
+	        }
+	    }
+
+	    /**
+	     * @brief Reads options written by WriteOptions
+	     *
+	     * @param InReader = Snapshot reader
+	     * @param InPaths = Interned IDs of the snapshot's path table, by snapshot index
+	     * @param OutOptions = Options to add to
+	     * @returns False if the options are corrupt
+	     */
+	    bool ReadOptions(FileUtils::BinaryReader &InReader, const std::vector<PathId> &InPaths, DefinitionOptions &OutOptions)
+	    {
+	        uint32_t uintCount = 0;
+	        InReader.Read(uintCount);
+	        for (uint32_t i = 0; i < uintCount && InReader.IsGood(); i++)
+	        {
+	            double dblRatio = 1;
+	            uint32_t uintPackage = 0, uintRelative = 0;
+	            uint8_t uintFromLibrary = 0;
+	            InReader.Read(dblRatio);
+	            InReader.Read(uintPackage);
+	            InReader.Read(uintRelative);
+	            InReader.Read(uintFromLibrary);
+	            if (uintPackage >= InPaths.size() || uintRelative >= InPaths.size())
+	                return false;
+
+	            DefinitionPath DefPath;
+	            DefPath.idPackagePath = InPaths[uintPackage];
+	            DefPath.idPath = InPaths[uintRelative];
+	            DefPath.bFromLibrary = uintFromLibrary != 0;
+	            OutOptions.AddOption(DefPath, dblRatio);
+	        }
+
+	        return InReader.IsGood();
+	    }
+
+	    void WriteRegion(FileUtils::BinaryWriter &InWriter, const Region &InRegion)
+	    {
+	        InWriter.Write(InRegion.dblNorth);
+	        InWriter.Write(InRegion.dblSouth);
+	        InWriter.Write(InRegion.dblEast);
+	        InWriter.Write(InRegion.dblWest);
+	        InWriter.Write(static_cast<uint32_t>(InRegion.Conditions.size()));
+	        for (const auto &[strValue1, strOperator, strValue2] : InRegion.Conditions)
+	        {
+	            InWriter.WriteString(strValue1);
+	            InWriter.WriteString(strOperator);
+	            InWriter.WriteString(strValue2);
+	        }
+	    }
+
+	    void ReadRegion(FileUtils::BinaryReader &InReader, Region &OutRegion)
+	    {
+	        uint32_t uintCount = 0;
+	        InReader.Read(OutRegion.dblNorth);
+	        InReader.Read(OutRegion.dblSouth);
+	        InReader.Read(OutRegion.dblEast);
+	        InReader.Read(OutRegion.dblWest);
+	        InReader.Read(uintCount);
+	        for (uint32_t i = 0; i < uintCount && InReader.IsGood(); i++)
+	        {
+	            std::string strValue1, strOperator, strValue2;
+	            InReader.ReadString(strValue1);
+	            InReader.ReadString(strOperator);
+	            InReader.ReadString(strValue2);
+	            OutRegion.Conditions.emplace_back(std::move(strValue1), std::move(strOperator), std::move(strValue2));
+	        }
+	    }
+	} // namespace
+
+	/**
+	* @brief LoadFileSystem - Loads the files from the Library.txt and real paths into the vPaths vector
+	*
+	* @param InXpRootPath = The root path of the X-Plane installation
+	* @param InCurrentPackagePath
+	* @param InCustomSceneryPacks = A vector of paths to custom scenery packs. These should be ordered based on the scenery_packs.ini, with the first element being the highest priority scenery
+	* @param InSnapshotPath = Optional snapshot file. Read instead of parsing when its key matches, rewritten when it doesn't.
+	*/
+	void VirtualFileSystem::LoadFileSystem(const std::filesystem::path &InXpRootPath, const std::filesystem::path &InCurrentPackagePath, const std::vector<std::filesystem::path> &InCustomSceneryPacks, const std::filesystem::path &InSnapshotPath)
+	{
+	    ///< Remember the inputs so Reload can scan them again
+	    pXpRootPath = InXpRootPath;
+	    pCurrentPackagePath = InCurrentPackagePath;
+	    vctCustomSceneryPacks = InCustomSceneryPacks;
+	    pSnapshotPath = InSnapshotPath;
+	    bHasLoaded = true;
+	    bLoadedFromSnapshot = false;
+	    vctLibraryResults.clear();
+
+	    XPLIB_ZONE("LoadFileSystem");
+	    const ProfileUtils::Stopwatch TotalTimer;
+	    ProfileUtils::Stopwatch Timer;
+	    Stats = {};
+
+	    //First find all the real files in the Current Package, and all the library.txt files
+	    vctPackageFiles = ScanPackageFiles(InCurrentPackagePath);
+	    vctLibraryFiles = ScanLibraryFiles(InXpRootPath, InCustomSceneryPacks);
+	    Stats.uintPackageFilesScanned = vctPackageFiles.size();
+	    Stats.uintLibraryFilesScanned = vctLibraryFiles.size();
+	    Stats.dblScanMs = Timer.GetMs();
+
+	    //If nothing changed since the snapshot was written, it already holds the result
+	    Timer.Restart();
+	    if (!pSnapshotPath.empty() && LoadSnapshot(pSnapshotPath, ComputeSnapshotKey(pXpRootPath, pCurrentPackagePath, vctCustomSceneryPacks, vctPackageFiles, vctLibraryFiles)))
+	    {
+	        bLoadedFromSnapshot = true;
+	        Stats.bFromSnapshot = true;
+	        Stats.uintDefinitionsCreated = vctDefinitions.size();
+	        Stats.uintRegions = mRegions.size();
+	        Stats.dblSnapshotMs = Timer.GetMs();
+	        Stats.dblTotalMs = TotalTimer.GetMs();
+	        return;
+	    }
+	    Stats.dblSnapshotMs = Timer.GetMs();
+
+	    //Now we will process the library.txt files. Each file is parsed on its own by the worker pool, then the results are merged
+	    //in the order the files were found, which is the priority order. This keeps vctRegionalDefs the same between runs.
+	    Timer.Restart();
+	    std::vector<size_t> vctAll(vctLibraryFiles.size());
+	    std::iota(vctAll.begin(), vctAll.end(), 0);
+	    vctLibraryResults.resize(vctLibraryFiles.size());
+	    ParseLibraryFiles(vctLibraryFiles, vctAll, vctLibraryResults);
+	    AddParseStats(Stats, vctLibraryResults, vctAll);
+	    Stats.dblParseMs = Timer.GetMs();
+
+	    Timer.Restart();
+	    RebuildAll();
+	    Stats.uintDefinitionsCreated = vctDefinitions.size();
+	    Stats.uintRegions = mRegions.size();
+	    Stats.dblBuildMs = Timer.GetMs();
+
+	    //Save the result for next time. The snapshot is only a cache, so failing to write it is not an error.
+	    Timer.Restart();
+	    if (!pSnapshotPath.empty())
+	        SaveSnapshot(pSnapshotPath, ComputeSnapshotKey(pXpRootPath, pCurrentPackagePath, vctCustomSceneryPacks, vctPackageFiles, vctLibraryFiles));
+	    Stats.dblSnapshotMs += Timer.GetMs();
+	    Stats.dblTotalMs = TotalTimer.GetMs();
+	}
+
+	/**
+	* @brief Reload - Rescans the inputs of the last LoadFileSystem and updates the file system in place
+	*
+	* @return The virtual paths whose definitions were rebuilt, added or removed, sorted
+	*/
+	std::vector<std::string> VirtualFileSystem::Reload()
+	{
+	    if (!bHasLoaded)
+	        return {};
+
+	    XPLIB_ZONE("Reload");
+	    const ProfileUtils::Stopwatch TotalTimer;
+	    ProfileUtils::Stopwatch Timer;
+	    Stats = {};
+
+	    std::vector<fs::path> vctNewPackageFiles = ScanPackageFiles(pCurrentPackagePath);
+	    std::vector<LibraryFile> vctNewLibs = ScanLibraryFiles(pXpRootPath, vctCustomSceneryPacks);
+	    std::vector<LibraryFileResult> vctNewResults(vctNewLibs.size());
+	    Stats.uintPackageFilesScanned = vctNewPackageFiles.size();
+	    Stats.uintLibraryFilesScanned = vctNewLibs.size();
+	    Stats.uintRegions = mRegions.size();
+	    Stats.dblScanMs = Timer.GetMs();
+
+	    ///< After a snapshot load nothing was parsed, so we know which files changed but not what they used to contribute
+	    const bool bHaveResults = vctLibraryResults.size() == vctLibraryFiles.size();
+
+	    ///< Match the new files up with the old ones by path
+	    std::map<fs::path, size_t> mOldIndices;
+	    for (size_t i = 0; i < vctLibraryFiles.size(); i++)
+	        mOldIndices.emplace(vctLibraryFiles[i].pLibraryPath, i);
+
+	    std::vector<size_t> vctOldMatch(vctNewLibs.size(), SIZE_MAX); ///< Old index of each unchanged new file
+	    std::vector<bool> vctOldUnchanged(vctLibraryFiles.size(), false);
+	    std::vector<size_t> vctChanged;                                ///< New files that were added or modified
+	    for (size_t i = 0; i < vctNewLibs.size(); i++)
+	    {
+	        if (const auto it = mOldIndices.find(vctNewLibs[i].pLibraryPath); it != mOldIndices.end() && vctLibraryFiles[it->second].SameStamp(vctNewLibs[i]))
+	        {
+	            vctOldMatch[i] = it->second;
+	            vctOldUnchanged[it->second] = true;
+	        }
+	        else
+	            vctChanged.push_back(i);
+	    }
+
+	    ///< Anything old that didn't survive unchanged was modified or removed
+	    std::vector<size_t> vctRetracted;
+	    for (size_t i = 0; i < vctLibraryFiles.size(); i++)
+	    {
+	        if (!vctOldUnchanged[i])
+	            vctRetracted.push_back(i);
+	    }
+
+	    if (vctChanged.empty() && vctRetracted.empty() && vctNewPackageFiles == vctPackageFiles)
+	    {
+	        Stats.dblTotalMs = TotalTimer.GetMs();
+	        return {};
+	    }
+
+	    ///< Collect what the retracted files used to contribute, before their results are dropped
+	    std::set<std::string> setAffected;
+	    std::set<std::string> setAffectedRegions;
+	    for (const size_t idx : vctRetracted)
+	    {
+	        if (!bHaveResults)
+	            break;
+	        for (const auto &strPath : vctLibraryResults[idx].mDefinitions | std::views::keys)
+	            setAffected.insert(strPath);
+	        for (const auto &strRegion : vctLibraryResults[idx].vctRegions | std::views::keys)
+	            setAffectedRegions.insert(strRegion);
+	    }
+
+	    ///< Package files that appeared or disappeared
+	    {
+	        std::vector<fs::path> vctPackageChanges;
+	        std::ranges::set_symmetric_difference(vctPackageFiles, vctNewPackageFiles, std::back_inserter(vctPackageChanges));
+	        for (const auto &p : vctPackageChanges)
+	            setAffected.insert(p.string());
+	    }
+
+	    ///< Reuse unchanged results and parse only what changed. Without old results, every file has to be parsed once.
+	    Timer.Restart();
+	    std::vector<size_t> vctToParse;
+	    for (size_t i = 0; i < vctNewLibs.size(); i++)
+	    {
+	        if (bHaveResults && vctOldMatch[i] != SIZE_MAX)
+	            vctNewResults[i] = std::move(vctLibraryResults[vctOldMatch[i]]);
+	        else
+	            vctToParse.push_back(i);
+	    }
+	    ParseLibraryFiles(vctNewLibs, vctToParse, vctNewResults);
+	    AddParseStats(Stats, vctNewResults, vctToParse);
+	    Stats.dblParseMs = Timer.GetMs();
+
+	    Timer.Restart();
+	    for (const size_t idx : vctChanged)
+	    {
+	        for (const auto &strPath : vctNewResults[idx].mDefinitions | std::views::keys)
+	            setAffected.insert(strPath);
+	        for (const auto &strRegion : vctNewResults[idx].vctRegions | std::views::keys)
+	            setAffectedRegions.insert(strRegion);
+	    }
+
+	    vctPackageFiles = std::move(vctNewPackageFiles);
+	    vctLibraryFiles = std::move(vctNewLibs);
+	    vctLibraryResults = std::move(vctNewResults);
+	    bLoadedFromSnapshot = false;
+
+	    if (!bHaveResults)
+	    {
+	        ///< We can't tell what the old files contributed, so rebuild every path and region that existed before or exists now
+	        for (const auto &strPath : mDefinitionIndex | std::views::keys)
+	            setAffected.insert(strPath);
+	        for (const auto &p : vctPackageFiles)
+	            setAffected.insert(p.string());
+	        for (const auto &strRegion : mRegions | std::views::keys)
+	            setAffectedRegions.insert(strRegion);
+	        for (const auto &Result : vctLibraryResults)
+	        {
+	            for (const auto &strPath : Result.mDefinitions | std::views::keys)
+	                setAffected.insert(strPath);
+	            for (const auto &strRegion : Result.vctRegions | std::views::keys)
+	                setAffectedRegions.insert(strRegion);
+	        }
+	    }
+
+	    RebuildRegions(setAffectedRegions);
+	    RebuildRegionTable();
+	    RebuildDefinitions(setAffected);
+	    Stats.uintDefinitionsCreated = setAffected.size();
+	    Stats.uintRegions = mRegions.size();
+	    Stats.dblBuildMs = Timer.GetMs();
+
+	    Timer.Restart();
+	    if (!pSnapshotPath.empty())
+	        SaveSnapshot(pSnapshotPath, ComputeSnapshotKey(pXpRootPath, pCurrentPackagePath, vctCustomSceneryPacks, vctPackageFiles, vctLibraryFiles));
+	    Stats.dblSnapshotMs = Timer.GetMs();
+	    Stats.dblTotalMs = TotalTimer.GetMs();
+
+	    return {setAffected.begin(), setAffected.end()};
+	}
+
+	/**
+	* @brief RebuildAll - Rebuilds every definition and region from the package files and the parsed library files
+	*/
+	void VirtualFileSystem::RebuildAll()
+	{
+	    XPLIB_ZONE("RebuildAll");
+
+	    ///< The merge map only lives until its definitions are moved out, so it allocates from one arena that is released in one go.
+	    ///< The first block is sized for every definition the inputs mention, an upper bound since files can share paths.
+	    size_t uintMaxDefinitions = vctPackageFiles.size();
+	    for (const auto &Result : vctLibraryResults)
+	        uintMaxDefinitions += Result.mDefinitions.size();
+	    std::pmr::monotonic_buffer_resource Arena(std::max<size_t>(uintMaxDefinitions * MERGE_BYTES_PER_DEFINITION, 4096));
+	    MergeDefinitionMap mTempDefinitions(&Arena);
+
+	    ///< We will first add a new region, region_all, which contains everything that is not regionalized.
+	    mRegions.clear();
+	    Region Region_All;
+	    mRegions.insert(std::make_pair("region_all", Region_All));
+
+	    //Add the real files from the Current Package
+	    for (const auto &p : vctPackageFiles)
+	        AddPackageFile(FindOrAddDefinition(mTempDefinitions, p.string())->second, pCurrentPackagePath, p);
+
+	    for (const auto &Result : vctLibraryResults)
+	        MergeLibraryFile(mTempDefinitions, mRegions, Result);
+
+	    //Move the temp definitions into the main definitions. Their vectors and paths are heap allocated, so they move without copying.
 	    vctDefinitions.clear();
 	    vctDefinitions.reserve(mTempDefinitions.size());
 	    for (auto &val : mTempDefinitions | std::views::values)
 	    {
-	        vctDefinitions.push_back(val);
+	        vctDefinitions.push_back(std::move(val));
 	    }
+
+	    RebuildIndex();
+	    RebuildRegionTable();
+	    for (auto &Def : vctDefinitions)
+	        FinalizeDefinition(Def);
 	}
 
 	/**
-	* @brief GetDefinition - Returns the definition of a given path
+	* @brief RebuildIndex - Rebuilds the virtual path index from vctDefinitions, skipping tombstones
+	*/
+	void VirtualFileSystem::RebuildIndex()
+	{
+	    mDefinitionIndex.clear();
+	    mDefinitionIndex.reserve(vctDefinitions.size());
+	    for (size_t i = 0; i < vctDefinitions.size(); i++)
+	    {
+	        if (!vctDefinitions[i].pVirtual.empty())
+	            mDefinitionIndex.emplace(vctDefinitions[i].pVirtual.string(), static_cast<uint32_t>(i));
+	    }
+	}
+
+	/**
+	* @brief RebuildDefinitions - Rebuilds only the given definitions from the package files and the parsed library files.
+	* Existing definitions are updated in place and new ones are appended, so handles to the others stay valid. Definitions nothing contributes to anymore become tombstones.
 	*
-	* @param InPath = The path to get the definition of
-	* @return The definition of the given path
+	* @param InPaths = Virtual paths to rebuild
+	*/
+	void VirtualFileSystem::RebuildDefinitions(const std::set<std::string> &InPaths)
+	{
+	    XPLIB_ZONE("RebuildDefinitions");
+
+	    for (const auto &strPath : InPaths)
+	    {
+	        ///< Rebuild the definition by merging every file that still contributes to it, in priority order
+	        Definition Def;
+	        Def.pVirtual = strPath;
+	        bool bUsed = false;
+
+	        if (std::ranges::binary_search(vctPackageFiles, fs::path(strPath)))
+	        {
+	            AddPackageFile(Def, pCurrentPackagePath, strPath);
+	            bUsed = true;
+	        }
+
+	        for (const auto &Result : vctLibraryResults)
+	        {
+	            if (const auto it = Result.mDefinitions.find(strPath); it != Result.mDefinitions.end())
+	            {
+	                MergeDefinition(Def, strPath, it->second, Result);
+	                bUsed = true;
+	            }
+	        }
+
+	        FinalizeDefinition(Def);
+
+	        const auto itIndex = mDefinitionIndex.find(strPath);
+	        if (bUsed && itIndex != mDefinitionIndex.end())
+	            vctDefinitions[itIndex->second] = std::move(Def);
+	        else if (bUsed)
+	        {
+	            mDefinitionIndex.emplace(strPath, static_cast<uint32_t>(vctDefinitions.size()));
+	            vctDefinitions.push_back(std::move(Def));
+	        }
+	        else if (itIndex != mDefinitionIndex.end())
+	        {
+	            vctDefinitions[itIndex->second] = Definition();
+	            mDefinitionIndex.erase(itIndex);
+	        }
+	    }
+	}
+
+	/**
+	* @brief RebuildRegions - Rebuilds only the given regions. The first file in priority order to define a region wins, regions no file defines anymore are removed.
+	*
+	* @param InNames = Region names to rebuild
+	*/
+	void VirtualFileSystem::RebuildRegions(const std::set<std::string> &InNames)
+	{
+	    XPLIB_ZONE("RebuildRegions");
+
+	    for (const auto &strName : InNames)
+	    {
+	        mRegions.erase(strName);
+
+	        ///< region_all is always added first, so no file can override it
+	        if (strName == "region_all")
+	        {
+	            mRegions.emplace(strName, Region());
+	            continue;
+	        }
+
+	        for (const auto &Result : vctLibraryResults)
+	        {
+	            const auto it = std::ranges::find(Result.vctRegions, strName, &std::pair<std::string, Region>::first);
+	            if (it != Result.vctRegions.end())
+	            {
+	                mRegions.emplace(strName, it->second);
+	                break;
+	            }
+	        }
+	    }
+	}
+
+	/**
+	* @brief RebuildRegionTable - Copies mRegions into the region table and rebuilds the spatial index. Names that are no longer defined keep their ID, with an empty region.
+	*/
+	void VirtualFileSystem::RebuildRegionTable()
+	{
+	    XPLIB_ZONE("RebuildRegionTable");
+
+	    for (auto &R : vctRegionTable)
+	        R = Region();
+
+	    for (const auto &[strName, R] : mRegions)
+	        vctRegionTable[GetOrAddRegionId(strName)] = R;
+
+	    RegionGrid.Build(vctRegionTable);
+	}
+
+	/**
+	* @brief GetOrAddRegionId - Gets the ID of a region name, adding an empty region for it if it is new
+	*/
+	RegionId VirtualFileSystem::GetOrAddRegionId(const std::string &InName)
+	{
+	    if (const auto it = mRegionIds.find(InName); it != mRegionIds.end())
+	        return it->second;
+
+	    const auto id = static_cast<RegionId>(vctRegionTable.size());
+	    vctRegionTable.emplace_back();
+	    mRegionIds.emplace(InName, id);
+	    return id;
+	}
+
+	/**
+	* @brief FinalizeDefinition - Prepares a built definition for lookups: assigns its region IDs, its seed hash, and builds its alias tables
+	*/
+	void VirtualFileSystem::FinalizeDefinition(Definition &InOutDefinition)
+	{
+	    InOutDefinition.uintPathHash = HashUtils::Fnv1a(InOutDefinition.pVirtual.generic_string());
+	    for (auto &RegionalDef : InOutDefinition.vctRegionalDefs)
+	    {
+	        RegionalDef.idRegion = GetOrAddRegionId(RegionalDef.strRegionName);
+	        RegionalDef.BuildAliasTables();
+	    }
+	}
+
+	/**
+	* @brief SaveSnapshot - Writes the resolved definitions and regions to a binary snapshot
+	*
+	* @param InPath = Snapshot file
+	* @param InKey = Key describing the inputs the definitions were built from
+	* @return True on success, false on failure
+	*/
+	bool VirtualFileSystem::SaveSnapshot(const std::filesystem::path &InPath, const uint64_t InKey) const
+	{
+	    XPLIB_ZONE("SaveSnapshot");
+
+	    ///< The body is written first so we know which paths it uses, then the path table goes in front of it
+	    SnapshotPaths Paths;
+	    FileUtils::BinaryWriter Body;
+
+	    ///< Tombstones are left out, handles don't outlive the process anyway
+	    Body.Write(static_cast<uint32_t>(mDefinitionIndex.size()));
+	    for (const auto &Def : vctDefinitions)
+	    {
+	        if (Def.pVirtual.empty())
+	            continue;
+
+	        Body.WritePath(Def.pVirtual);
+	        Body.Write(static_cast<uint8_t>(Def.bIsPrivate));
+	        Body.Write(static_cast<uint32_t>(Def.vctRegionalDefs.size()));
+	        for (const auto &RegionalDef : Def.vctRegionalDefs)
+	        {
+	            Body.WriteString(RegionalDef.strRegionName);
+	            for (const DefinitionOptions *pOptions : {&RegionalDef.dSummer, &RegionalDef.dWinter, &RegionalDef.dFall, &RegionalDef.dSpring, &RegionalDef.dDefault, &RegionalDef.dBackup})
+	                WriteOptions(Body, Paths, *pOptions);
+	        }
+	    }
+
+	    Body.Write(static_cast<uint32_t>(mRegions.size()));
+	    for (const auto &[strName, Region] : mRegions)
+	    {
+	        Body.WriteString(strName);
+	        WriteRegion(Body, Region);
+	    }
+
+	    FileUtils::BinaryWriter Writer;
+	    Writer.WriteBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	    Writer.Write(SNAPSHOT_VERSION);
+	    Writer.Write(InKey);
+	    Paths.Write(Writer);
+	    Writer.WriteBytes(Body.GetBuffer().data(), Body.GetBuffer().size());
+
+	    return Writer.SaveToFile(InPath);
+	}
+
+	/**
+	* @brief LoadSnapshot - Replaces the definitions and regions with the contents of a snapshot, if it is valid and was built from the same inputs
+	*
+	* @param InPath = Snapshot file
+	* @param InKey = Key describing the current inputs
+	* @return True if the snapshot was loaded. On false nothing is modified.
+	*/
+	bool VirtualFileSystem::LoadSnapshot(const std::filesystem::path &InPath, const uint64_t InKey)
+	{
+	    XPLIB_ZONE("LoadSnapshot");
+
+	    FileUtils::MappedFile File;
+	    if (!File.Open(InPath))
+	        return false;
+
+	    FileUtils::BinaryReader Reader(File.View());
+
+	    ///< Check the header
+	    char chrMagic[sizeof(SNAPSHOT_MAGIC)]{};
+	    uint32_t uintVersion = 0;
+	    uint64_t uintKey = 0;
+	    Reader.ReadBytes(chrMagic, sizeof(chrMagic));
+	    Reader.Read(uintVersion);
+	    Reader.Read(uintKey);
+	    if (!Reader.IsGood() || std::memcmp(chrMagic, SNAPSHOT_MAGIC, sizeof(chrMagic)) != 0 || uintVersion != SNAPSHOT_VERSION || uintKey != InKey)
+	        return false;
+
+	    ///< Intern the path table. Interned paths are never removed, so this is harmless even if the rest turns out to be corrupt.
+	    std::vector<PathId> vctPaths;
+	    uint32_t uintPathCount = 0;
+	    if (!Reader.Read(uintPathCount))
+	        return false;
+	    vctPaths.reserve(std::min<size_t>(uintPathCount, Reader.GetRemaining()));
+	    for (uint32_t i = 0; i < uintPathCount && Reader.IsGood(); i++)
+	    {
+	        fs::path pPath;
+	        if (Reader.ReadPath(pPath))
+	            vctPaths.push_back(InternPath(pPath));
+	    }
+
+	    ///< Read everything into temporaries so a truncated file can't leave us half loaded
+	    bool bOptionsGood = true;
+	    std::vector<Definition> vctNewDefinitions;
+	    uint32_t uintDefinitionCount = 0;
+	    if (!Reader.Read(uintDefinitionCount))
+	        return false;
+	    vctNewDefinitions.reserve(std::min<size_t>(uintDefinitionCount, Reader.GetRemaining()));
+	    for (uint32_t i = 0; i < uintDefinitionCount && Reader.IsGood() && bOptionsGood; i++)
+	    {
+	        Definition Def;
+	        uint8_t uintPrivate = 0;
+	        uint32_t uintRegionalCount = 0;
+	        Reader.ReadPath(Def.pVirtual);
+	        Reader.Read(uintPrivate);
+	        Reader.Read(uintRegionalCount);
+	        Def.bIsPrivate = uintPrivate != 0;
+
+	        for (uint32_t j = 0; j < uintRegionalCount && Reader.IsGood() && bOptionsGood; j++)
+	        {
+	            RegionalDefinitions RegionalDef;
+	            Reader.ReadString(RegionalDef.strRegionName);
+	            for (DefinitionOptions *pOptions : {&RegionalDef.dSummer, &RegionalDef.dWinter, &RegionalDef.dFall, &RegionalDef.dSpring, &RegionalDef.dDefault, &RegionalDef.dBackup})
+	                bOptionsGood = bOptionsGood && ReadOptions(Reader, vctPaths, *pOptions);
+	            Def.vctRegionalDefs.push_back(std::move(RegionalDef));
+	        }
+
+	        vctNewDefinitions.push_back(std::move(Def));
+	    }
+
+	    std::map<std::string, Region> mNewRegions;
+	    uint32_t uintRegionCount = 0;
+	    Reader.Read(uintRegionCount);
+	    for (uint32_t i = 0; i < uintRegionCount && Reader.IsGood(); i++)
+	    {
+	        std::string strName;
+	        Region NewRegion;
+	        Reader.ReadString(strName);
+	        ReadRegion(Reader, NewRegion);
+	        mNewRegions.emplace(std::move(strName), std::move(NewRegion));
+	    }
+
+	    if (!Reader.IsGood() || !bOptionsGood)
+	        return false;
+
+	    vctDefinitions = std::move(vctNewDefinitions);
+	    mRegions = std::move(mNewRegions);
+	    RebuildIndex();
+	    RebuildRegionTable();
+	    for (auto &Def : vctDefinitions)
+	        FinalizeDefinition(Def);
+	    Stats.uintBytesRead += File.Size();
+	    return true;
+	}
+
+	/**
+	* @brief GetTotal - Sums every category
+	*/
+	ProfileUtils::MemoryUsage FileSystemMemoryStats::GetTotal() const
+	{
+	    ProfileUtils::MemoryUsage Total;
+	    for (const ProfileUtils::MemoryUsage *pUsage : {&Definitions, &RegionalDefinitions, &Options, &PathStrings, &Regions, &Lookups, &ReloadState})
+	        Total += *pUsage;
+	    return Total;
+	}
+
+	/**
+	* @brief GetMemoryStats - Returns the memory the file system holds, by category
 	*/
-	Definition VirtualFileSystem::GetDefinition(const std::string &InPath)
+	FileSystemMemoryStats VirtualFileSystem::GetMemoryStats() const
 	{
-	    // Find the definition
-	    if (const auto itDef = std::lower_bound(vctDefinitions.begin(), vctDefinitions.end(), InPath); itDef != vctDefinitions.end() && itDef->pVirtual == InPath)
-	        return *itDef;
+	    XPLIB_ZONE("GetMemoryStats");
 
-	    // Return an empty definition
+	    FileSystemMemoryStats MemoryStats;
+
+	    MemoryStats.Definitions.AddVector(vctDefinitions);
+	    MemoryStats.Definitions.uintCount = mDefinitionIndex.size();
+	    for (const auto &Def : vctDefinitions)
+	        AddDefinitionMemory(Def, MemoryStats);
+
+	    MemoryStats.Regions.AddTreeNodes<std::pair<const std::string, Region>>(mRegions.size());
+	    for (const auto &[strName, R] : mRegions)
+	    {
+	        MemoryStats.PathStrings.AddString(strName);
+	        AddRegionMemory(R, MemoryStats.Regions);
+	    }
+	    MemoryStats.Regions.AddVector(vctRegionTable);
+	    for (const auto &R : vctRegionTable)
+	        AddRegionMemory(R, MemoryStats.Regions);
+	    MemoryStats.Regions.AddBytes(0, RegionGrid.GetMemoryUsage());
+	    MemoryStats.Regions.uintCount = mRegions.size();
+
+	    MemoryStats.Lookups.AddHashTable(mDefinitionIndex);
+	    MemoryStats.Lookups.AddHashTable(mRegionIds);
+	    for (const auto &strPath : mDefinitionIndex | std::views::keys)
+	        MemoryStats.PathStrings.AddString(strPath);
+	    for (const auto &strName : mRegionIds | std::views::keys)
+	        MemoryStats.PathStrings.AddString(strName);
+
+	    ///< Parse results were measured when they were parsed, and haven't changed since
+	    ProfileUtils::MemoryUsage &ReloadUsage = MemoryStats.ReloadState;
+	    ReloadUsage.AddVector(vctPackageFiles);
+	    for (const auto &p : vctPackageFiles)
+	        ReloadUsage.AddPath(p);
+	    ReloadUsage.AddVector(vctLibraryFiles);
+	    for (const auto &Lib : vctLibraryFiles)
+	    {
+	        ReloadUsage.AddPath(Lib.pPackagePath);
+	        ReloadUsage.AddPath(Lib.pLibraryPath);
+	    }
+	    ReloadUsage.AddVector(vctLibraryResults);
+	    for (const auto &Result : vctLibraryResults)
+	        ReloadUsage += Result.Stats.Memory;
+	    ReloadUsage.AddVector(Stats.vctFiles);
+	    for (const auto &FileStats : Stats.vctFiles)
+	        ReloadUsage.AddPath(FileStats.pLibraryPath);
+	    ReloadUsage.uintCount = vctLibraryFiles.size();
+
+	    return MemoryStats;
+	}
+
+	/**
+	* @brief FindDefinition - Looks up a virtual path. O(1), and doesn't allocate.
+	*
+	* @param InPath = The virtual path to find
+	* @return A handle to the definition, or an invalid handle if the path doesn't exist
+	*/
+	DefinitionHandle VirtualFileSystem::FindDefinition(const std::string_view InPath) const
+	{
+	    if (const auto it = mDefinitionIndex.find(InPath); it != mDefinitionIndex.end())
+	        return DefinitionHandle{it->second};
 	    return {};
 	}
 
+	/**
+	* @brief GetDefinition - Returns a view of the definition a handle refers to
+	*
+	* @param InHandle = Handle from FindDefinition
+	* @return The definition. An empty definition is returned for invalid or stale handles.
+	*/
+	const Definition &VirtualFileSystem::GetDefinition(const DefinitionHandle InHandle) const
+	{
+	    static const Definition EmptyDefinition;
+
+	    if (InHandle.uintIndex >= vctDefinitions.size())
+	        return EmptyDefinition;
+	    return vctDefinitions[InHandle.uintIndex];
+	}
+
+	/**
+	* @brief GetDefinition - Returns the definition of a given path
+	*
+	* @param InPath = The path to get the definition of
+	* @return Copy of the definition of the given path
+	*/
+	Definition VirtualFileSystem::GetDefinition(const std::string &InPath) const
+	{
+	    return GetDefinition(FindDefinition(InPath));
+	}
+
 	/**
 	* @brief GetRegion - Returns the region of a given path
 	*
@@ -496,4 +1469,221 @@ namespace XPLibrary
 	        return it->second;
 	    return {};
 	}
+
+	/**
+	* @brief FindRegion - Looks up a region's ID by name
+	*
+	* @param InName = Region name
+	* @return The ID, or INVALID_REGION if it is unknown
+	*/
+	RegionId VirtualFileSystem::FindRegion(const std::string_view InName) const
+	{
+	    if (const auto it = mRegionIds.find(InName); it != mRegionIds.end())
+	        return it->second;
+	    return INVALID_REGION;
+	}
+
+	/**
+	* @brief GetRegionById - Returns a region by ID
+	*
+	* @param InId = Region ID
+	* @return The region, or an empty region for unknown IDs
+	*/
+	const Region &VirtualFileSystem::GetRegionById(const RegionId InId) const
+	{
+	    static const Region EmptyRegion;
+
+	    if (InId >= vctRegionTable.size())
+	        return EmptyRegion;
+	    return vctRegionTable[InId];
+	}
+
+	/**
+	* @brief GetCompatibleRegions - Finds every region compatible with a point, using the spatial index
+	*
+	* @param InLat = Latitude
+	* @param InLon = Longitude
+	* @param OutMask = Set to the compatible regions
+	*/
+	void VirtualFileSystem::GetCompatibleRegions(const double InLat, const double InLon, RegionMask &OutMask) const
+	{
+	    RegionGrid.GetCompatible(InLat, InLon, OutMask);
+	}
+
+	/**
+	* @brief ResolveRegionalDefinition - Finds the highest priority regional definition whose region is in the mask
+	*
+	* @param InHandle = Definition to resolve
+	* @param InMask = Compatible regions
+	* @return The regional definition, or nullptr if none is compatible
+	*/
+	const RegionalDefinitions *VirtualFileSystem::ResolveRegionalDefinition(const DefinitionHandle InHandle, const RegionMask &InMask) const
+	{
+	    for (const auto &RegionalDef : GetDefinition(InHandle).vctRegionalDefs)
+	    {
+	        if (InMask.Test(RegionalDef.idRegion))
+	            return &RegionalDef;
+	    }
+
+	    return nullptr;
+	}
+
+	/**
+	* @brief GetPath - Resolves a definition to a real path, finding regions through the spatial index
+	*
+	* @param InHandle = Definition to resolve
+	* @param InMask = Compatible regions
+	* @param InLat = The latitude of the object
+	* @param InLon = The longitude of the object
+	* @param InSeason = The season to get this asset for
+	* @return The absolute asset path, or an empty path if no region is compatible
+	*/
+	std::filesystem::path VirtualFileSystem::GetPath(const DefinitionHandle InHandle, const RegionMask &InMask, const double InLat, const double InLon, const char InSeason) const
+	{
+	    if (const RegionalDefinitions *pRegionalDef = ResolveRegionalDefinition(InHandle, InMask))
+	        return pRegionalDef->GetVersion(InSeason, GetDefinition(InHandle).GetPlacementSeed(InLat, InLon)).GetRealPath();
+	    return "";
+	}
+
+	/**
+	* @brief GetPath - Resolves a definition to a real path, finding regions through the spatial index
+	*
+	* @param InHandle = Definition to resolve
+	* @param InLat = The latitude of the object
+	* @param InLon = The longitude of the object
+	* @param InSeason = The season to get this asset for
+	* @return The absolute asset path, or an empty path if no region is compatible
+	*/
+	std::filesystem::path VirtualFileSystem::GetPath(const DefinitionHandle InHandle, const double InLat, const double InLon, const char InSeason) const
+	{
+	    ///< Reused per thread so single lookups don't allocate either
+	    thread_local RegionMask Mask;
+	    GetCompatibleRegions(InLat, InLon, Mask);
+	    return GetPath(InHandle, Mask, InLat, InLon, InSeason);
+	}
+
+	/**
+	* @brief ResolvePlacements - Resolves many placements at once
+	*
+	* @param InDefinitions = Definition of each placement
+	* @param InLat = Latitude of each placement
+	* @param InLon = Longitude of each placement
+	* @param InSeasons = Season of each placement, or empty for SEASON_DEFAULT
+	* @param OutPaths = Resolved real path of each placement, 0 where no region is compatible
+	*/
+	void VirtualFileSystem::ResolvePlacements(const std::span<const DefinitionHandle> InDefinitions, const std::span<const double> InLat, const std::span<const double> InLon,
+	                                          const std::span<const char> InSeasons, const std::span<RealPathId> OutPaths) const
+	{
+	    const size_t uintCount = InDefinitions.size();
+	    if (InLat.size() != uintCount || InLon.size() != uintCount || OutPaths.size() != uintCount || (!InSeasons.empty() && InSeasons.size() != uintCount))
+	        throw std::invalid_argument("ResolvePlacements: array sizes don't match");
+	    if (uintCount == 0)
+	        return;
+
+	    ///< Bucket the placements by grid cell with a counting sort. Off grid points go in an extra bucket at the end.
+	    constexpr size_t BUCKETS = RegionIndex::CELL_COUNT + 1;
+	    std::vector<uint32_t> vctBuckets(uintCount);
+	    std::vector<uint32_t> vctStarts(BUCKETS + 1, 0);
+	    for (size_t i = 0; i < uintCount; i++)
+	    {
+	        const int intCell = RegionIndex::GetCellIndex(InLat[i], InLon[i]);
+	        vctBuckets[i] = intCell == RegionIndex::OFF_GRID ? RegionIndex::CELL_COUNT : static_cast<uint32_t>(intCell);
+	        vctStarts[vctBuckets[i] + 1]++;
+	    }
+	    for (size_t i = 1; i <= BUCKETS; i++)
+	        vctStarts[i] += vctStarts[i - 1];
+
+	    std::vector<uint32_t> vctOrder(uintCount);
+	    {
+	        std::vector<uint32_t> vctNext(vctStarts.begin(), vctStarts.end() - 1);
+	        for (size_t i = 0; i < uintCount; i++)
+	            vctOrder[vctNext[vctBuckets[i]]++] = static_cast<uint32_t>(i);
+	    }
+
+	    ///< Work is split into fixed size chunks of the sorted order. A chunk may span several cells, each run of one cell is tested together.
+	    constexpr size_t CHUNK_SIZE = 4096;
+	    const size_t uintWords = RegionMask::GetWordCount(RegionGrid.GetRegionCount());
+	    const size_t uintChunks = (uintCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+	    ThreadUtils::ParallelFor(uintChunks, [&](const size_t idxChunk) {
+	        std::vector<double> vctLat, vctLon;
+	        std::vector<uint64_t> vctMasks;
+
+	        const size_t idxChunkEnd = std::min(uintCount, (idxChunk + 1) * CHUNK_SIZE);
+	        for (size_t idxRun = idxChunk * CHUNK_SIZE; idxRun < idxChunkEnd;)
+	        {
+	            ///< Find the run of placements in this cell
+	            const uint32_t uintBucket = vctBuckets[vctOrder[idxRun]];
+	            const size_t idxRunEnd = std::min<size_t>(idxChunkEnd, vctStarts[uintBucket + 1]);
+	            const size_t uintRun = idxRunEnd - idxRun;
+
+	            ///< Gather the coordinates so the bounds tests run over contiguous arrays
+	            vctLat.resize(uintRun);
+	            vctLon.resize(uintRun);
+	            for (size_t i = 0; i < uintRun; i++)
+	            {
+	                vctLat[i] = InLat[vctOrder[idxRun + i]];
+	                vctLon[i] = InLon[vctOrder[idxRun + i]];
+	            }
+
+	            vctMasks.resize(uintRun * uintWords);
+	            const int intCell = uintBucket == RegionIndex::CELL_COUNT ? RegionIndex::OFF_GRID : static_cast<int>(uintBucket);
+	            RegionGrid.GetCompatibleInCell(intCell, vctLat, vctLon, uintWords, vctMasks);
+
+	            for (size_t i = 0; i < uintRun; i++)
+	            {
+	                const uint32_t idx = vctOrder[idxRun + i];
+	                const std::span<const uint64_t> Mask(vctMasks.data() + i * uintWords, uintWords);
+
+	                const Definition &Def = GetDefinition(InDefinitions[idx]);
+
+	                OutPaths[idx] = 0;
+	                for (const auto &RegionalDef : Def.vctRegionalDefs)
+	                {
+	                    if (RegionMask::Test(Mask, RegionalDef.idRegion))
+	                    {
+	                        const uint64_t uintSeed = MakePlacementSeed(Def.uintPathHash, InLat[idx], InLon[idx]);
+	                        OutPaths[idx] = RegionalDef.GetVersion(InSeasons.empty() ? SEASON_DEFAULT : InSeasons[idx], uintSeed).GetRealPathId();
+	                        break;
+	                    }
+	                }
+	            }
+
+	            idxRun = idxRunEnd;
+	        }
+	    });
+	}
+
+	/**
+	* @brief GroupPlacementsByAsset - Groups resolved placements by asset
+	*
+	* @param InPaths = Output of VirtualFileSystem::ResolvePlacements
+	* @return The groups, ordered by RealPathId
+	*/
+	PlacementGroups GroupPlacementsByAsset(const std::span<const RealPathId> InPaths)
+	{
+	    std::vector<std::pair<RealPathId, uint32_t>> vctSorted;
+	    vctSorted.reserve(InPaths.size());
+	    for (size_t i = 0; i < InPaths.size(); i++)
+	    {
+	        if (InPaths[i] != 0)
+	            vctSorted.emplace_back(InPaths[i], static_cast<uint32_t>(i));
+	    }
+	    std::ranges::sort(vctSorted);
+
+	    PlacementGroups Groups;
+	    Groups.vctPlacements.reserve(vctSorted.size());
+	    for (const auto &[id, idx] : vctSorted)
+	    {
+	        if (Groups.vctAssets.empty() || Groups.vctAssets.back() != id)
+	        {
+	            Groups.vctAssets.push_back(id);
+	            Groups.vctOffsets.push_back(static_cast<uint32_t>(Groups.vctPlacements.size()));
+	        }
+	        Groups.vctPlacements.push_back(idx);
+	    }
+	    Groups.vctOffsets.push_back(static_cast<uint32_t>(Groups.vctPlacements.size()));
+
+	    return Groups;
+	}
 } // namespace XPLibrary
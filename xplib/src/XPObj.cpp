@@ -2,203 +2,1711 @@
 //Author:	Connor Russell
 //Date:		10/11/2024 7:11:58 PM
 //Purpose:	Implements XPObj.h
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <fstream>
+#include <initializer_list>
 #include <sstream>
+#include <string_view>
+#include <xplib/include/FileUtils.h>
+#include <xplib/include/HashUtils.h>
 #include <xplib/include/TextUtils.h>
 #include <xplib/include/XPObj.h>
+#include <xplib/include/XPObjOptimizer.h>
+#include <xplib/include/XPProfile.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define XPLIB_BOUNDS_SSE2
+#endif
+
+namespace
+{
+    ///< Lines parsed between checks of the stop token
+    constexpr size_t CANCEL_CHECK_LINES = 4096;
+
+    ///< OBJ8 commands the parsers act on
+    enum class ObjCommand
+    {
+        Unknown,
+        AttrDraped,
+        AttrNoDraped,
+        AttrLayerGroup,
+        AttrLayerGroupDraped,
+        AttrLod,
+        Vt,
+        Idx10,
+        Idx,
+        Vline,
+        Vlight,
+        Tris,
+        PointCounts,
+        Texture,
+        TextureNormal,
+        TextureLit,
+        TextureDraped,
+        TextureDrapedNormal
+    };
+
+    constexpr TextUtils::Keyword<ObjCommand> OBJ_KEYWORDS[] = {
+        {"ATTR_draped", ObjCommand::AttrDraped},
+        {"ATTR_no_draped", ObjCommand::AttrNoDraped},
+        {"ATTR_layer_group", ObjCommand::AttrLayerGroup},
+        {"ATTR_layer_group_draped", ObjCommand::AttrLayerGroupDraped},
+        {"ATTR_LOD", ObjCommand::AttrLod},
+        {"VT", ObjCommand::Vt},
+        {"IDX10", ObjCommand::Idx10},
+        {"IDX", ObjCommand::Idx},
+        {"VLINE", ObjCommand::Vline},
+        {"VLIGHT", ObjCommand::Vlight},
+        {"TRIS", ObjCommand::Tris},
+        {"POINT_COUNTS", ObjCommand::PointCounts},
+        {"TEXTURE", ObjCommand::Texture},
+        {"TEXTURE_NORMAL", ObjCommand::TextureNormal},
+        {"TEXTURE_LIT", ObjCommand::TextureLit},
+        {"TEXTURE_DRAPED", ObjCommand::TextureDraped},
+        {"TEXTURE_DRAPED_NORMAL", ObjCommand::TextureDrapedNormal},
+    };
+    constexpr TextUtils::KeywordTable OBJ_COMMANDS(OBJ_KEYWORDS, ObjCommand::Unknown);
+
+    ///< Whitespace as std::istream sees it in the classic locale, so both parse modes split tokens identically
+    constexpr bool IsObjSpace(const char InChar)
+    {
+        return InChar == ' ' || InChar == '\t' || InChar == '\n' || InChar == '\r' || InChar == '\v' || InChar == '\f';
+    }
+
+    /**
+     * @brief Pops the next whitespace delimited token off the front of a line
+     *
+     * @param InOutLine = The remaining line. The token and its leading whitespace are removed from it.
+     * @returns A view of the token, empty if the line is exhausted
+     */
+    std::string_view NextToken(std::string_view &InOutLine)
+    {
+        size_t idxStart = 0;
+        while (idxStart < InOutLine.size() && IsObjSpace(InOutLine[idxStart]))
+            idxStart++;
+
+        size_t idxEnd = idxStart;
+        while (idxEnd < InOutLine.size() && !IsObjSpace(InOutLine[idxEnd]))
+            idxEnd++;
+
+        const std::string_view svToken = InOutLine.substr(idxStart, idxEnd - idxStart);
+        InOutLine.remove_prefix(idxEnd);
+        return svToken;
+    }
+
+    ///< Table lines, the bulk of an obj. ObjReadMode::SkipGeometry doesn't parse them.
+    constexpr bool IsGeometryCommand(const ObjCommand InCommand)
+    {
+        return InCommand == ObjCommand::Vt || InCommand == ObjCommand::Idx10 || InCommand == ObjCommand::Idx || InCommand == ObjCommand::Vline || InCommand == ObjCommand::Vlight;
+    }
+
+    ///< Removes trailing whitespace, the \r of a CRLF line included
+    std::string_view TrimEnd(std::string_view InText)
+    {
+        while (!InText.empty() && IsObjSpace(InText.back()))
+            InText.remove_suffix(1);
+        return InText;
+    }
+
+    /**
+     * @brief Converts a float to a half float, rounding to nearest even. Out of range values become infinity.
+     */
+    uint16_t FloatToHalf(const float InValue)
+    {
+        const uint32_t uintBits = std::bit_cast<uint32_t>(InValue);
+        const auto uintSign = static_cast<uint16_t>((uintBits >> 16) & 0x8000);
+        uint32_t uintAbs = uintBits & 0x7FFFFFFF;
+
+        ///< Inf/NaN, or too large for a half
+        if (uintAbs >= 0x47800000)
+            return uintSign | (uintAbs > 0x7F800000 ? 0x7E00 : 0x7C00);
+
+        ///< Subnormal or zero. Adding 0.5 lines the half's mantissa up with the bottom of the float's, and the FPU does the rounding.
+        if (uintAbs < 0x38800000)
+            return uintSign | static_cast<uint16_t>(std::bit_cast<uint32_t>(std::bit_cast<float>(uintAbs) + 0.5f) - 0x3F000000);
+
+        ///< Normal. Rebias the exponent and round the mantissa to nearest even.
+        const uint32_t uintOdd = (uintAbs >> 13) & 1;
+        uintAbs += 0xC8000FFF + uintOdd;
+        return uintSign | static_cast<uint16_t>(uintAbs >> 13);
+    }
+
+    /**
+     * @brief Converts a half float to a float. Exact.
+     */
+    float HalfToFloat(const uint16_t InValue)
+    {
+        const uint32_t uintSign = static_cast<uint32_t>(InValue & 0x8000) << 16;
+        const uint32_t uintAbs = InValue & 0x7FFF;
+
+        if (uintAbs >= 0x7C00)
+            return std::bit_cast<float>(uintSign | 0x7F800000 | (uintAbs & 0x3FF) << 13);
+        if (uintAbs >= 0x0400)
+            return std::bit_cast<float>(uintSign | ((uintAbs << 13) + 0x38000000));
+        return std::bit_cast<float>(uintSign | std::bit_cast<uint32_t>(static_cast<float>(uintAbs) * 0x1p-24f));
+    }
+
+    ///< -1 for negative values, 1 otherwise (including 0)
+    float SignNotZero(const float InValue) { return InValue < 0 ? -1.0f : 1.0f; }
+
+    int16_t ToSnorm16(const float InValue) { return static_cast<int16_t>(std::lround(std::clamp(InValue, -1.0f, 1.0f) * 32767.0f)); }
+
+    /**
+     * @brief Octahedral encodes a normal into two snorm16s. The normal doesn't need to be unit length. A zero normal encodes as +Z.
+     */
+    std::array<int16_t, 2> OctEncode(const float InX, const float InY, const float InZ)
+    {
+        const float fltL1 = std::abs(InX) + std::abs(InY) + std::abs(InZ);
+        if (!(fltL1 > 0))
+            return {0, 0};
+
+        float fltX = InX / fltL1;
+        float fltY = InY / fltL1;
+
+        ///< Fold the lower hemisphere over the diagonals
+        if (InZ < 0)
+        {
+            const float fltFoldedX = (1.0f - std::abs(fltY)) * SignNotZero(fltX);
+            fltY = (1.0f - std::abs(fltX)) * SignNotZero(fltY);
+            fltX = fltFoldedX;
+        }
+
+        return {ToSnorm16(fltX), ToSnorm16(fltY)};
+    }
+
+    /**
+     * @brief Decodes an octahedral encoded normal back to a unit vector
+     */
+    std::array<float, 3> OctDecode(const int16_t InX, const int16_t InY)
+    {
+        float fltX = std::max(InX / 32767.0f, -1.0f);
+        float fltY = std::max(InY / 32767.0f, -1.0f);
+        const float fltZ = 1.0f - std::abs(fltX) - std::abs(fltY);
+
+        if (fltZ < 0)
+        {
+            const float fltFoldedX = (1.0f - std::abs(fltY)) * SignNotZero(fltX);
+            fltY = (1.0f - std::abs(fltX)) * SignNotZero(fltY);
+            fltX = fltFoldedX;
+        }
+
+        const float fltLength = std::sqrt(fltX * fltX + fltY * fltY + fltZ * fltZ);
+        return {fltX / fltLength, fltY / fltLength, fltZ / fltLength};
+    }
+
+    ///< Size in bytes of one attribute
+    uint32_t GetFormatSize(const XPAsset::ObjAttributeFormat InFormat)
+    {
+        switch (InFormat)
+        {
+        case XPAsset::ObjAttributeFormat::Float3:
+            return 12;
+        case XPAsset::ObjAttributeFormat::Float2:
+            return 8;
+        case XPAsset::ObjAttributeFormat::OctSnorm16x2:
+        case XPAsset::ObjAttributeFormat::Half2:
+            return 4;
+        }
+        return 0;
+    }
+
+    ///< Copies a trivially copyable value out of a byte buffer
+    template <typename T>
+    T ReadAt(const std::vector<std::byte> &InData, const size_t InOffset)
+    {
+        T Value;
+        std::memcpy(&Value, InData.data() + InOffset, sizeof(T));
+        return Value;
+    }
+
+    template <typename T>
+    void WriteAt(std::vector<std::byte> &OutData, const size_t InOffset, const T &InValue)
+    {
+        std::memcpy(OutData.data() + InOffset, &InValue, sizeof(T));
+    }
+
+    /**
+     * @brief Running min/max of vertex positions. With SSE2, which every x86-64 CPU has, X and Y share a register, so a vertex costs one packed and one scalar
+     * min and max. Compilers don't vectorize this on their own, the 64 byte vertex stride defeats them. Elsewhere it's plain min/max.
+     * NaN coordinates are ignored in both versions.
+     */
+    class BoxAccumulator
+    {
+    public:
+#if defined(XPLIB_BOUNDS_SSE2)
+        void Add(const XPAsset::Vertex &InVertex)
+        {
+            static_assert(offsetof(XPAsset::Vertex, Y) == offsetof(XPAsset::Vertex, X) + sizeof(double), "X and Y are loaded together");
+            const __m128d XY = _mm_loadu_pd(&InVertex.X);
+            const __m128d Z = _mm_load_sd(&InVertex.Z);
+
+            ///< minpd/maxpd return the second operand when either is NaN, so the accumulator goes second
+            MinXY = _mm_min_pd(XY, MinXY);
+            MaxXY = _mm_max_pd(XY, MaxXY);
+            MinZ = _mm_min_sd(Z, MinZ);
+            MaxZ = _mm_max_sd(Z, MaxZ);
+        }
+
+        void Get(std::array<double, 3> &OutMin, std::array<double, 3> &OutMax) const
+        {
+            _mm_storeu_pd(OutMin.data(), MinXY);
+            _mm_store_sd(OutMin.data() + 2, MinZ);
+            _mm_storeu_pd(OutMax.data(), MaxXY);
+            _mm_store_sd(OutMax.data() + 2, MaxZ);
+        }
+
+    private:
+        __m128d MinXY{_mm_set1_pd(std::numeric_limits<double>::infinity())};
+        __m128d MinZ{MinXY};
+        __m128d MaxXY{_mm_set1_pd(-std::numeric_limits<double>::infinity())};
+        __m128d MaxZ{MaxXY};
+#else
+        void Add(const XPAsset::Vertex &InVertex)
+        {
+            arrMin = {std::min(arrMin[0], InVertex.X), std::min(arrMin[1], InVertex.Y), std::min(arrMin[2], InVertex.Z)};
+            arrMax = {std::max(arrMax[0], InVertex.X), std::max(arrMax[1], InVertex.Y), std::max(arrMax[2], InVertex.Z)};
+        }
+
+        void Get(std::array<double, 3> &OutMin, std::array<double, 3> &OutMax) const
+        {
+            OutMin = arrMin;
+            OutMax = arrMax;
+        }
+
+    private:
+        std::array<double, 3> arrMin{XPAsset::ObjBounds().arrMin};
+        std::array<double, 3> arrMax{XPAsset::ObjBounds().arrMax};
+#endif
+    };
+
+    /**
+     * @brief Computes the bounds of a set of vertices, in two passes: the box, then the sphere radius around its center
+     *
+     * @param InVertices = Vertices
+     * @param InCount = Number of vertices to include
+     * @param InIndex = Maps 0..InCount-1 to the vertices to include. Indices past the end of InVertices are skipped.
+     * @param OutBounds = Bounds, empty if no vertex was included
+     */
+    template <typename Indexer>
+    void ComputeVertexBounds(const std::vector<XPAsset::Vertex> &InVertices, const size_t InCount, const Indexer &InIndex, XPAsset::ObjBounds &OutBounds)
+    {
+        OutBounds = {};
+
+        BoxAccumulator Box;
+        size_t uintIncluded = 0;
+        for (size_t i = 0; i < InCount; i++)
+        {
+            const size_t idxVertex = InIndex(i);
+            if (idxVertex >= InVertices.size())
+                continue;
+            Box.Add(InVertices[idxVertex]);
+            uintIncluded++;
+        }
+        if (uintIncluded == 0)
+            return;
+
+        Box.Get(OutBounds.arrMin, OutBounds.arrMax);
+        for (int k = 0; k < 3; k++)
+            OutBounds.arrCenter[k] = (OutBounds.arrMin[k] + OutBounds.arrMax[k]) * 0.5;
+
+        ///< The sphere is centered on the box, but its radius is to the farthest vertex, not the corner, which is tighter for most shapes
+        double dblMaxDistSq = 0;
+        for (size_t i = 0; i < InCount; i++)
+        {
+            const size_t idxVertex = InIndex(i);
+            if (idxVertex >= InVertices.size())
+                continue;
+            const XPAsset::Vertex &V = InVertices[idxVertex];
+            const double dblX = V.X - OutBounds.arrCenter[0];
+            const double dblY = V.Y - OutBounds.arrCenter[1];
+            const double dblZ = V.Z - OutBounds.arrCenter[2];
+            dblMaxDistSq = std::max(dblMaxDistSq, dblX * dblX + dblY * dblY + dblZ * dblZ);
+        }
+        OutBounds.dblRadius = std::sqrt(dblMaxDistSq);
+    }
+
+    void WriteBounds(FileUtils::BinaryWriter &InWriter, const XPAsset::ObjBounds &InBounds)
+    {
+        InWriter.Write(InBounds.arrMin);
+        InWriter.Write(InBounds.arrMax);
+        InWriter.Write(InBounds.arrCenter);
+        InWriter.Write(InBounds.dblRadius);
+    }
+
+    bool ReadBounds(FileUtils::BinaryReader &InReader, XPAsset::ObjBounds &OutBounds)
+    {
+        InReader.Read(OutBounds.arrMin);
+        InReader.Read(OutBounds.arrMax);
+        InReader.Read(OutBounds.arrCenter);
+        return InReader.Read(OutBounds.dblRadius);
+    }
+
+    ///< Compiled obj header. Bump the version whenever the layout below changes.
+    constexpr char COMPILED_MAGIC[8] = {'X', 'P', 'O', 'B', 'J', 'B', 'I', 'N'};
+    constexpr uint32_t COMPILED_VERSION = 3;
+
+    /**
+     * @brief Packs the options that change what Load produces, so a compiled file is only used with the options it was written with
+     */
+    uint32_t GetCompiledOptionsKey(const XPAsset::ObjLoadOptions &InOptions)
+    {
+        uint32_t uintKey = static_cast<uint32_t>(InOptions.Storage);
+        if (InOptions.Storage == XPAsset::ObjStorage::Compact)
+            uintKey |= static_cast<uint32_t>(InOptions.Layout) << 2 | static_cast<uint32_t>(InOptions.bQuantizeNormals) << 4 | static_cast<uint32_t>(InOptions.bQuantizeUVs) << 5;
+        uintKey |= static_cast<uint32_t>(InOptions.Lods) << 6 | static_cast<uint32_t>(InOptions.bOptimize) << 16;
+        return uintKey | static_cast<uint32_t>(sizeof(size_t)) << 8;
+    }
+
+    ///< The LOD distance changes what Load produces too, but doesn't fit in the options key
+    double GetCompiledLodDistance(const XPAsset::ObjLoadOptions &InOptions)
+    {
+        return InOptions.Lods == XPAsset::ObjLodSelection::Distance ? InOptions.dblLodDistance : 0.0;
+    }
+
+    /**
+     * @brief Gets a file's size and modification time
+     *
+     * @returns True on success
+     */
+    bool GetSourceStamp(const std::filesystem::path &InPath, uint64_t &OutSize, int64_t &OutModified)
+    {
+        std::error_code ec;
+        OutSize = std::filesystem::file_size(InPath, ec);
+        if (ec)
+            return false;
+        OutModified = std::filesystem::last_write_time(InPath, ec).time_since_epoch().count();
+        return !ec;
+    }
+
+    /**
+     * @brief Hashes a file's contents
+     *
+     * @returns True on success
+     */
+    bool HashSource(const std::filesystem::path &InPath, uint64_t &OutHash)
+    {
+        FileUtils::MappedFile File;
+        if (!File.Open(InPath))
+            return false;
+        OutHash = HashUtils::Fnv1a(File.Data(), File.Size());
+        return true;
+    }
+
+    ///< Vectors of trivially copyable values are written as a count and one block of bytes
+    template <typename T>
+    void WriteBlob(FileUtils::BinaryWriter &InWriter, const std::vector<T> &InValues)
+    {
+        InWriter.Write(static_cast<uint64_t>(InValues.size()));
+        InWriter.WriteBytes(InValues.data(), InValues.size() * sizeof(T));
+    }
+
+    template <typename T>
+    bool ReadBlob(FileUtils::BinaryReader &InReader, std::vector<T> &OutValues)
+    {
+        uint64_t uintCount = 0;
+        if (!InReader.Read(uintCount) || uintCount > InReader.GetRemaining() / sizeof(T))
+            return false;
+        OutValues.resize(uintCount);
+        return InReader.ReadBytes(OutValues.data(), uintCount * sizeof(T));
+    }
+
+    void WriteAttribute(FileUtils::BinaryWriter &InWriter, const XPAsset::ObjVertexAttribute &InAttribute)
+    {
+        InWriter.Write(InAttribute.uintOffset);
+        InWriter.Write(InAttribute.uintStride);
+        InWriter.Write(InAttribute.Format);
+    }
+
+    bool ReadAttribute(FileUtils::BinaryReader &InReader, XPAsset::ObjVertexAttribute &OutAttribute)
+    {
+        InReader.Read(OutAttribute.uintOffset);
+        InReader.Read(OutAttribute.uintStride);
+        return InReader.Read(OutAttribute.Format);
+    }
+
+    /**
+     * @brief Checks that an attribute of every vertex lies inside the vertex data, in a format its decoder reads. An empty mesh keeps the defaults.
+     *
+     * @param InAttribute = Attribute
+     * @param InFormats = Formats the attribute may use
+     * @param InMesh = Mesh it belongs to
+     */
+    bool IsValidAttribute(const XPAsset::ObjVertexAttribute &InAttribute, const std::initializer_list<XPAsset::ObjAttributeFormat> InFormats, const XPAsset::ObjCompactMesh &InMesh)
+    {
+        if (InMesh.uintVertexCount == 0)
+            return true;
+        if (std::ranges::find(InFormats, InAttribute.Format) == InFormats.end())
+            return false;
+
+        const uint64_t uintLast = uint64_t{InAttribute.uintOffset} + uint64_t{InMesh.uintVertexCount - 1} * InAttribute.uintStride;
+        return uintLast + GetFormatSize(InAttribute.Format) <= InMesh.vctVertexData.size();
+    }
+
+    /**
+     * @brief Checks that a loaded compiled object only points at vertices and indices that exist, so the decoders and
+     * anything walking the draw calls can't read out of bounds. The file is ours, but it can be truncated or corrupt.
+     */
+    bool IsValidCompiledMesh(const XPAsset::Obj &InObj)
+    {
+        using enum XPAsset::ObjAttributeFormat;
+        const XPAsset::ObjCompactMesh &Mesh = InObj.CompactMesh;
+        if (Mesh.uintIndexSize != 2 && Mesh.uintIndexSize != 4)
+            return false;
+        if (Mesh.Layout != XPAsset::ObjVertexLayout::Interleaved && Mesh.Layout != XPAsset::ObjVertexLayout::SoA)
+            return false;
+        if (Mesh.vctIndexData.size() != uint64_t{Mesh.uintIndexCount} * Mesh.uintIndexSize)
+            return false;
+        if (!IsValidAttribute(Mesh.Position, {Float3}, Mesh) || !IsValidAttribute(Mesh.Normal, {Float3, OctSnorm16x2}, Mesh) || !IsValidAttribute(Mesh.UV, {Float2, Half2}, Mesh))
+            return false;
+
+        ///< Only one of the two storages holds geometry
+        if (!InObj.Indices.empty() && Mesh.uintIndexCount != 0)
+            return false;
+        for (const size_t idxVertex : InObj.Indices)
+        {
+            if (idxVertex >= InObj.Vertices.size())
+                return false;
+        }
+        for (size_t i = 0; i < Mesh.uintIndexCount; i++)
+        {
+            if (Mesh.GetIndex(i) >= Mesh.uintVertexCount)
+                return false;
+        }
+
+        const size_t uintIndices = InObj.Indices.empty() ? Mesh.uintIndexCount : InObj.Indices.size();
+        return std::ranges::all_of(InObj.DrawCalls, [&](const XPAsset::ObjDrawCall &InCall) { return InCall.idxStart <= InCall.idxEnd && InCall.idxEnd <= uintIndices; });
+    }
+
+    ///< Texture reference: the flag, then the path
+    void WriteTexture(FileUtils::BinaryWriter &InWriter, const bool InHas, const std::filesystem::path &InPath)
+    {
+        InWriter.Write(InHas);
+        InWriter.WritePath(InPath);
+    }
+
+    bool ReadTexture(FileUtils::BinaryReader &InReader, bool &OutHas, std::filesystem::path &OutPath)
+    {
+        InReader.Read(OutHas);
+        return InReader.ReadPath(OutPath);
+    }
+}
+
+/**
+* @brief Build - Builds a compact mesh from double precision geometry
+*
+* @param InVertices = Vertices
+* @param InIndices = Indices
+* @param InOptions = Layout and quantization
+* @return The mesh
+*/
+XPAsset::ObjCompactMesh XPAsset::ObjCompactMesh::Build(const std::vector<Vertex> &InVertices, const std::vector<size_t> &InIndices, const ObjLoadOptions &InOptions)
+{
+    XPLIB_ZONE("ObjCompactMesh::Build");
+
+    ObjCompactMesh Mesh;
+    Mesh.Layout = InOptions.Layout;
+    Mesh.uintVertexCount = static_cast<uint32_t>(InVertices.size());
+    Mesh.uintIndexCount = static_cast<uint32_t>(InIndices.size());
+
+    Mesh.Position.Format = ObjAttributeFormat::Float3;
+    Mesh.Normal.Format = InOptions.bQuantizeNormals ? ObjAttributeFormat::OctSnorm16x2 : ObjAttributeFormat::Float3;
+    Mesh.UV.Format = InOptions.bQuantizeUVs ? ObjAttributeFormat::Half2 : ObjAttributeFormat::Float2;
+
+    const uint32_t uintPositionSize = GetFormatSize(Mesh.Position.Format);
+    const uint32_t uintNormalSize = GetFormatSize(Mesh.Normal.Format);
+    const uint32_t uintUVSize = GetFormatSize(Mesh.UV.Format);
+    const uint32_t uintVertexSize = uintPositionSize + uintNormalSize + uintUVSize;
+
+    ///< Every attribute is a multiple of 4 bytes, so both layouts keep them 4 byte aligned
+    if (Mesh.Layout == ObjVertexLayout::Interleaved)
+    {
+        Mesh.Position = {0, uintVertexSize, Mesh.Position.Format};
+        Mesh.Normal = {uintPositionSize, uintVertexSize, Mesh.Normal.Format};
+        Mesh.UV = {uintPositionSize + uintNormalSize, uintVertexSize, Mesh.UV.Format};
+    }
+    else
+    {
+        Mesh.Position = {0, uintPositionSize, Mesh.Position.Format};
+        Mesh.Normal = {uintPositionSize * Mesh.uintVertexCount, uintNormalSize, Mesh.Normal.Format};
+        Mesh.UV = {(uintPositionSize + uintNormalSize) * Mesh.uintVertexCount, uintUVSize, Mesh.UV.Format};
+    }
+
+    Mesh.vctVertexData.resize(static_cast<size_t>(uintVertexSize) * InVertices.size());
+    for (size_t i = 0; i < InVertices.size(); i++)
+    {
+        const Vertex &V = InVertices[i];
+
+        const std::array<float, 3> Position{static_cast<float>(V.X), static_cast<float>(V.Y), static_cast<float>(V.Z)};
+        WriteAt(Mesh.vctVertexData, Mesh.Position.uintOffset + i * Mesh.Position.uintStride, Position);
+
+        if (InOptions.bQuantizeNormals)
+            WriteAt(Mesh.vctVertexData, Mesh.Normal.uintOffset + i * Mesh.Normal.uintStride, OctEncode(static_cast<float>(V.NX), static_cast<float>(V.NY), static_cast<float>(V.NZ)));
+        else
+            WriteAt(Mesh.vctVertexData, Mesh.Normal.uintOffset + i * Mesh.Normal.uintStride, std::array<float, 3>{static_cast<float>(V.NX), static_cast<float>(V.NY), static_cast<float>(V.NZ)});
+
+        if (InOptions.bQuantizeUVs)
+            WriteAt(Mesh.vctVertexData, Mesh.UV.uintOffset + i * Mesh.UV.uintStride, std::array<uint16_t, 2>{FloatToHalf(static_cast<float>(V.U)), FloatToHalf(static_cast<float>(V.V))});
+        else
+            WriteAt(Mesh.vctVertexData, Mesh.UV.uintOffset + i * Mesh.UV.uintStride, std::array<float, 2>{static_cast<float>(V.U), static_cast<float>(V.V)});
+    }
+
+    ///< 16-bit indices when every index fits. Checked against the indices themselves too, so out of range indices aren't truncated.
+    size_t uintMaxIndex = InVertices.empty() ? 0 : InVertices.size() - 1;
+    for (const size_t idx : InIndices)
+        uintMaxIndex = std::max(uintMaxIndex, idx);
+    Mesh.uintIndexSize = uintMaxIndex <= UINT16_MAX ? 2 : 4;
+
+    Mesh.vctIndexData.resize(InIndices.size() * Mesh.uintIndexSize);
+    for (size_t i = 0; i < InIndices.size(); i++)
+    {
+        if (Mesh.uintIndexSize == 2)
+            WriteAt(Mesh.vctIndexData, i * 2, static_cast<uint16_t>(InIndices[i]));
+        else
+            WriteAt(Mesh.vctIndexData, i * 4, static_cast<uint32_t>(InIndices[i]));
+    }
+
+    return Mesh;
+}
+
+/**
+* @brief GetPosition - Decodes a vertex's position
+*/
+std::array<float, 3> XPAsset::ObjCompactMesh::GetPosition(const size_t InVertex) const
+{
+    return ReadAt<std::array<float, 3>>(vctVertexData, Position.uintOffset + InVertex * Position.uintStride);
+}
+
+/**
+* @brief GetNormal - Decodes a vertex's normal
+*/
+std::array<float, 3> XPAsset::ObjCompactMesh::GetNormal(const size_t InVertex) const
+{
+    const size_t idxByte = Normal.uintOffset + InVertex * Normal.uintStride;
+    if (Normal.Format == ObjAttributeFormat::OctSnorm16x2)
+    {
+        const auto Encoded = ReadAt<std::array<int16_t, 2>>(vctVertexData, idxByte);
+        return OctDecode(Encoded[0], Encoded[1]);
+    }
+    return ReadAt<std::array<float, 3>>(vctVertexData, idxByte);
+}
+
+/**
+* @brief GetUV - Decodes a vertex's UV
+*/
+std::array<float, 2> XPAsset::ObjCompactMesh::GetUV(const size_t InVertex) const
+{
+    const size_t idxByte = UV.uintOffset + InVertex * UV.uintStride;
+    if (UV.Format == ObjAttributeFormat::Half2)
+    {
+        const auto Encoded = ReadAt<std::array<uint16_t, 2>>(vctVertexData, idxByte);
+        return {HalfToFloat(Encoded[0]), HalfToFloat(Encoded[1])};
+    }
+    return ReadAt<std::array<float, 2>>(vctVertexData, idxByte);
+}
+
+/**
+* @brief GetIndex - Reads an index
+*/
+uint32_t XPAsset::ObjCompactMesh::GetIndex(const size_t InIndex) const
+{
+    if (uintIndexSize == 2)
+        return ReadAt<uint16_t>(vctIndexData, InIndex * 2);
+    return ReadAt<uint32_t>(vctIndexData, InIndex * 4);
+}
+
+/**
+* @brief Loads the object
+*
+* @Param InPath = Path to the obj
+* @Param InMode = How to read the file
+* @return True on success, false on failure
+*/
+bool XPAsset::Obj::Load(const std::filesystem::path &InPath, const ObjParseMode InMode)
+{
+    ObjLoadOptions Options;
+    Options.Mode = InMode;
+    return Load(InPath, Options);
+}
+
+/**
+* @brief Loads the object
+*
+* @Param InPath = Path to the obj
+* @Param InOptions = How to read the file, and how to store the geometry
+* @return True on success, false on failure
+*/
+bool XPAsset::Obj::Load(const std::filesystem::path &InPath, const ObjLoadOptions &InOptions)
+{
+    XPLIB_ZONE("Obj::Load");
+    XPLIB_ZONE_TEXT(InPath.string());
+
+    try
+    {
+        ///<make sure the file exists and ends in .obj
+        if (!std::filesystem::exists(InPath) || InPath.extension() == "obj")
+            return false;
+
+        ///< A valid compiled copy skips parsing entirely
+        const std::filesystem::path pCompiled = GetCompiledPath(InPath, InOptions);
+        if (!pCompiled.empty() && LoadCompiled(InPath, pCompiled, InOptions))
+            return true;
+
+        ///< Set the real path
+        pReal = InPath;
+
+        const bool bLoaded = InOptions.Mode == ObjParseMode::Stream ? LoadStream(InPath, InOptions.StopToken) : LoadMapped(InPath, InOptions.StopToken);
+        if (!bLoaded || !SelectLods(InOptions))
+            return false;
+
+        if (InOptions.bOptimize)
+            OptimizeObj(*this);
+
+        ///< While the doubles are still around, compact storage drops them
+        ComputeBounds();
+
+        if (InOptions.Storage == ObjStorage::Compact)
+        {
+            ///< Convert, then free the doubles
+            CompactMesh = ObjCompactMesh::Build(Vertices, Indices, InOptions);
+            std::vector<XPAsset::Vertex>().swap(Vertices);
+            std::vector<size_t>().swap(Indices);
+        }
+
+        ///< Compile it for next time. Failing to isn't an error, we just parse again next time.
+        uint64_t uintHash = 0;
+        if (!pCompiled.empty() && HashSource(InPath, uintHash))
+            SaveCompiled(InPath, pCompiled, InOptions, uintHash);
+
+        return true;
+    }
+    catch (...)
+    {
+        ///< Failure
+        return false;
+    }
+}
+
+/**
+* @brief SelectLods - Drops the draw calls of the LODs not selected, then compacts Vertices and Indices down to what the kept draw calls use.
+* Kept draw calls are renumbered to the compacted indices, in their original order.
+*
+* @Param InOptions = Load options, for the LOD selection
+* @return True on success, false if a kept draw call points outside Indices, or an index outside Vertices
+*/
+bool XPAsset::Obj::SelectLods(const ObjLoadOptions &InOptions)
+{
+    if (InOptions.Lods == ObjLodSelection::All || std::ranges::none_of(DrawCalls, [](const ObjDrawCall &Call) { return Call.intLod >= 0; }))
+        return true;
+
+    XPLIB_ZONE("Obj::SelectLods");
+
+    ///< The least detailed LOD is the one seen from farthest away
+    double dblFarthest = 0;
+    for (const ObjDrawCall &Call : DrawCalls)
+    {
+        if (Call.intLod >= 0)
+            dblFarthest = std::max(dblFarthest, Call.dblLodFar);
+    }
+
+    auto IsSelected = [&](const ObjDrawCall &InCall) {
+        if (InCall.intLod < 0)
+            return true;
+        if (InOptions.Lods == ObjLodSelection::Farthest)
+            return InCall.dblLodFar == dblFarthest;
+        return InCall.dblLodNear <= InOptions.dblLodDistance && InOptions.dblLodDistance < InCall.dblLodFar;
+    };
+
+    ///< Vertices keep the order they're first used in
+    constexpr size_t UNUSED = std::numeric_limits<size_t>::max();
+    std::vector<size_t> vctRemap(Vertices.size(), UNUSED);
+    std::vector<Vertex> vctVertices;
+    std::vector<size_t> vctIndices;
+    std::vector<ObjDrawCall> vctDrawCalls;
+
+    for (const ObjDrawCall &Call : DrawCalls)
+    {
+        if (!IsSelected(Call))
+            continue;
+        if (Call.idxStart > Call.idxEnd || Call.idxEnd > Indices.size())
+            return false;
+
+        ObjDrawCall Kept = Call;
+        Kept.idxStart = vctIndices.size();
+        for (size_t i = Call.idxStart; i < Call.idxEnd; i++)
+        {
+            const size_t idxVertex = Indices[i];
+            if (idxVertex >= Vertices.size())
+                return false;
+
+            if (vctRemap[idxVertex] == UNUSED)
+            {
+                vctRemap[idxVertex] = vctVertices.size();
+                vctVertices.push_back(Vertices[idxVertex]);
+            }
+            vctIndices.push_back(vctRemap[idxVertex]);
+        }
+        Kept.idxEnd = vctIndices.size();
+        vctDrawCalls.push_back(Kept);
+    }
+
+    ///< The new vectors are only as large as they had to grow, trim them so the memory is really given back
+    vctVertices.shrink_to_fit();
+    vctIndices.shrink_to_fit();
+    Vertices = std::move(vctVertices);
+    Indices = std::move(vctIndices);
+    DrawCalls = std::move(vctDrawCalls);
+    return true;
+}
+
+/**
+* @brief ComputeBounds - Recomputes the object's and every draw call's bounds from Vertices and Indices
+*/
+void XPAsset::Obj::ComputeBounds()
+{
+    XPLIB_ZONE("Obj::ComputeBounds");
+
+    ///< Compact objects keep the bounds Load computed before dropping the doubles
+    if (Vertices.empty() && CompactMesh.uintVertexCount != 0)
+        return;
+
+    ComputeVertexBounds(Vertices, Vertices.size(), [](const size_t i) { return i; }, Bounds);
+
+    for (ObjDrawCall &Call : DrawCalls)
+    {
+        const size_t idxStart = std::min(Call.idxStart, Indices.size());
+        const size_t idxEnd = std::clamp(Call.idxEnd, idxStart, Indices.size());
+        ComputeVertexBounds(Vertices, idxEnd - idxStart, [&](const size_t i) { return Indices[idxStart + i]; }, Call.Bounds);
+    }
+}
+
+/**
+* @brief GetMemoryUsage - Estimates the memory used by the object, itself included, in bytes
+*/
+size_t XPAsset::Obj::GetMemoryUsage() const
+{
+    ///< Paths that fit the small string buffer don't allocate, but count them anyway, it's an estimate
+    size_t uintPathBytes = 0;
+    for (const std::filesystem::path *pPath : {&pReal, &pBaseTex, &pNormalTex, &pMaterialTex, &pDrapedBaseTex, &pDrapedNormalTex, &pDrapedMaterialTex})
+        uintPathBytes += pPath->native().capacity() * sizeof(std::filesystem::path::value_type);
+
+    return sizeof(Obj) + Vertices.capacity() * sizeof(Vertex) + Indices.capacity() * sizeof(size_t) + DrawCalls.capacity() * sizeof(ObjDrawCall) + CompactMesh.GetMemoryUsage() + uintPathBytes;
+}
+
+/**
+* @brief GetMemoryStats - Gets the memory the object holds, by category
+*/
+XPAsset::ObjMemoryStats XPAsset::Obj::GetMemoryStats() const
+{
+    ObjMemoryStats MemoryStats;
+    MemoryStats.Objects.AddBytes(1, sizeof(Obj));
+    MemoryStats.Vertices.AddVector(Vertices);
+    MemoryStats.Indices.AddVector(Indices);
+    MemoryStats.DrawCalls.AddVector(DrawCalls);
+
+    MemoryStats.CompactVertices.AddVector(CompactMesh.vctVertexData);
+    MemoryStats.CompactVertices.uintCount = CompactMesh.uintVertexCount;
+    MemoryStats.CompactIndices.AddVector(CompactMesh.vctIndexData);
+    MemoryStats.CompactIndices.uintCount = CompactMesh.uintIndexCount;
+
+    for (const std::filesystem::path *pPath : {&pReal, &pBaseTex, &pNormalTex, &pMaterialTex, &pDrapedBaseTex, &pDrapedNormalTex, &pDrapedMaterialTex})
+        MemoryStats.PathStrings.AddPath(*pPath);
+
+    return MemoryStats;
+}
 
 /**
-* @brief Loads the object
+* @brief GetTotal - Sums every category
+*/
+ProfileUtils::MemoryUsage XPAsset::ObjMemoryStats::GetTotal() const
+{
+    ProfileUtils::MemoryUsage Total;
+    for (const ProfileUtils::MemoryUsage *pUsage : {&Objects, &Vertices, &Indices, &DrawCalls, &CompactVertices, &CompactIndices, &PathStrings})
+        Total += *pUsage;
+    return Total;
+}
+
+/**
+* @brief operator+= - Adds another object's stats, category by category
+*/
+XPAsset::ObjMemoryStats &XPAsset::ObjMemoryStats::operator+=(const ObjMemoryStats &InOther)
+{
+    Objects += InOther.Objects;
+    Vertices += InOther.Vertices;
+    Indices += InOther.Indices;
+    DrawCalls += InOther.DrawCalls;
+    CompactVertices += InOther.CompactVertices;
+    CompactIndices += InOther.CompactIndices;
+    PathStrings += InOther.PathStrings;
+    return *this;
+}
+
+/**
+* @brief GetCompiledPath - Gets where Load keeps the compiled copy of an obj
 *
 * @Param InPath = Path to the obj
+* @Param InOptions = Load options
+* @return The compiled path, empty if compiling is off
+*/
+std::filesystem::path XPAsset::Obj::GetCompiledPath(const std::filesystem::path &InPath, const ObjLoadOptions &InOptions)
+{
+    if (InOptions.CompiledCache == ObjCompiledCache::BesideSource)
+    {
+        std::filesystem::path pCompiled = InPath;
+        pCompiled += ".xpobj";
+        return pCompiled;
+    }
+
+    if (InOptions.CompiledCache == ObjCompiledCache::Directory)
+    {
+        ///< The hash keeps objs with the same name in different packages apart, the name keeps the folder browsable
+        std::error_code ec;
+        std::filesystem::path pCanonical = std::filesystem::weakly_canonical(InPath, ec);
+        if (ec)
+            pCanonical = InPath;
+        const std::u8string strCanonical = pCanonical.generic_u8string();
+        const uint64_t uintHash = HashUtils::Fnv1a(reinterpret_cast<const char *>(strCanonical.data()), strCanonical.size());
+
+        char chrHex[16];
+        for (int i = 0; i < 16; i++)
+            chrHex[i] = "0123456789abcdef"[(uintHash >> (60 - i * 4)) & 0xF];
+
+        std::filesystem::path pName = InPath.stem();
+        pName += "." + std::string(chrHex, sizeof(chrHex)) + ".xpobj";
+        return InOptions.pCompiledCacheDir / pName;
+    }
+
+    return {};
+}
+
+/**
+* @brief SaveCompiled - Writes the object's compiled copy
+*
+* @Param InPath = Path to the obj the object was loaded from
+* @Param InCompiledPath = Compiled file to write
+* @Param InOptions = Options the object was loaded with
+* @Param InSourceHash = Content hash of the obj
 * @return True on success, false on failure
 */
-bool XPAsset::Obj::Load(const std::filesystem::path &InPath)
+bool XPAsset::Obj::SaveCompiled(const std::filesystem::path &InPath, const std::filesystem::path &InCompiledPath, const ObjLoadOptions &InOptions, const uint64_t InSourceHash) const
 {
-    try
+    XPLIB_ZONE("Obj::SaveCompiled");
+
+    uint64_t uintSize = 0;
+    int64_t intModified = 0;
+    if (!GetSourceStamp(InPath, uintSize, intModified))
+        return false;
+
+    FileUtils::BinaryWriter Writer;
+    Writer.WriteBytes(COMPILED_MAGIC, sizeof(COMPILED_MAGIC));
+    Writer.Write(COMPILED_VERSION);
+    Writer.Write(GetCompiledOptionsKey(InOptions));
+    Writer.Write(GetCompiledLodDistance(InOptions));
+    Writer.Write(uintSize);
+    Writer.Write(intModified);
+    Writer.Write(InSourceHash);
+
+    ///< Asset state
+    WriteTexture(Writer, bHasBaseTex, pBaseTex);
+    WriteTexture(Writer, bHasNormalTex, pNormalTex);
+    WriteTexture(Writer, bHasMaterialTex, pMaterialTex);
+    WriteTexture(Writer, bHasDrapedBaseTex, pDrapedBaseTex);
+    WriteTexture(Writer, bHasDrapedNormalTex, pDrapedNormalTex);
+    WriteTexture(Writer, bHasDrapedMaterialTex, pDrapedMaterialTex);
+    Writer.Write(dblNormalScale);
+    Writer.Write(intLayerGroup);
+    Writer.Write(bSuperRoughness);
+    WriteBounds(Writer, Bounds);
+
+    ///< Draw calls field by field, the struct has padding
+    Writer.Write(static_cast<uint64_t>(DrawCalls.size()));
+    for (const ObjDrawCall &Call : DrawCalls)
     {
-        ///<make sure the file exists and ends in .obj
-        if (!std::filesystem::exists(InPath) || InPath.extension() == "obj")
+        Writer.Write(static_cast<uint64_t>(Call.idxStart));
+        Writer.Write(static_cast<uint64_t>(Call.idxEnd));
+        Writer.Write(Call.intLayerGroup);
+        Writer.Write(Call.bDraped);
+        Writer.Write(Call.intLod);
+        Writer.Write(Call.dblLodNear);
+        Writer.Write(Call.dblLodFar);
+        WriteBounds(Writer, Call.Bounds);
+    }
+
+    ///< Geometry blobs
+    WriteBlob(Writer, Vertices);
+    WriteBlob(Writer, Indices);
+    WriteAttribute(Writer, CompactMesh.Position);
+    WriteAttribute(Writer, CompactMesh.Normal);
+    WriteAttribute(Writer, CompactMesh.UV);
+    Writer.Write(CompactMesh.Layout);
+    Writer.Write(CompactMesh.uintVertexCount);
+    Writer.Write(CompactMesh.uintIndexCount);
+    Writer.Write(CompactMesh.uintIndexSize);
+    WriteBlob(Writer, CompactMesh.vctVertexData);
+    WriteBlob(Writer, CompactMesh.vctIndexData);
+
+    return Writer.SaveToFile(InCompiledPath);
+}
+
+/**
+* @brief LoadCompiled - Replaces the object with its compiled copy, if the copy is valid for the obj and options
+*
+* @Param InPath = Path to the obj
+* @Param InCompiledPath = Compiled file
+* @Param InOptions = Load options
+* @return True if the compiled copy was loaded. On false nothing is modified.
+*/
+bool XPAsset::Obj::LoadCompiled(const std::filesystem::path &InPath, const std::filesystem::path &InCompiledPath, const ObjLoadOptions &InOptions)
+{
+    XPLIB_ZONE("Obj::LoadCompiled");
+
+    FileUtils::MappedFile File;
+    if (!File.Open(InCompiledPath))
+        return false;
+
+    FileUtils::BinaryReader Reader(File.View());
+
+    ///< Check the header
+    char chrMagic[sizeof(COMPILED_MAGIC)]{};
+    uint32_t uintVersion = 0;
+    uint32_t uintOptionsKey = 0;
+    double dblLodDistance = 0;
+    uint64_t uintSize = 0;
+    int64_t intModified = 0;
+    uint64_t uintHash = 0;
+    Reader.ReadBytes(chrMagic, sizeof(chrMagic));
+    Reader.Read(uintVersion);
+    Reader.Read(uintOptionsKey);
+    Reader.Read(dblLodDistance);
+    Reader.Read(uintSize);
+    Reader.Read(intModified);
+    Reader.Read(uintHash);
+    if (!Reader.IsGood() || std::memcmp(chrMagic, COMPILED_MAGIC, sizeof(chrMagic)) != 0 || uintVersion != COMPILED_VERSION || uintOptionsKey != GetCompiledOptionsKey(InOptions) ||
+        dblLodDistance != GetCompiledLodDistance(InOptions))
+        return false;
+
+    ///< Check the source. A new modification time with the same contents (a fresh checkout, say) still counts, and gets restamped.
+    uint64_t uintSourceSize = 0;
+    int64_t intSourceModified = 0;
+    if (!GetSourceStamp(InPath, uintSourceSize, intSourceModified) || uintSourceSize != uintSize)
+        return false;
+
+    const bool bRestamp = intSourceModified != intModified;
+    if (bRestamp)
+    {
+        uint64_t uintSourceHash = 0;
+        if (!HashSource(InPath, uintSourceHash) || uintSourceHash != uintHash)
             return false;
+    }
 
-        ///< Set the real path
-        pReal = InPath;
+    ///< Read into a temporary so a truncated file can't leave us half loaded
+    Obj Loaded;
+    Loaded.pReal = InPath;
+    ReadTexture(Reader, Loaded.bHasBaseTex, Loaded.pBaseTex);
+    ReadTexture(Reader, Loaded.bHasNormalTex, Loaded.pNormalTex);
+    ReadTexture(Reader, Loaded.bHasMaterialTex, Loaded.pMaterialTex);
+    ReadTexture(Reader, Loaded.bHasDrapedBaseTex, Loaded.pDrapedBaseTex);
+    ReadTexture(Reader, Loaded.bHasDrapedNormalTex, Loaded.pDrapedNormalTex);
+    ReadTexture(Reader, Loaded.bHasDrapedMaterialTex, Loaded.pDrapedMaterialTex);
+    Reader.Read(Loaded.dblNormalScale);
+    Reader.Read(Loaded.intLayerGroup);
+    Reader.Read(Loaded.bSuperRoughness);
+    ReadBounds(Reader, Loaded.Bounds);
+
+    uint64_t uintDrawCalls = 0;
+    if (!Reader.Read(uintDrawCalls))
+        return false;
+    Loaded.DrawCalls.reserve(std::min<uint64_t>(uintDrawCalls, Reader.GetRemaining()));
+    for (uint64_t i = 0; i < uintDrawCalls && Reader.IsGood(); i++)
+    {
+        uint64_t uintStart = 0;
+        uint64_t uintEnd = 0;
+        ObjDrawCall Call{};
+        Reader.Read(uintStart);
+        Reader.Read(uintEnd);
+        Reader.Read(Call.intLayerGroup);
+        Reader.Read(Call.bDraped);
+        Reader.Read(Call.intLod);
+        Reader.Read(Call.dblLodNear);
+        Reader.Read(Call.dblLodFar);
+        ReadBounds(Reader, Call.Bounds);
+        Call.idxStart = static_cast<size_t>(uintStart);
+        Call.idxEnd = static_cast<size_t>(uintEnd);
+        Loaded.DrawCalls.push_back(Call);
+    }
+
+    ReadBlob(Reader, Loaded.Vertices);
+    ReadBlob(Reader, Loaded.Indices);
+    ReadAttribute(Reader, Loaded.CompactMesh.Position);
+    ReadAttribute(Reader, Loaded.CompactMesh.Normal);
+    ReadAttribute(Reader, Loaded.CompactMesh.UV);
+    Reader.Read(Loaded.CompactMesh.Layout);
+    Reader.Read(Loaded.CompactMesh.uintVertexCount);
+    Reader.Read(Loaded.CompactMesh.uintIndexCount);
+    Reader.Read(Loaded.CompactMesh.uintIndexSize);
+    ReadBlob(Reader, Loaded.CompactMesh.vctVertexData);
+    ReadBlob(Reader, Loaded.CompactMesh.vctIndexData);
+    if (!Reader.IsGood() || Reader.GetRemaining() != 0 || !IsValidCompiledMesh(Loaded))
+        return false;
+
+    ///< Commit, keeping the caller's refcon
+    void *pRefcon = Refcon;
+    *this = std::move(Loaded);
+    Refcon = pRefcon;
+    File.Close();
+
+    if (bRestamp)
+        SaveCompiled(InPath, InCompiledPath, InOptions, uintHash);
+
+    return true;
+}
+
+/**
+* @brief Reads the object through iostreams. Throws on malformed numbers, which Load turns into a failure.
+*
+* @Param InPath = Path to the obj
+* @Param InStop = Gives up and returns false when stop is requested
+* @return True on success, false on failure
+*/
+bool XPAsset::Obj::LoadStream(const std::filesystem::path &InPath, const std::stop_token &InStop)
+{
+    XPLIB_ZONE("Obj::LoadStream");
+
+    ///< Open
+    std::ifstream ObjFile(InPath);
+
+    ///< Make sure it opened
+    if (!ObjFile.is_open())
+        return false;
+
+    ///< Buffers
+    std::string strLine;
+    std::string strCommand;
+    bool bInDraped = false;
+    int intCurrentDrapedLayerGroup = XPLayerGroups::Resolve("objects", 0);
+    ObjDrawCall CurrentLod; ///< Only the LOD fields are used
 
-        ///< Open
-        std::ifstream ObjFile(InPath);
+    size_t uintLines = 0;
 
-        ///< Make sure it opened
-        if (!ObjFile.is_open())
+    ///< Read line by line
+    while (ObjFile.good())
+    {
+        ///< Check for cancellation every so often, it's cheap but not free
+        if ((++uintLines % CANCEL_CHECK_LINES) == 0 && InStop.stop_requested())
             return false;
 
-        ///< Buffers
-        std::string strLine;
-        std::string strCommand;
-        bool bInDraped = false;
-        int intCurrentDrapedLayerGroup = XPLayerGroups::Resolve("objects", 0);
+        ///< Line buffer
+        std::stringstream ssLine;
+
+        ///< Read the line
+        strCommand = "";
+        getline(ObjFile, strLine);
+        ssLine.str(strLine);
+        ObjFile.peek(); ///< Set flags
+
+        ///< Get the command
+        ssLine >> strCommand;
+        const ObjCommand Command = OBJ_COMMANDS.Find(strCommand);
+
+        ///< Draped commands set the draped flags, which determine whether draw calls are saved
+        if (Command == ObjCommand::AttrDraped)
+            bInDraped = true;
+        else if (Command == ObjCommand::AttrNoDraped)
+            bInDraped = false;
 
-        ///< Read line by line
-        while (ObjFile.good())
+        ///< Generic layer group, only applies if we don't have a layer group already
+        else if (Command == ObjCommand::AttrLayerGroup)
         {
-            ///< Line buffer
-            std::stringstream ssLine;
+            ///< Format: ATTR_layer_group group offset
+            std::string strLayerGroupArgs[2];
 
-            ///< Read the line
-            strCommand = "";
-            getline(ObjFile, strLine);
-            ssLine.str(strLine);
-            ObjFile.peek(); ///< Set flags
+            ///< Read the args
+            ssLine >> strLayerGroupArgs[0] >> strLayerGroupArgs[1];
 
-            ///< Get the command
-            ssLine >> strCommand;
+            ///< Set the layer group. An object can only be in a single *non-draped* layer group, and said layer group does not effect draped layer groups, so we can just set it directly.
+            intLayerGroup = XPLayerGroups::Resolve(strLayerGroupArgs[0], stoi(strLayerGroupArgs[1]));
+        }
+
+        ///< Generic layer group, only applies if we don't have a layer group already
+        else if (Command == ObjCommand::AttrLayerGroupDraped)
+        {
+            ///< Format: ATTR_layer_group_draped group offset
+            std::string strLayerGroupArgs[2];
 
-            ///< Draped commands set the draped flags, which determine whether draw calls are saved
-            if (strCommand == "ATTR_draped")
-                bInDraped = true;
-            else if (strCommand == "ATTR_no_draped")
-                bInDraped = false;
+            ///< Read the args
+            ssLine >> strLayerGroupArgs[0] >> strLayerGroupArgs[1];
 
-            ///< Generic layer group, only applies if we don't have a layer group already
-            else if (strCommand == "ATTR_layer_group")
-            {
-                ///< Format: ATTR_layer_group group offset
-                std::string strLayerGroupArgs[2];
+            ///< Set the layer group
+            intCurrentDrapedLayerGroup = XPLayerGroups::Resolve(strLayerGroupArgs[0], stoi(strLayerGroupArgs[1]));
+        }
 
-                ///< Read the args
-                ssLine >> strLayerGroupArgs[0] >> strLayerGroupArgs[1];
+        ///< ATTR_LOD, every draw call after it is in this LOD until the next one
+        else if (Command == ObjCommand::AttrLod)
+        {
+            ///< Format: ATTR_LOD near far
+            std::string strLodArgs[2];
+            ssLine >> strLodArgs[0] >> strLodArgs[1];
 
-                ///< Set the layer group. An object can only be in a single *non-draped* layer group, and said layer group does not effect draped layer groups, so we can just set it directly.
-                intLayerGroup = XPLayerGroups::Resolve(strLayerGroupArgs[0], stoi(strLayerGroupArgs[1]));
-            }
+            CurrentLod.intLod++;
+            CurrentLod.dblLodNear = stod(strLodArgs[0]);
+            CurrentLod.dblLodFar = stod(strLodArgs[1]);
+        }
 
-            ///< Generic layer group, only applies if we don't have a layer group already
-            else if (strCommand == "ATTR_layer_group_draped")
-            {
-                ///< Format: ATTR_layer_group_draped group offset
-                std::string strLayerGroupArgs[2];
+        ///< Vertex, save em all
+        else if (Command == ObjCommand::Vt)
+        {
+            ///< Format: VT X Y Z Nx Ny Nz U V
+            std::string strVertexArgs[8];
 
-                ///< Read the args
-                ssLine >> strLayerGroupArgs[0] >> strLayerGroupArgs[1];
+            ///< Read the args
+            ssLine >> strVertexArgs[0] >> strVertexArgs[1] >> strVertexArgs[2] >> strVertexArgs[3] >> strVertexArgs[4] >> strVertexArgs[5] >> strVertexArgs[6] >> strVertexArgs[7];
 
-                ///< Set the layer group
-                intCurrentDrapedLayerGroup = XPLayerGroups::Resolve(strLayerGroupArgs[0], stoi(strLayerGroupArgs[1]));
-            }
+            ///< Create a vertex. Y is replaced with the current layer group. These don't have normals cuz they're auto calculated by blender
+            XPAsset::Vertex NewVertex;
+            NewVertex.X = stof(strVertexArgs[0]);
+            NewVertex.Y = intCurrentDrapedLayerGroup * 0.1;
+            NewVertex.Z = stof(strVertexArgs[2]);
+            NewVertex.NX = stof(strVertexArgs[3]);
+            NewVertex.NY = stof(strVertexArgs[4]);
+            NewVertex.NZ = stof(strVertexArgs[5]);
+            NewVertex.U = stof(strVertexArgs[6]);
+            NewVertex.V = stof(strVertexArgs[7]);
+
+            ///< Push it back
+            Vertices.push_back(NewVertex);
+        }
+
+        ///< IDX10 we add these 10 indices
+        else if (Command == ObjCommand::Idx10)
+        {
+            ///< Format: IDX10 i1 i2 i3 i4 i5 i6 i7 i8 i9 i10
+            ///< We just push them back into indices vector in order
+            std::string strIndicies[10];
+
+            ///< Read the args
+            ssLine >> strIndicies[0] >> strIndicies[1] >> strIndicies[2] >> strIndicies[3] >> strIndicies[4] >> strIndicies[5] >> strIndicies[6] >> strIndicies[7] >> strIndicies[8] >> strIndicies[9];
 
-            ///< Vertex, save em all
-            else if (strCommand == "VT")
+            ///< Push 'em back
+            for (const auto &strIndicie : strIndicies)
             {
-                ///< Format: VT X Y Z Nx Ny Nz U V
-                std::string strVertexArgs[8];
-
-                ///< Read the args
-                ssLine >> strVertexArgs[0] >> strVertexArgs[1] >> strVertexArgs[2] >> strVertexArgs[3] >> strVertexArgs[4] >> strVertexArgs[5] >> strVertexArgs[6] >> strVertexArgs[7];
-
-                ///< Create a vertex. Y is replaced with the current layer group. These don't have normals cuz they're auto calculated by blender
-                XPAsset::Vertex NewVertex;
-                NewVertex.X = stof(strVertexArgs[0]);
-                NewVertex.Y = intCurrentDrapedLayerGroup * 0.1;
-                NewVertex.Z = stof(strVertexArgs[2]);
-                NewVertex.NX = stof(strVertexArgs[3]);
-                NewVertex.NY = stof(strVertexArgs[4]);
-                NewVertex.NZ = stof(strVertexArgs[5]);
-                NewVertex.U = stof(strVertexArgs[6]);
-                NewVertex.V = stof(strVertexArgs[7]);
-
-                ///< Push it back
-                Vertices.push_back(NewVertex);
+                Indices.push_back(stoi(strIndicie));
             }
+        }
+
+        ///< IDX we save this one index
+        else if (Command == ObjCommand::Idx)
+        {
+            ///< Format: IDX i1
+            ///< Push it back into indices vector
+            std::string strIndex;
+
+            ///< Read the args
+            ssLine >> strIndex;
+
+            ///< Push it back
+            Indices.push_back(stoi(strIndex));
+        }
+
+        ///< TRIS. This saves a draw call if in draped state
+        else if (Command == ObjCommand::Tris)
+        {
+            ///< Format: TRIS Offset Count (ie TRIS 0 6 means indices 0 1 2 3 4 and 5).
+            ///< Indices here are indices in Indices vector, which are indexes to Vertices. The index's position in the vector does not always match its value!!!
+            std::string strDrawCallArgs[2];
+
+            ///< Read the args
+            ssLine >> strDrawCallArgs[0] >> strDrawCallArgs[1];
+
+            ///< Create a new draw call
+            XPAsset::ObjDrawCall NewDrawCall = CurrentLod;
+            NewDrawCall.idxStart = stoi(strDrawCallArgs[0]);
+            NewDrawCall.idxEnd = NewDrawCall.idxStart + stoi(strDrawCallArgs[1]);
+            NewDrawCall.bDraped = bInDraped;
+
+            ///< Save the draw call
+            DrawCalls.push_back(NewDrawCall);
+        }
+
+        ///< TEXTURE_DRAPED
+        else if (Command == ObjCommand::TextureDraped)
+        {
+            ///< Format: TEXTURE_DRAPED Tex
+            std::string strTexPath;
+            ssLine >> strTexPath;
+
+            ///< Set the base texture
+            pDrapedBaseTex = strTexPath;
+            bHasDrapedBaseTex = true;
+        }
+
+        ///< TEXTURE command
+        else if (Command == ObjCommand::Texture)
+        {
+            ///< Format: TEXTURE Tex
+            std::string strTexPath;
+            ssLine >> strTexPath;
+
+            ///< Set the base texture
+            pBaseTex = strTexPath;
+            bHasBaseTex = true;
+        }
+
+        ///< TEXTURE_DRAPED_NORMAL
+        else if (Command == ObjCommand::TextureDrapedNormal)
+        {
+            ///< Format: TEXTURE_DRAPED_NORMAL TileRatio Tex
+            std::string strTexArgs[2];
+            ssLine >> strTexArgs[0] >> strTexArgs[1];
+
+            ///< Set the normal texture
+            pDrapedNormalTex = strTexArgs[1];
+        }
+    }
+
+    ///< Close the file
+    ObjFile.close();
+
+    ///< Success
+    return true;
+}
 
-            ///< IDX10 we add these 10 indices
-            else if (strCommand == "IDX10")
+/**
+* @brief Reads the object from a memory mapping. Walks the file with string_view cursors and parses numbers with std::from_chars,
+* so a line costs no heap allocations. Produces the same results as LoadStream.
+*
+* @Param InPath = Path to the obj
+* @Param InStop = Gives up and returns false when stop is requested
+* @return True on success, false on failure
+*/
+bool XPAsset::Obj::LoadMapped(const std::filesystem::path &InPath, const std::stop_token &InStop)
+{
+    XPLIB_ZONE("Obj::LoadMapped");
+
+    ///< Map the file
+    FileUtils::MappedFile ObjFile;
+    if (!ObjFile.Open(InPath))
+        return false;
+
+    ///< Buffers
+    std::string_view svRemaining = ObjFile.View();
+    bool bInDraped = false;
+    int intCurrentDrapedLayerGroup = XPLayerGroups::Resolve("objects", 0);
+    ObjDrawCall CurrentLod; ///< Only the LOD fields are used
+
+    size_t uintLines = 0;
+
+    ///< Read line by line
+    while (!svRemaining.empty())
+    {
+        ///< Check for cancellation every so often, it's cheap but not free
+        if ((++uintLines % CANCEL_CHECK_LINES) == 0 && InStop.stop_requested())
+            return false;
+
+        ///< Split the line off the front of the file
+        const size_t idxNewline = svRemaining.find('\n');
+        std::string_view svLine = svRemaining.substr(0, idxNewline);
+        svRemaining.remove_prefix(idxNewline == std::string_view::npos ? svRemaining.size() : idxNewline + 1);
+
+        ///< Get the command
+        const ObjCommand Command = OBJ_COMMANDS.Find(NextToken(svLine));
+
+        ///< Draped commands set the draped flags, which determine whether draw calls are saved
+        if (Command == ObjCommand::AttrDraped)
+            bInDraped = true;
+        else if (Command == ObjCommand::AttrNoDraped)
+            bInDraped = false;
+
+        ///< Format: ATTR_layer_group group offset
+        else if (Command == ObjCommand::AttrLayerGroup || Command == ObjCommand::AttrLayerGroupDraped)
+        {
+            const std::string_view svGroup = NextToken(svLine);
+            int intOffset = 0;
+            if (!TextUtils::ParseNumber(NextToken(svLine), intOffset))
+                return false;
+
+            const int intResolved = XPLayerGroups::Resolve(svGroup, intOffset);
+            if (Command == ObjCommand::AttrLayerGroup)
+                intLayerGroup = intResolved;
+            else
+                intCurrentDrapedLayerGroup = intResolved;
+        }
+
+        ///< Format: ATTR_LOD near far
+        else if (Command == ObjCommand::AttrLod)
+        {
+            double dblArgs[2]{};
+            if (!TextUtils::ParseNumber(NextToken(svLine), dblArgs[0]) || !TextUtils::ParseNumber(NextToken(svLine), dblArgs[1]))
+                return false;
+
+            CurrentLod.intLod++;
+            CurrentLod.dblLodNear = dblArgs[0];
+            CurrentLod.dblLodFar = dblArgs[1];
+        }
+
+        ///< Vertex, save em all
+        else if (Command == ObjCommand::Vt)
+        {
+            ///< Format: VT X Y Z Nx Ny Nz U V. Y is replaced with the current layer group, so it isn't parsed.
+            float fltArgs[8]{};
+            for (int i = 0; i < 8; i++)
             {
-                ///< Format: IDX10 i1 i2 i3 i4 i5 i6 i7 i8 i9 i10
-                ///< We just push them back into indices vector in order
-                std::string strIndicies[10];
-
-                ///< Read the args
-                ssLine >> strIndicies[0] >> strIndicies[1] >> strIndicies[2] >> strIndicies[3] >> strIndicies[4] >> strIndicies[5] >> strIndicies[6] >> strIndicies[7] >> strIndicies[8] >> strIndicies[9];
-
-                ///< Push 'em back
-                for (const auto &strIndicie : strIndicies)
-                {
-                    Indices.push_back(stoi(strIndicie));
-                }
+                const std::string_view svArg = NextToken(svLine);
+                if (i != 1 && !TextUtils::ParseNumber(svArg, fltArgs[i]))
+                    return false;
             }
 
-            ///< IDX we save this one index
-            else if (strCommand == "IDX")
+            XPAsset::Vertex NewVertex;
+            NewVertex.X = fltArgs[0];
+            NewVertex.Y = intCurrentDrapedLayerGroup * 0.1;
+            NewVertex.Z = fltArgs[2];
+            NewVertex.NX = fltArgs[3];
+            NewVertex.NY = fltArgs[4];
+            NewVertex.NZ = fltArgs[5];
+            NewVertex.U = fltArgs[6];
+            NewVertex.V = fltArgs[7];
+            Vertices.push_back(NewVertex);
+        }
+
+        ///< IDX10 we add these 10 indices
+        else if (Command == ObjCommand::Idx10)
+        {
+            for (int i = 0; i < 10; i++)
             {
-                ///< Format: IDX i1
-                ///< Push it back into indices vector
-                std::string strIndex;
+                int intIndex = 0;
+                if (!TextUtils::ParseNumber(NextToken(svLine), intIndex))
+                    return false;
+                Indices.push_back(intIndex);
+            }
+        }
+
+        ///< IDX we save this one index
+        else if (Command == ObjCommand::Idx)
+        {
+            int intIndex = 0;
+            if (!TextUtils::ParseNumber(NextToken(svLine), intIndex))
+                return false;
+            Indices.push_back(intIndex);
+        }
 
-                ///< Read the args
-                ssLine >> strIndex;
+        ///< TRIS. This saves a draw call if in draped state
+        else if (Command == ObjCommand::Tris)
+        {
+            int intArgs[2]{};
+            if (!TextUtils::ParseNumber(NextToken(svLine), intArgs[0]) || !TextUtils::ParseNumber(NextToken(svLine), intArgs[1]))
+                return false;
 
-                ///< Push it back
-                Indices.push_back(stoi(strIndex));
-            }
+            ///< Format: TRIS offset count
+            XPAsset::ObjDrawCall NewDrawCall = CurrentLod;
+            NewDrawCall.idxStart = intArgs[0];
+            NewDrawCall.idxEnd = NewDrawCall.idxStart + intArgs[1];
+            NewDrawCall.bDraped = bInDraped;
+            DrawCalls.push_back(NewDrawCall);
+        }
+
+        ///< POINT_COUNTS isn't needed for the data itself, but lets us size the buffers up front
+        else if (Command == ObjCommand::PointCounts)
+        {
+            ///< Format: POINT_COUNTS tris lines lights indices
+            size_t uintCounts[4]{};
+            bool bValid = true;
+            for (auto &Count : uintCounts)
+                bValid = bValid && TextUtils::ParseNumber(NextToken(svLine), Count);
 
-            ///< TRIS. This saves a draw call if in draped state
-            else if (strCommand == "TRIS")
+            ///< Clamp to what the file could possibly hold so a bogus header can't make us throw
+            if (bValid)
             {
-                ///< Format: TRIS StartIndex EndIndex. Inclusive (ie TRIS 0 6 means indices 0 1 2 3 4 5 and 6).
-                ///< Indices here are indices in Indices vector, which are indexes to Vertices. The index's position in the vector does not always match its value!!!
-                std::string strDrawCallArgs[2];
+                Vertices.reserve(Vertices.size() + std::min(uintCounts[0], ObjFile.Size() / 4));
+                Indices.reserve(Indices.size() + std::min(uintCounts[3], ObjFile.Size() / 2));
+            }
+        }
 
-                ///< Read the args
-                ssLine >> strDrawCallArgs[0] >> strDrawCallArgs[1];
+        ///< TEXTURE_DRAPED
+        else if (Command == ObjCommand::TextureDraped)
+        {
+            pDrapedBaseTex = NextToken(svLine);
+            bHasDrapedBaseTex = true;
+        }
 
-                ///< Create a new draw call
-                XPAsset::ObjDrawCall NewDrawCall;
-                NewDrawCall.idxStart = stoi(strDrawCallArgs[0]);
-                NewDrawCall.idxEnd = stoi(strDrawCallArgs[1]);
-                NewDrawCall.bDraped = bInDraped;
+        ///< TEXTURE command
+        else if (Command == ObjCommand::Texture)
+        {
+            pBaseTex = NextToken(svLine);
+            bHasBaseTex = true;
+        }
 
-                ///< Save the draw call
-                DrawCalls.push_back(NewDrawCall);
-            }
+        ///< TEXTURE_DRAPED_NORMAL
+        else if (Command == ObjCommand::TextureDrapedNormal)
+        {
+            ///< Format: TEXTURE_DRAPED_NORMAL TileRatio Tex
+            NextToken(svLine);
+            pDrapedNormalTex = NextToken(svLine);
+        }
+    }
 
-            ///< TEXTURE_DRAPED
-            else if (strCommand == "TEXTURE_DRAPED")
-            {
-                ///< Format: TEXTURE_DRAPED Tex
-                std::string strTexPath;
-                ssLine >> strTexPath;
+    ///< Success
+    return true;
+}
 
-                ///< Set the base texture
-                pDrapedBaseTex = strTexPath;
-                bHasDrapedBaseTex = true;
-            }
+/**
+* @brief Reads an obj, passing each command to a visitor
+*
+* @Param InPath = Path to the obj
+* @Param InVisitor = Receives the commands
+* @Param InMode = How much of the file to read
+* @Param InStop = Gives up and returns false when stop is requested
+* @return True if the file was read or reading was stopped early, false on failure or cancellation
+*/
+bool XPAsset::ReadObj(const std::filesystem::path &InPath, ObjVisitor &InVisitor, const ObjReadMode InMode, const std::stop_token &InStop)
+{
+    XPLIB_ZONE("ReadObj");
+    XPLIB_ZONE_TEXT(InPath.string());
+
+    FileUtils::MappedFile ObjFile;
+    if (!ObjFile.Open(InPath))
+        return false;
+    return ReadObjText(ObjFile.View(), InVisitor, InMode, InStop);
+}
+
+/**
+* @brief Reads obj text, passing each command to a visitor. Tokenizes like LoadMapped, so lines split the same way.
+*
+* @Param InText = Contents of an obj
+* @Param InVisitor = Receives the commands
+* @Param InMode = How much of the text to read
+* @Param InStop = Gives up and returns false when stop is requested
+* @return True if the text was read or reading was stopped early, false on failure or cancellation
+*/
+bool XPAsset::ReadObjText(std::string_view InText, ObjVisitor &InVisitor, const ObjReadMode InMode, const std::stop_token &InStop)
+{
+    bool bSeenPointCounts = false;
+    size_t uintLines = 0;
+
+    while (!InText.empty())
+    {
+        ///< Check for cancellation every so often, it's cheap but not free
+        if ((++uintLines % CANCEL_CHECK_LINES) == 0 && InStop.stop_requested())
+            return false;
+
+        ///< Split the line off the front of the text
+        const size_t idxNewline = InText.find('\n');
+        std::string_view svLine = InText.substr(0, idxNewline);
+        InText.remove_prefix(idxNewline == std::string_view::npos ? InText.size() : idxNewline + 1);
+
+        const std::string_view svCommand = NextToken(svLine);
+        if (svCommand.empty())
+            continue;
+        const ObjCommand Command = OBJ_COMMANDS.Find(svCommand);
+
+        ///< The header ends at the first table line, or the first thing after POINT_COUNTS that isn't a texture
+        if (InMode == ObjReadMode::Probe)
+        {
+            const bool bTexture = Command == ObjCommand::Texture || Command == ObjCommand::TextureNormal || Command == ObjCommand::TextureLit || Command == ObjCommand::TextureDraped ||
+                                  Command == ObjCommand::TextureDrapedNormal;
+            if (IsGeometryCommand(Command) || (bSeenPointCounts && !bTexture))
+                return true;
+        }
+        else if (InMode == ObjReadMode::SkipGeometry && IsGeometryCommand(Command))
+            continue;
+
+        bool bContinue = true;
+        switch (Command)
+        {
+        case ObjCommand::Texture:
+            bContinue = InVisitor.OnTexture(ObjTextureSlot::Base, NextToken(svLine));
+            break;
+        case ObjCommand::TextureNormal:
+            bContinue = InVisitor.OnTexture(ObjTextureSlot::Normal, NextToken(svLine));
+            break;
+        case ObjCommand::TextureLit:
+            bContinue = InVisitor.OnTexture(ObjTextureSlot::Lit, NextToken(svLine));
+            break;
+        case ObjCommand::TextureDraped:
+            bContinue = InVisitor.OnTexture(ObjTextureSlot::DrapedBase, NextToken(svLine));
+            break;
+        case ObjCommand::TextureDrapedNormal:
+            ///< Format: TEXTURE_DRAPED_NORMAL TileRatio Tex
+            NextToken(svLine);
+            bContinue = InVisitor.OnTexture(ObjTextureSlot::DrapedNormal, NextToken(svLine));
+            break;
 
-            ///< TEXTURE command
-            else if (strCommand == "TEXTURE")
+        case ObjCommand::PointCounts:
+        {
+            ///< Format: POINT_COUNTS vertices line_vertices lights indices
+            ObjPointCounts Counts;
+            for (size_t *pCount : {&Counts.uintVertices, &Counts.uintLineVertices, &Counts.uintLights, &Counts.uintIndices})
             {
-                ///< Format: TEXTURE Tex
-                std::string strTexPath;
-                ssLine >> strTexPath;
+                if (!TextUtils::ParseNumber(NextToken(svLine), *pCount))
+                    return false;
+            }
+            bSeenPointCounts = true;
+            bContinue = InVisitor.OnPointCounts(Counts);
+            break;
+        }
 
-                ///< Set the base texture
-                pBaseTex = strTexPath;
-                bHasBaseTex = true;
+        case ObjCommand::Vt:
+        {
+            ///< Format: VT X Y Z Nx Ny Nz U V
+            double dblArgs[8]{};
+            for (double &dblArg : dblArgs)
+            {
+                if (!TextUtils::ParseNumber(NextToken(svLine), dblArg))
+                    return false;
             }
+            bContinue = InVisitor.OnVertex({dblArgs[0], dblArgs[1], dblArgs[2], dblArgs[3], dblArgs[4], dblArgs[5], dblArgs[6], dblArgs[7]});
+            break;
+        }
 
-            ///< TEXTURE_DRAPED_NORMAL
-            else if (strCommand == "TEXTURE_DRAPED_NORMAL")
+        case ObjCommand::Idx10:
+        case ObjCommand::Idx:
+        {
+            size_t uintIndices[10]{};
+            const size_t uintCount = Command == ObjCommand::Idx10 ? 10 : 1;
+            for (size_t i = 0; i < uintCount; i++)
             {
-                ///< Format: TEXTURE_DRAPED_NORMAL TileRatio Tex
-                std::string strTexArgs[2];
-                ssLine >> strTexArgs[0] >> strTexArgs[1];
+                if (!TextUtils::ParseNumber(NextToken(svLine), uintIndices[i]))
+                    return false;
+            }
+            bContinue = InVisitor.OnIndices(std::span<const size_t>(uintIndices, uintCount));
+            break;
+        }
+
+        case ObjCommand::AttrLayerGroup:
+        case ObjCommand::AttrLayerGroupDraped:
+        {
+            ///< Format: ATTR_layer_group group offset
+            const std::string_view svGroup = NextToken(svLine);
+            int intOffset = 0;
+            if (!TextUtils::ParseNumber(NextToken(svLine), intOffset))
+                return false;
+            bContinue = InVisitor.OnLayerGroup(XPLayerGroups::Resolve(svGroup, intOffset), Command == ObjCommand::AttrLayerGroupDraped);
+            break;
+        }
+
+        case ObjCommand::AttrDraped:
+        case ObjCommand::AttrNoDraped:
+            bContinue = InVisitor.OnDraped(Command == ObjCommand::AttrDraped);
+            break;
+
+        case ObjCommand::AttrLod:
+        {
+            ///< Format: ATTR_LOD near far
+            double dblArgs[2]{};
+            if (!TextUtils::ParseNumber(NextToken(svLine), dblArgs[0]) || !TextUtils::ParseNumber(NextToken(svLine), dblArgs[1]))
+                return false;
+            bContinue = InVisitor.OnLod(dblArgs[0], dblArgs[1]);
+            break;
+        }
+
+        case ObjCommand::Tris:
+        {
+            ///< Format: TRIS offset count
+            size_t uintArgs[2]{};
+            if (!TextUtils::ParseNumber(NextToken(svLine), uintArgs[0]) || !TextUtils::ParseNumber(NextToken(svLine), uintArgs[1]))
+                return false;
+            bContinue = InVisitor.OnTris(uintArgs[0], uintArgs[1]);
+            break;
+        }
+
+        ///< VLINE, VLIGHT and everything the parsers don't interpret
+        default:
+        {
+            size_t idxArgs = 0;
+            while (idxArgs < svLine.size() && IsObjSpace(svLine[idxArgs]))
+                idxArgs++;
+            bContinue = InVisitor.OnCommand(svCommand, TrimEnd(svLine.substr(idxArgs)));
+            break;
+        }
+        }
+
+        if (!bContinue)
+            return true;
+    }
+
+    return true;
+}
+
+/**
+* @brief Load - Reads the header of an obj
+*
+* @Param InPath = Path to the obj
+* @Param InMode = Probe for the header only, SkipGeometry to also count draw calls and read layer groups
+* @return True on success, false on failure
+*/
+bool XPAsset::ObjHeader::Load(const std::filesystem::path &InPath, const ObjReadMode InMode)
+{
+    XPLIB_ZONE("ObjHeader::Load");
+
+    ///< Collects into a temporary so a failed read leaves us untouched
+    class HeaderVisitor : public ObjVisitor
+    {
+    public:
+        ObjHeader Header;
+        bool bInDraped{false};
 
-                ///< Set the normal texture
-                pDrapedNormalTex = strTexArgs[1];
+        bool OnTexture(const ObjTextureSlot InSlot, const std::string_view InPath) override
+        {
+            switch (InSlot)
+            {
+            case ObjTextureSlot::Base:
+                Header.pBaseTex = InPath;
+                break;
+            case ObjTextureSlot::Normal:
+                Header.pNormalTex = InPath;
+                break;
+            case ObjTextureSlot::Lit:
+                Header.pLitTex = InPath;
+                break;
+            case ObjTextureSlot::DrapedBase:
+                Header.pDrapedBaseTex = InPath;
+                break;
+            case ObjTextureSlot::DrapedNormal:
+                Header.pDrapedNormalTex = InPath;
+                break;
             }
+            return true;
+        }
+
+        bool OnPointCounts(const ObjPointCounts &InCounts) override
+        {
+            Header.Counts = InCounts;
+            Header.bHasPointCounts = true;
+            return true;
+        }
+
+        bool OnLayerGroup(const int InLayerGroup, const bool InDraped) override
+        {
+            if (InDraped)
+                Header.vctDrapedLayerGroups.push_back(InLayerGroup);
+            else
+                Header.intLayerGroup = InLayerGroup;
+            return true;
+        }
+
+        bool OnDraped(const bool InDraped) override
+        {
+            bInDraped = InDraped;
+            return true;
         }
 
-        ///< Close the file
-        ObjFile.close();
+        bool OnTris(size_t, size_t) override
+        {
+            Header.uintDrawCalls++;
+            if (bInDraped)
+                Header.uintDrapedDrawCalls++;
+            return true;
+        }
+    };
 
-        ///< Success
+    try
+    {
+        HeaderVisitor Visitor;
+        if (!ReadObj(InPath, Visitor, InMode))
+            return false;
+        *this = std::move(Visitor.Header);
         return true;
     }
     catch (...)
@@ -207,4 +1715,3 @@ bool XPAsset::Obj::Load(const std::filesystem::path &InPath)
         return false;
     }
 }
-
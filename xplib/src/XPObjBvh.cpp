@@ -0,0 +1,738 @@
+//Module:	XPObjBvh
+//Author:	Connor Russell
+//Date:		10/16/2026 11:58:21 PM
+//Purpose:	Implements XPObjBvh.h
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <xplib/include/FileUtils.h>
+#include <xplib/include/HashUtils.h>
+#include <xplib/include/XPObjBvh.h>
+#include <xplib/include/XPProfile.h>
+
+namespace
+{
+    using Vec3 = std::array<double, 3>;
+    using XPAsset::ObjBvh;
+    using XPAsset::ObjBvhNode;
+
+    ///< Centroid bins per axis when looking for the best split
+    constexpr int SAH_BINS = 12;
+
+    ///< Leaves never hold more than this, and nodes this small or smaller always become leaves
+    constexpr uint32_t MAX_LEAF_SIZE = 8;
+    constexpr uint32_t MIN_LEAF_SIZE = 2;
+
+    ///< Past this depth nodes split at the median, which bounds the total depth by MEDIAN_DEPTH + log2(triangles)
+    constexpr int MEDIAN_DEPTH = 48;
+
+    ///< Traversal stack. MEDIAN_DEPTH + 32 levels for up to 4 billion triangles, with room to spare.
+    constexpr size_t STACK_SIZE = 128;
+
+    ///< Cost of visiting a node relative to testing a triangle
+    constexpr float TRAVERSAL_COST = 1.0f;
+
+    constexpr char CACHE_MAGIC[8] = {'X', 'P', 'B', 'V', 'H', 'B', 'I', 'N'};
+    constexpr uint32_t CACHE_VERSION = 1;
+
+    static_assert(sizeof(ObjBvhNode) == 32, "Nodes are meant to be 32 bytes");
+    static_assert(sizeof(ObjBvh::Triangle) == 44, "Triangles are hashed and saved as raw bytes, they can't have padding");
+
+    Vec3 Sub(const Vec3 &InA, const Vec3 &InB) { return {InA[0] - InB[0], InA[1] - InB[1], InA[2] - InB[2]}; }
+    double Dot(const Vec3 &InA, const Vec3 &InB) { return InA[0] * InB[0] + InA[1] * InB[1] + InA[2] * InB[2]; }
+    Vec3 Cross(const Vec3 &InA, const Vec3 &InB) { return {InA[1] * InB[2] - InA[2] * InB[1], InA[2] * InB[0] - InA[0] * InB[2], InA[0] * InB[1] - InA[1] * InB[0]}; }
+
+    Vec3 GetCorner(const ObjBvh::Triangle &InTriangle, const int InCorner)
+    {
+        return {InTriangle.arrPositions[InCorner * 3], InTriangle.arrPositions[InCorner * 3 + 1], InTriangle.arrPositions[InCorner * 3 + 2]};
+    }
+
+    /**
+     * @brief Float box, grown point by point
+     */
+    class Box
+    {
+    public:
+        std::array<float, 3> arrMin{std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()};
+        std::array<float, 3> arrMax{-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+
+        void Grow(const float *InPoint)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                arrMin[k] = std::min(arrMin[k], InPoint[k]);
+                arrMax[k] = std::max(arrMax[k], InPoint[k]);
+            }
+        }
+
+        void Grow(const Box &InBox)
+        {
+            Grow(InBox.arrMin.data());
+            Grow(InBox.arrMax.data());
+        }
+
+        [[nodiscard]] float GetArea() const
+        {
+            if (arrMin[0] > arrMax[0])
+                return 0.0f;
+            const float fltX = arrMax[0] - arrMin[0];
+            const float fltY = arrMax[1] - arrMin[1];
+            const float fltZ = arrMax[2] - arrMin[2];
+            return 2.0f * (fltX * fltY + fltY * fltZ + fltZ * fltX);
+        }
+    };
+
+    /**
+     * @brief Builds the nodes depth first, so every left child directly follows its parent
+     */
+    class BvhBuilder
+    {
+    public:
+        BvhBuilder(std::vector<ObjBvh::Triangle> &InOutTriangles, std::vector<ObjBvhNode> &OutNodes) : vctTriangles(InOutTriangles), vctNodes(OutNodes)
+        {
+            vctOrder.resize(vctTriangles.size());
+            vctCentroids.resize(vctTriangles.size());
+            vctBoxes.resize(vctTriangles.size());
+            for (uint32_t i = 0; i < vctTriangles.size(); i++)
+            {
+                vctOrder[i] = i;
+                for (int c = 0; c < 3; c++)
+                    vctBoxes[i].Grow(vctTriangles[i].arrPositions.data() + c * 3);
+                for (int k = 0; k < 3; k++)
+                    vctCentroids[i][k] = (vctBoxes[i].arrMin[k] + vctBoxes[i].arrMax[k]) * 0.5f;
+            }
+        }
+
+        void Run()
+        {
+            vctNodes.clear();
+            vctNodes.reserve(vctTriangles.size() / MIN_LEAF_SIZE * 2 + 1);
+            BuildNode(0, static_cast<uint32_t>(vctTriangles.size()), 0);
+
+            ///< Put the triangles in leaf order
+            std::vector<ObjBvh::Triangle> vctSorted(vctTriangles.size());
+            for (size_t i = 0; i < vctOrder.size(); i++)
+                vctSorted[i] = vctTriangles[vctOrder[i]];
+            vctTriangles = std::move(vctSorted);
+        }
+
+    private:
+        std::vector<ObjBvh::Triangle> &vctTriangles;
+        std::vector<ObjBvhNode> &vctNodes;
+        std::vector<uint32_t> vctOrder;
+        std::vector<std::array<float, 3>> vctCentroids;
+        std::vector<Box> vctBoxes;
+
+        void BuildNode(const uint32_t InBegin, const uint32_t InEnd, const int InDepth)
+        {
+            const uint32_t uintCount = InEnd - InBegin;
+            const size_t idxNode = vctNodes.size();
+            vctNodes.emplace_back();
+
+            Box Bounds;
+            Box Centroids;
+            for (uint32_t i = InBegin; i < InEnd; i++)
+            {
+                Bounds.Grow(vctBoxes[vctOrder[i]]);
+                Centroids.Grow(vctCentroids[vctOrder[i]].data());
+            }
+            vctNodes[idxNode].arrMin = Bounds.arrMin;
+            vctNodes[idxNode].arrMax = Bounds.arrMax;
+
+            auto MakeLeaf = [&]() {
+                vctNodes[idxNode].uintIndex = InBegin;
+                vctNodes[idxNode].uintCount = uintCount;
+            };
+            if (uintCount <= MIN_LEAF_SIZE)
+                return MakeLeaf();
+
+            const uint32_t idxMiddle = InDepth < MEDIAN_DEPTH ? FindSahSplit(InBegin, InEnd, Bounds, Centroids) : InEnd;
+            if (idxMiddle == InBegin)
+                return MakeLeaf();
+
+            ///< No usable SAH split (all centroids in one place, or too deep), but too many triangles for a leaf. Halve at the median of the longest axis.
+            uint32_t idxSplit = idxMiddle;
+            if (idxSplit == InEnd)
+            {
+                int intAxis = 0;
+                for (int k = 1; k < 3; k++)
+                {
+                    if (Centroids.arrMax[k] - Centroids.arrMin[k] > Centroids.arrMax[intAxis] - Centroids.arrMin[intAxis])
+                        intAxis = k;
+                }
+                idxSplit = InBegin + uintCount / 2;
+                std::nth_element(vctOrder.begin() + InBegin, vctOrder.begin() + idxSplit, vctOrder.begin() + InEnd,
+                                 [&](const uint32_t InA, const uint32_t InB) { return vctCentroids[InA][intAxis] < vctCentroids[InB][intAxis]; });
+            }
+
+            BuildNode(InBegin, idxSplit, InDepth + 1);
+            vctNodes[idxNode].uintIndex = static_cast<uint32_t>(vctNodes.size());
+            vctNodes[idxNode].uintCount = 0;
+            BuildNode(idxSplit, InEnd, InDepth + 1);
+        }
+
+        /**
+         * @brief Finds the cheapest split by binning centroids along each axis, and partitions the range by it
+         *
+         * @returns The start of the right half. InBegin if a leaf is cheaper, InEnd if no split exists.
+         */
+        uint32_t FindSahSplit(const uint32_t InBegin, const uint32_t InEnd, const Box &InBounds, const Box &InCentroids)
+        {
+            const uint32_t uintCount = InEnd - InBegin;
+            float fltBestCost = std::numeric_limits<float>::infinity();
+            int intBestAxis = -1;
+            int intBestBin = 0;
+
+            for (int k = 0; k < 3; k++)
+            {
+                const float fltExtent = InCentroids.arrMax[k] - InCentroids.arrMin[k];
+                if (!(fltExtent > 0))
+                    continue;
+
+                std::array<Box, SAH_BINS> arrBins{};
+                std::array<uint32_t, SAH_BINS> arrCounts{};
+                const float fltScale = SAH_BINS / fltExtent;
+                for (uint32_t i = InBegin; i < InEnd; i++)
+                {
+                    const uint32_t idxTriangle = vctOrder[i];
+                    const int intBin = std::min(SAH_BINS - 1, static_cast<int>((vctCentroids[idxTriangle][k] - InCentroids.arrMin[k]) * fltScale));
+                    arrBins[intBin].Grow(vctBoxes[idxTriangle]);
+                    arrCounts[intBin]++;
+                }
+
+                ///< Sweep from the right to get the area and count right of each plane, then from the left to cost them
+                std::array<float, SAH_BINS> arrRightCost{};
+                Box Right;
+                uint32_t uintRight = 0;
+                for (int b = SAH_BINS - 1; b > 0; b--)
+                {
+                    Right.Grow(arrBins[b]);
+                    uintRight += arrCounts[b];
+                    arrRightCost[b - 1] = Right.GetArea() * static_cast<float>(uintRight);
+                }
+
+                Box Left;
+                uint32_t uintLeft = 0;
+                for (int b = 0; b < SAH_BINS - 1; b++)
+                {
+                    Left.Grow(arrBins[b]);
+                    uintLeft += arrCounts[b];
+                    const float fltCost = Left.GetArea() * static_cast<float>(uintLeft) + arrRightCost[b];
+                    if (uintLeft != 0 && uintLeft != uintCount && fltCost < fltBestCost)
+                    {
+                        fltBestCost = fltCost;
+                        intBestAxis = k;
+                        intBestBin = b;
+                    }
+                }
+            }
+
+            if (intBestAxis < 0)
+                return uintCount <= MAX_LEAF_SIZE ? InBegin : InEnd;
+
+            ///< Compare against not splitting, in triangle tests
+            const float fltArea = InBounds.GetArea();
+            const float fltSplitCost = TRAVERSAL_COST + (fltArea > 0 ? fltBestCost / fltArea : static_cast<float>(uintCount));
+            if (fltSplitCost >= static_cast<float>(uintCount) && uintCount <= MAX_LEAF_SIZE)
+                return InBegin;
+
+            const float fltScale = SAH_BINS / (InCentroids.arrMax[intBestAxis] - InCentroids.arrMin[intBestAxis]);
+            const auto itMiddle = std::partition(vctOrder.begin() + InBegin, vctOrder.begin() + InEnd, [&](const uint32_t idxTriangle) {
+                return std::min(SAH_BINS - 1, static_cast<int>((vctCentroids[idxTriangle][intBestAxis] - InCentroids.arrMin[intBestAxis]) * fltScale)) <= intBestBin;
+            });
+            return static_cast<uint32_t>(itMiddle - vctOrder.begin());
+        }
+    };
+
+    /**
+     * @brief Gathers the triangles the draw calls describe, in draw call order
+     */
+    std::vector<ObjBvh::Triangle> GatherTriangles(const XPAsset::Obj &InObj)
+    {
+        const bool bCompact = InObj.Vertices.empty() && InObj.CompactMesh.uintVertexCount != 0;
+        const size_t uintIndices = bCompact ? InObj.CompactMesh.uintIndexCount : InObj.Indices.size();
+        const size_t uintVertices = bCompact ? InObj.CompactMesh.uintVertexCount : InObj.Vertices.size();
+
+        std::vector<ObjBvh::Triangle> vctTriangles;
+        for (size_t idxCall = 0; idxCall < InObj.DrawCalls.size(); idxCall++)
+        {
+            const XPAsset::ObjDrawCall &Call = InObj.DrawCalls[idxCall];
+            const size_t idxEnd = std::min(Call.idxEnd, uintIndices);
+            for (size_t i = Call.idxStart; i + 3 <= idxEnd; i += 3)
+            {
+                ObjBvh::Triangle Triangle{};
+                Triangle.idxIndex = static_cast<uint32_t>(i);
+                Triangle.idxDrawCall = static_cast<uint32_t>(idxCall);
+
+                bool bValid = true;
+                for (int c = 0; c < 3; c++)
+                {
+                    const size_t idxVertex = bCompact ? InObj.CompactMesh.GetIndex(i + c) : InObj.Indices[i + c];
+                    if (idxVertex >= uintVertices)
+                    {
+                        bValid = false;
+                        break;
+                    }
+
+                    if (bCompact)
+                    {
+                        const std::array<float, 3> Position = InObj.CompactMesh.GetPosition(idxVertex);
+                        std::copy(Position.begin(), Position.end(), Triangle.arrPositions.begin() + c * 3);
+                    }
+                    else
+                    {
+                        const XPAsset::Vertex &V = InObj.Vertices[idxVertex];
+                        Triangle.arrPositions[c * 3] = static_cast<float>(V.X);
+                        Triangle.arrPositions[c * 3 + 1] = static_cast<float>(V.Y);
+                        Triangle.arrPositions[c * 3 + 2] = static_cast<float>(V.Z);
+                    }
+                }
+                if (bValid)
+                    vctTriangles.push_back(Triangle);
+            }
+        }
+        return vctTriangles;
+    }
+
+    uint64_t HashTriangles(const std::vector<ObjBvh::Triangle> &InTriangles)
+    {
+        return HashUtils::Fnv1a(reinterpret_cast<const char *>(InTriangles.data()), InTriangles.size() * sizeof(ObjBvh::Triangle));
+    }
+
+    /**
+     * @brief Slab test of a ray against a node's box
+     *
+     * @param OutNear = Distance the ray enters the box at, clamped to 0
+     * @returns True if the ray passes through the box between 0 and InMaxDistance
+     */
+    bool RayHitsBox(const ObjBvhNode &InNode, const Vec3 &InOrigin, const Vec3 &InInverse, const std::array<bool, 3> &InParallel, const double InMaxDistance, double &OutNear)
+    {
+        double dblNear = 0;
+        double dblFar = InMaxDistance;
+        for (int k = 0; k < 3; k++)
+        {
+            ///< A ray parallel to the slab is either always in it or never
+            if (InParallel[k])
+            {
+                if (InOrigin[k] < InNode.arrMin[k] || InOrigin[k] > InNode.arrMax[k])
+                    return false;
+                continue;
+            }
+
+            double dblT0 = (InNode.arrMin[k] - InOrigin[k]) * InInverse[k];
+            double dblT1 = (InNode.arrMax[k] - InOrigin[k]) * InInverse[k];
+            if (dblT0 > dblT1)
+                std::swap(dblT0, dblT1);
+            dblNear = std::max(dblNear, dblT0);
+            dblFar = std::min(dblFar, dblT1);
+            if (dblNear > dblFar)
+                return false;
+        }
+        OutNear = dblNear;
+        return true;
+    }
+
+    /**
+     * @brief Moller-Trumbore ray/triangle test, double sided
+     *
+     * @returns True on a hit between 0 and InMaxDistance
+     */
+    bool RayHitsTriangle(const ObjBvh::Triangle &InTriangle, const Vec3 &InOrigin, const Vec3 &InDirection, const double InMaxDistance, double &OutDistance, double &OutU, double &OutV)
+    {
+        const Vec3 P0 = GetCorner(InTriangle, 0);
+        const Vec3 Edge1 = Sub(GetCorner(InTriangle, 1), P0);
+        const Vec3 Edge2 = Sub(GetCorner(InTriangle, 2), P0);
+
+        const Vec3 P = Cross(InDirection, Edge2);
+        const double dblDet = Dot(Edge1, P);
+        if (dblDet == 0)
+            return false;
+        const double dblInvDet = 1.0 / dblDet;
+
+        const Vec3 T = Sub(InOrigin, P0);
+        const double dblU = Dot(T, P) * dblInvDet;
+        if (dblU < 0 || dblU > 1)
+            return false;
+
+        const Vec3 Q = Cross(T, Edge1);
+        const double dblV = Dot(InDirection, Q) * dblInvDet;
+        if (dblV < 0 || dblU + dblV > 1)
+            return false;
+
+        const double dblT = Dot(Edge2, Q) * dblInvDet;
+        if (dblT < 0 || dblT > InMaxDistance)
+            return false;
+
+        OutDistance = dblT;
+        OutU = dblU;
+        OutV = dblV;
+        return true;
+    }
+
+    /**
+     * @brief Separating axis test of a triangle against a box (Akenine-Moller): the box's axes, the triangle's normal, and the 9 edge cross products
+     */
+    bool TriangleOverlapsBox(const ObjBvh::Triangle &InTriangle, const Vec3 &InCenter, const Vec3 &InHalfSize)
+    {
+        const std::array<Vec3, 3> arrCorners{Sub(GetCorner(InTriangle, 0), InCenter), Sub(GetCorner(InTriangle, 1), InCenter), Sub(GetCorner(InTriangle, 2), InCenter)};
+
+        ///< Is the triangle entirely on one side of the box along the axis
+        auto IsSeparating = [&](const Vec3 &InAxis) {
+            const double dblP0 = Dot(arrCorners[0], InAxis);
+            const double dblP1 = Dot(arrCorners[1], InAxis);
+            const double dblP2 = Dot(arrCorners[2], InAxis);
+            const double dblRadius = InHalfSize[0] * std::abs(InAxis[0]) + InHalfSize[1] * std::abs(InAxis[1]) + InHalfSize[2] * std::abs(InAxis[2]);
+            return std::min({dblP0, dblP1, dblP2}) > dblRadius || std::max({dblP0, dblP1, dblP2}) < -dblRadius;
+        };
+
+        for (int k = 0; k < 3; k++)
+        {
+            Vec3 Axis{0, 0, 0};
+            Axis[k] = 1;
+            if (IsSeparating(Axis))
+                return false;
+        }
+
+        const std::array<Vec3, 3> arrEdges{Sub(arrCorners[1], arrCorners[0]), Sub(arrCorners[2], arrCorners[1]), Sub(arrCorners[0], arrCorners[2])};
+        if (IsSeparating(Cross(arrEdges[0], arrEdges[1])))
+            return false;
+
+        for (const Vec3 &Edge : arrEdges)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                Vec3 Axis{0, 0, 0};
+                Axis[k] = 1;
+                if (IsSeparating(Cross(Axis, Edge)))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    ///< Vectors of trivially copyable values are written as a count and one block of bytes
+    template <typename T>
+    void WriteBlob(FileUtils::BinaryWriter &InWriter, const std::vector<T> &InValues)
+    {
+        InWriter.Write(static_cast<uint64_t>(InValues.size()));
+        InWriter.WriteBytes(InValues.data(), InValues.size() * sizeof(T));
+    }
+
+    template <typename T>
+    bool ReadBlob(FileUtils::BinaryReader &InReader, std::vector<T> &OutValues)
+    {
+        uint64_t uintCount = 0;
+        if (!InReader.Read(uintCount) || uintCount > InReader.GetRemaining() / sizeof(T))
+            return false;
+        OutValues.resize(uintCount);
+        return InReader.ReadBytes(OutValues.data(), uintCount * sizeof(T));
+    }
+
+    /**
+     * @brief Checks that loaded nodes only point at nodes and triangles that exist, and aren't deeper than the traversal stack.
+     * Children always come after their parent, so one pass in order sees every parent before its children. A node with two parents
+     * could hide its depth behind the shallower one, so children are only ever at depth 0 (unreferenced) when their parent is visited.
+     */
+    bool IsValidTree(const std::vector<ObjBvhNode> &InNodes, const size_t InTriangles)
+    {
+        std::vector<uint8_t> vctDepth(InNodes.size(), 0);
+        for (size_t i = 0; i < InNodes.size(); i++)
+        {
+            const ObjBvhNode &Node = InNodes[i];
+            if (Node.IsLeaf())
+            {
+                if (Node.uintIndex > InTriangles || Node.uintCount > InTriangles - Node.uintIndex)
+                    return false;
+                continue;
+            }
+
+            if (i + 1 >= InNodes.size() || Node.uintIndex <= i + 1 || Node.uintIndex >= InNodes.size() || static_cast<size_t>(vctDepth[i]) + 1 >= STACK_SIZE)
+                return false;
+            if (vctDepth[i + 1] != 0 || vctDepth[Node.uintIndex] != 0)
+                return false;
+            vctDepth[i + 1] = vctDepth[Node.uintIndex] = static_cast<uint8_t>(vctDepth[i] + 1);
+        }
+        return true;
+    }
+}
+
+/**
+* @brief Build - Builds the hierarchy over the object's draw call triangles
+*
+* @param InObj = Loaded object
+*/
+void XPAsset::ObjBvh::Build(const Obj &InObj)
+{
+    XPLIB_ZONE("ObjBvh::Build");
+
+    std::vector<Triangle> vctGathered = GatherTriangles(InObj);
+    const uint64_t uintHash = HashTriangles(vctGathered);
+    BuildFromTriangles(std::move(vctGathered), uintHash);
+}
+
+/**
+* @brief BuildCached - Loads the hierarchy from a cache file if it matches the object's triangles, otherwise builds and saves it
+*
+* @param InObj = Loaded object
+* @param InCachePath = Cache file
+* @return True if it came from the cache
+*/
+bool XPAsset::ObjBvh::BuildCached(const Obj &InObj, const std::filesystem::path &InCachePath)
+{
+    XPLIB_ZONE("ObjBvh::BuildCached");
+
+    std::vector<Triangle> vctGathered = GatherTriangles(InObj);
+    const uint64_t uintHash = HashTriangles(vctGathered);
+
+    ObjBvh Cached;
+    if (Cached.Load(InCachePath) && Cached.uintKey == uintHash && Cached.vctTriangles.size() == vctGathered.size())
+    {
+        *this = std::move(Cached);
+        return true;
+    }
+
+    BuildFromTriangles(std::move(vctGathered), uintHash);
+    Save(InCachePath);
+    return false;
+}
+
+/**
+* @brief BuildFromTriangles - Builds the nodes and puts the triangles in leaf order
+*/
+void XPAsset::ObjBvh::BuildFromTriangles(std::vector<Triangle> &&InTriangles, const uint64_t InKey)
+{
+    vctTriangles = std::move(InTriangles);
+    vctNodes.clear();
+    uintKey = InKey;
+    if (vctTriangles.empty())
+        return;
+
+    BvhBuilder Builder(vctTriangles, vctNodes);
+    Builder.Run();
+    vctNodes.shrink_to_fit();
+}
+
+/**
+* @brief Save - Writes the hierarchy to a file
+*
+* @param InPath = File to write
+* @return True on success
+*/
+bool XPAsset::ObjBvh::Save(const std::filesystem::path &InPath) const
+{
+    FileUtils::BinaryWriter Writer;
+    Writer.WriteBytes(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    Writer.Write(CACHE_VERSION);
+    Writer.Write(uintKey);
+    WriteBlob(Writer, vctNodes);
+    WriteBlob(Writer, vctTriangles);
+    return Writer.SaveToFile(InPath);
+}
+
+/**
+* @brief Load - Reads a hierarchy written by Save
+*
+* @param InPath = File to read
+* @return True on success. On false nothing is modified.
+*/
+bool XPAsset::ObjBvh::Load(const std::filesystem::path &InPath)
+{
+    XPLIB_ZONE("ObjBvh::Load");
+
+    FileUtils::MappedFile File;
+    if (!File.Open(InPath))
+        return false;
+
+    FileUtils::BinaryReader Reader(File.View());
+    char chrMagic[sizeof(CACHE_MAGIC)]{};
+    uint32_t uintVersion = 0;
+    ObjBvh Loaded;
+    Reader.ReadBytes(chrMagic, sizeof(chrMagic));
+    Reader.Read(uintVersion);
+    Reader.Read(Loaded.uintKey);
+    if (!Reader.IsGood() || std::memcmp(chrMagic, CACHE_MAGIC, sizeof(chrMagic)) != 0 || uintVersion != CACHE_VERSION)
+        return false;
+
+    if (!ReadBlob(Reader, Loaded.vctNodes) || !ReadBlob(Reader, Loaded.vctTriangles) || Reader.GetRemaining() != 0 || !IsValidTree(Loaded.vctNodes, Loaded.vctTriangles.size()))
+        return false;
+
+    *this = std::move(Loaded);
+    return true;
+}
+
+/**
+* @brief GetCachePath - Gets where BuildCached keeps the hierarchy of an obj
+*/
+std::filesystem::path XPAsset::ObjBvh::GetCachePath(const std::filesystem::path &InObjPath)
+{
+    std::filesystem::path pCache = InObjPath;
+    pCache += ".xpbvh";
+    return pCache;
+}
+
+/**
+* @brief Traverse - Walks the nodes the ray passes through, nearest child first
+*
+* @param InOrigin = Ray origin
+* @param InDirection = Ray direction
+* @param InMaxDistance = Farthest hit to accept
+* @param InAnyHit = Stop at the first hit instead of looking for the nearest
+* @param OutHit = The hit
+* @return True if anything was hit
+*/
+bool XPAsset::ObjBvh::Traverse(const std::array<double, 3> &InOrigin, const std::array<double, 3> &InDirection, double InMaxDistance, const bool InAnyHit, ObjRayHit &OutHit) const
+{
+    if (vctNodes.empty())
+        return false;
+
+    Vec3 Inverse{};
+    std::array<bool, 3> arrParallel{};
+    for (int k = 0; k < 3; k++)
+    {
+        arrParallel[k] = InDirection[k] == 0;
+        Inverse[k] = arrParallel[k] ? 0 : 1.0 / InDirection[k];
+    }
+
+    double dblNear = 0;
+    if (!RayHitsBox(vctNodes[0], InOrigin, Inverse, arrParallel, InMaxDistance, dblNear))
+        return false;
+
+    uint32_t arrStack[STACK_SIZE];
+    size_t uintStack = 0;
+    arrStack[uintStack++] = 0;
+    bool bHit = false;
+
+    while (uintStack > 0)
+    {
+        const ObjBvhNode &Node = vctNodes[arrStack[--uintStack]];
+
+        if (Node.IsLeaf())
+        {
+            for (uint32_t i = Node.uintIndex; i < Node.uintIndex + Node.uintCount; i++)
+            {
+                double dblDistance = 0;
+                double dblU = 0;
+                double dblV = 0;
+                if (!RayHitsTriangle(vctTriangles[i], InOrigin, InDirection, InMaxDistance, dblDistance, dblU, dblV))
+                    continue;
+
+                ///< Later hits have to be nearer
+                InMaxDistance = dblDistance;
+                OutHit.Triangle = {vctTriangles[i].idxIndex, vctTriangles[i].idxDrawCall};
+                OutHit.dblDistance = dblDistance;
+                OutHit.dblU = dblU;
+                OutHit.dblV = dblV;
+                bHit = true;
+                if (InAnyHit)
+                    return true;
+            }
+            continue;
+        }
+
+        ///< Push the farther child first, so the nearer one is visited first and shrinks the search for the other
+        const uint32_t idxLeft = static_cast<uint32_t>(&Node - vctNodes.data()) + 1;
+        const uint32_t idxRight = Node.uintIndex;
+        double dblNearLeft = 0;
+        double dblNearRight = 0;
+        const bool bLeft = RayHitsBox(vctNodes[idxLeft], InOrigin, Inverse, arrParallel, InMaxDistance, dblNearLeft);
+        const bool bRight = RayHitsBox(vctNodes[idxRight], InOrigin, Inverse, arrParallel, InMaxDistance, dblNearRight);
+
+        if (bLeft && bRight)
+        {
+            const bool bLeftFirst = dblNearLeft <= dblNearRight;
+            arrStack[uintStack++] = bLeftFirst ? idxRight : idxLeft;
+            arrStack[uintStack++] = bLeftFirst ? idxLeft : idxRight;
+        }
+        else if (bLeft)
+            arrStack[uintStack++] = idxLeft;
+        else if (bRight)
+            arrStack[uintStack++] = idxRight;
+    }
+
+    return bHit;
+}
+
+/**
+* @brief Raycast - Finds the nearest triangle a ray hits
+*/
+bool XPAsset::ObjBvh::Raycast(const std::array<double, 3> &InOrigin, const std::array<double, 3> &InDirection, const double InMaxDistance, ObjRayHit &OutHit) const
+{
+    return Traverse(InOrigin, InDirection, InMaxDistance, false, OutHit);
+}
+
+/**
+* @brief IntersectSegment - Finds the triangle a segment hits nearest its start
+*/
+bool XPAsset::ObjBvh::IntersectSegment(const std::array<double, 3> &InStart, const std::array<double, 3> &InEnd, ObjRayHit &OutHit) const
+{
+    ///< Cast along the unnormalized segment, so it ends at distance 1, then convert to meters
+    const Vec3 Direction = Sub(InEnd, InStart);
+    if (!Traverse(InStart, Direction, 1.0, false, OutHit))
+        return false;
+    OutHit.dblDistance *= std::sqrt(Dot(Direction, Direction));
+    return true;
+}
+
+/**
+* @brief SegmentHitsAnything - Checks whether a segment hits anything, stopping at the first hit
+*/
+bool XPAsset::ObjBvh::SegmentHitsAnything(const std::array<double, 3> &InStart, const std::array<double, 3> &InEnd) const
+{
+    ObjRayHit Hit;
+    return Traverse(InStart, Sub(InEnd, InStart), 1.0, true, Hit);
+}
+
+/**
+* @brief QueryAabb - Finds the triangles that overlap a box
+*
+* @param InMin = Box minimum
+* @param InMax = Box maximum
+* @param OutTriangles = Appended to
+* @return Number of triangles appended
+*/
+size_t XPAsset::ObjBvh::QueryAabb(const std::array<double, 3> &InMin, const std::array<double, 3> &InMax, std::vector<ObjTriangleRef> &OutTriangles) const
+{
+    if (vctNodes.empty())
+        return 0;
+
+    const Vec3 Center{(InMin[0] + InMax[0]) * 0.5, (InMin[1] + InMax[1]) * 0.5, (InMin[2] + InMax[2]) * 0.5};
+    const Vec3 HalfSize{(InMax[0] - InMin[0]) * 0.5, (InMax[1] - InMin[1]) * 0.5, (InMax[2] - InMin[2]) * 0.5};
+
+    auto Overlaps = [&](const ObjBvhNode &InNode) {
+        for (int k = 0; k < 3; k++)
+        {
+            if (InNode.arrMin[k] > InMax[k] || InNode.arrMax[k] < InMin[k])
+                return false;
+        }
+        return true;
+    };
+
+    const size_t uintBefore = OutTriangles.size();
+    uint32_t arrStack[STACK_SIZE];
+    size_t uintStack = 0;
+    arrStack[uintStack++] = 0;
+
+    while (uintStack > 0)
+    {
+        const uint32_t idxNode = arrStack[--uintStack];
+        const ObjBvhNode &Node = vctNodes[idxNode];
+        if (!Overlaps(Node))
+            continue;
+
+        if (Node.IsLeaf())
+        {
+            for (uint32_t i = Node.uintIndex; i < Node.uintIndex + Node.uintCount; i++)
+            {
+                if (TriangleOverlapsBox(vctTriangles[i], Center, HalfSize))
+                    OutTriangles.push_back({vctTriangles[i].idxIndex, vctTriangles[i].idxDrawCall});
+            }
+            continue;
+        }
+
+        arrStack[uintStack++] = Node.uintIndex;
+        arrStack[uintStack++] = idxNode + 1;
+    }
+
+    return OutTriangles.size() - uintBefore;
+}
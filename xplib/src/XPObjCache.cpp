@@ -0,0 +1,217 @@
+//Module:	XPObjCache
+//Author:	Connor Russell
+//Date:		10/16/2026 7:58:03 PM
+//Purpose:	Implements XPObjCache.h
+#include <algorithm>
+#include <ranges>
+#include <xplib/include/FileUtils.h>
+#include <xplib/include/XPObjCache.h>
+
+/**
+* @brief ObjCache - Creates a cache
+*
+* @param InByteBudget = Memory the cached objects may use, in bytes
+* @param InOptions = How objects are loaded
+*/
+XPAsset::ObjCache::ObjCache(const size_t InByteBudget, const ObjLoadOptions &InOptions) : Options(InOptions), uintBudget(InByteBudget) {}
+
+/**
+* @brief Get - Gets an object, loading it if it isn't cached
+*
+* @param InPath = Path to the obj
+* @param InStop = Abandons the parse when stop is requested
+* @return The object, or nullptr if it couldn't be loaded or was cancelled
+*/
+std::shared_ptr<const XPAsset::Obj> XPAsset::ObjCache::Get(const std::filesystem::path &InPath, const std::stop_token &InStop)
+{
+    ///< Key paths by their canonical form, so different spellings of the same file share an entry
+    std::error_code ec;
+    std::filesystem::path pCanonical = std::filesystem::weakly_canonical(InPath, ec);
+    if (ec)
+        pCanonical = std::filesystem::absolute(InPath, ec).lexically_normal();
+    const std::string strKey = pCanonical.generic_string();
+
+    PathEntry Stamp;
+    Stamp.uintSize = std::filesystem::file_size(pCanonical, ec);
+    if (!ec)
+        Stamp.intModified = std::filesystem::last_write_time(pCanonical, ec).time_since_epoch().count();
+    if (ec)
+    {
+        std::scoped_lock Lock(mtxCache);
+        Stats.uintFailures++;
+        return nullptr;
+    }
+
+    ///< Path hit, as long as the file hasn't changed since
+    {
+        std::scoped_lock Lock(mtxCache);
+        if (const auto itPath = mPaths.find(strKey); itPath != mPaths.end() && itPath->second.uintSize == Stamp.uintSize && itPath->second.intModified == Stamp.intModified)
+        {
+            const auto itContent = mContents.find(itPath->second.Key);
+            if (itContent != mContents.end())
+            {
+                Stats.uintHits++;
+                lstLru.splice(lstLru.begin(), lstLru, itContent->second.itLru);
+                return itContent->second.pObj;
+            }
+        }
+    }
+
+    ///< Hash the contents, a byte-identical file may already be loaded under another path
+    FileUtils::MappedFile File;
+    if (!File.Open(pCanonical))
+    {
+        std::scoped_lock Lock(mtxCache);
+        Stats.uintFailures++;
+        return nullptr;
+    }
+    Stamp.Key = {HashUtils::Fnv1a(File.Data(), File.Size()), File.Size()};
+    File.Close();
+
+    {
+        std::scoped_lock Lock(mtxCache);
+        if (const auto itContent = mContents.find(Stamp.Key); itContent != mContents.end())
+        {
+            Stats.uintContentHits++;
+            auto pObj = itContent->second.pObj;
+            Touch(strKey, Stamp.Key, Stamp);
+            return pObj;
+        }
+    }
+
+    ///< Parse without holding the lock, so other threads can keep hitting the cache
+    ObjLoadOptions LoadOptions = Options;
+    LoadOptions.StopToken = InStop;
+    auto pNew = std::make_shared<Obj>();
+    if (!pNew->Load(pCanonical, LoadOptions))
+    {
+        std::scoped_lock Lock(mtxCache);
+        if (!InStop.stop_requested())
+            Stats.uintFailures++;
+        return nullptr;
+    }
+
+    std::scoped_lock Lock(mtxCache);
+    Stats.uintMisses++;
+
+    ///< Another thread may have loaded the same contents meanwhile, keep theirs so there's only one instance
+    auto itContent = mContents.find(Stamp.Key);
+    if (itContent == mContents.end())
+    {
+        ContentEntry Entry;
+        Entry.uintBytes = pNew->GetMemoryUsage();
+        Entry.pObj = std::move(pNew);
+        lstLru.push_front(Stamp.Key);
+        Entry.itLru = lstLru.begin();
+        Stats.uintResidentBytes += Entry.uintBytes;
+        itContent = mContents.emplace(Stamp.Key, std::move(Entry)).first;
+    }
+
+    auto pObj = itContent->second.pObj;
+    Touch(strKey, Stamp.Key, Stamp);
+    Trim();
+    return pObj;
+}
+
+/**
+* @brief Touch - Records a path as pointing at some contents, and marks them most recently used
+*
+* @param InPath = Canonical path key
+* @param InKey = Contents, must be in mContents
+* @param InStamp = The file's size and modification time
+*/
+void XPAsset::ObjCache::Touch(const std::string &InPath, const ContentKey &InKey, const PathEntry &InStamp)
+{
+    ContentEntry &Entry = mContents.at(InKey);
+
+    auto itPath = mPaths.find(InPath);
+    if (itPath == mPaths.end() || !(itPath->second.Key == InKey))
+    {
+        ///< The file changed, unlink it from its old contents
+        if (itPath != mPaths.end())
+        {
+            if (const auto itOld = mContents.find(itPath->second.Key); itOld != mContents.end())
+                std::erase(itOld->second.vctPaths, InPath);
+        }
+        Entry.vctPaths.push_back(InPath);
+    }
+
+    mPaths.insert_or_assign(InPath, InStamp);
+    lstLru.splice(lstLru.begin(), lstLru, Entry.itLru);
+}
+
+/**
+* @brief Trim - Drops least recently used objects until in budget
+*/
+void XPAsset::ObjCache::Trim()
+{
+    while (Stats.uintResidentBytes > uintBudget && lstLru.size() > 1)
+    {
+        const auto itContent = mContents.find(lstLru.back());
+        for (const std::string &strPath : itContent->second.vctPaths)
+            mPaths.erase(strPath);
+
+        Stats.uintResidentBytes -= itContent->second.uintBytes;
+        Stats.uintEvictions++;
+        mContents.erase(itContent);
+        lstLru.pop_back();
+    }
+}
+
+/**
+* @brief SetByteBudget - Changes the budget, evicting as needed
+*/
+void XPAsset::ObjCache::SetByteBudget(const size_t InByteBudget)
+{
+    std::scoped_lock Lock(mtxCache);
+    uintBudget = InByteBudget;
+    Trim();
+}
+
+size_t XPAsset::ObjCache::GetByteBudget() const
+{
+    std::scoped_lock Lock(mtxCache);
+    return uintBudget;
+}
+
+size_t XPAsset::ObjCache::GetResidentBytes() const
+{
+    std::scoped_lock Lock(mtxCache);
+    return Stats.uintResidentBytes;
+}
+
+/**
+* @brief GetMemoryStats - Gets the memory held by the cached objects, by category
+*/
+XPAsset::ObjMemoryStats XPAsset::ObjCache::GetMemoryStats() const
+{
+    std::scoped_lock Lock(mtxCache);
+    ObjMemoryStats MemoryStats;
+    for (const auto &Entry : mContents | std::views::values)
+        MemoryStats += Entry.pObj->GetMemoryStats();
+    return MemoryStats;
+}
+
+/**
+* @brief GetStats - Gets a snapshot of the counters
+*/
+XPAsset::ObjCacheStats XPAsset::ObjCache::GetStats() const
+{
+    std::scoped_lock Lock(mtxCache);
+    ObjCacheStats Out = Stats;
+    Out.uintObjects = mContents.size();
+    Out.uintPaths = mPaths.size();
+    return Out;
+}
+
+/**
+* @brief Clear - Drops every cached object. Counters are kept.
+*/
+void XPAsset::ObjCache::Clear()
+{
+    std::scoped_lock Lock(mtxCache);
+    mPaths.clear();
+    mContents.clear();
+    lstLru.clear();
+    Stats.uintResidentBytes = 0;
+}
@@ -0,0 +1,232 @@
+//Module:	XPObjLoader
+//Author:	Connor Russell
+//Date:		10/16/2026 8:47:05 PM
+//Purpose:	Implements XPObjLoader.h
+#include <xplib/include/ThreadUtils.h>
+#include <xplib/include/XPObjLoader.h>
+
+/**
+* @brief AsyncObjLoader - Creates a loader that loads each request with Obj::Load
+*
+* @param InOptions = How objects are loaded
+* @param InMaxThreads = Upper bound on the number of worker threads
+*/
+XPAsset::AsyncObjLoader::AsyncObjLoader(const ObjLoadOptions &InOptions, const size_t InMaxThreads) : Options(InOptions)
+{
+    Start(InMaxThreads);
+}
+
+/**
+* @brief AsyncObjLoader - Creates a loader that goes through a cache
+*
+* @param InCache = Cache to load through
+* @param InMaxThreads = Upper bound on the number of worker threads
+*/
+XPAsset::AsyncObjLoader::AsyncObjLoader(ObjCache &InCache, const size_t InMaxThreads) : pCache(&InCache)
+{
+    Start(InMaxThreads);
+}
+
+/**
+* @brief ~AsyncObjLoader - Cancels everything still queued or in flight, and joins the workers
+*/
+XPAsset::AsyncObjLoader::~AsyncObjLoader()
+{
+    {
+        std::scoped_lock Lock(mtxQueue);
+        bStopping = true;
+
+        for (auto &[id, pJob] : mJobs)
+        {
+            if (pJob->bStarted)
+                pJob->Stop.request_stop();
+            else
+                pJob->Promise.set_value({ObjLoadStatus::Cancelled, nullptr});
+        }
+
+        ///< Workers remove their own in flight jobs
+        std::erase_if(mJobs, [](const auto &Pair) { return !Pair.second->bStarted; });
+        setQueue.clear();
+    }
+    cvQueue.notify_all();
+
+    for (auto &t : vctWorkers)
+        t.join();
+}
+
+/**
+* @brief Start - Spins up the workers
+*/
+void XPAsset::AsyncObjLoader::Start(const size_t InMaxThreads)
+{
+    const size_t uintThreads = ThreadUtils::GetWorkerCount(InMaxThreads);
+    vctWorkers.reserve(uintThreads);
+    for (size_t i = 0; i < uintThreads; i++)
+    {
+        ///< If the system won't give us more threads, make do with the ones we have. With none at all nothing would ever load, so that fails.
+        try
+        {
+            vctWorkers.emplace_back(&AsyncObjLoader::WorkerMain, this);
+        }
+        catch (...)
+        {
+            if (vctWorkers.empty())
+                throw;
+            break;
+        }
+    }
+}
+
+/**
+* @brief Load - Queues an object to load
+*
+* @param InPath = Path to the obj
+* @param InPriority = Higher loads first
+* @return The request
+*/
+XPAsset::ObjLoadRequest XPAsset::AsyncObjLoader::Load(const std::filesystem::path &InPath, const int InPriority)
+{
+    auto pJob = std::make_shared<Job>();
+    pJob->pPath = InPath;
+    pJob->intPriority = InPriority;
+
+    ObjLoadRequest Request;
+    Request.Result = pJob->Promise.get_future().share();
+
+    {
+        std::scoped_lock Lock(mtxQueue);
+        Request.uintId = uintNextId++;
+        mJobs.emplace(Request.uintId, std::move(pJob));
+        setQueue.insert({InPriority, Request.uintId});
+    }
+    cvQueue.notify_one();
+
+    return Request;
+}
+
+/**
+* @brief SetPriority - Changes the priority of a queued request
+*
+* @param InId = Request ID
+* @param InPriority = New priority
+* @return True if the request was still queued
+*/
+bool XPAsset::AsyncObjLoader::SetPriority(const uint64_t InId, const int InPriority)
+{
+    std::scoped_lock Lock(mtxQueue);
+
+    const auto itJob = mJobs.find(InId);
+    if (itJob == mJobs.end() || itJob->second->bStarted)
+        return false;
+
+    setQueue.erase({itJob->second->intPriority, InId});
+    itJob->second->intPriority = InPriority;
+    setQueue.insert({InPriority, InId});
+    return true;
+}
+
+/**
+* @brief Cancel - Cancels a request
+*
+* @param InId = Request ID
+* @return True if the request was queued or in flight
+*/
+bool XPAsset::AsyncObjLoader::Cancel(const uint64_t InId)
+{
+    std::scoped_lock Lock(mtxQueue);
+
+    const auto itJob = mJobs.find(InId);
+    if (itJob == mJobs.end())
+        return false;
+
+    ///< In flight, the worker resolves it when the load notices
+    if (itJob->second->bStarted)
+    {
+        itJob->second->Stop.request_stop();
+        return true;
+    }
+
+    setQueue.erase({itJob->second->intPriority, InId});
+    itJob->second->Promise.set_value({ObjLoadStatus::Cancelled, nullptr});
+    mJobs.erase(itJob);
+    return true;
+}
+
+size_t XPAsset::AsyncObjLoader::GetQueuedCount() const
+{
+    std::scoped_lock Lock(mtxQueue);
+    return setQueue.size();
+}
+
+size_t XPAsset::AsyncObjLoader::GetInFlightCount() const
+{
+    std::scoped_lock Lock(mtxQueue);
+    return uintInFlight;
+}
+
+/**
+* @brief LoadOne - Loads one object, through the cache if there is one
+*
+* @param InPath = Path to the obj
+* @param InStop = Stop token for the request
+* @return The object, or nullptr on failure or cancellation
+*/
+std::shared_ptr<const XPAsset::Obj> XPAsset::AsyncObjLoader::LoadOne(const std::filesystem::path &InPath, const std::stop_token &InStop) const
+{
+    if (pCache != nullptr)
+        return pCache->Get(InPath, InStop);
+
+    ObjLoadOptions LoadOptions = Options;
+    LoadOptions.StopToken = InStop;
+    auto pObj = std::make_shared<Obj>();
+    if (!pObj->Load(InPath, LoadOptions))
+        return nullptr;
+    return pObj;
+}
+
+/**
+* @brief WorkerMain - Takes the highest priority request off the queue and loads it, until the loader is destroyed
+*/
+void XPAsset::AsyncObjLoader::WorkerMain()
+{
+    while (true)
+    {
+        uint64_t uintId;
+        std::shared_ptr<Job> pJob;
+        {
+            std::unique_lock Lock(mtxQueue);
+            cvQueue.wait(Lock, [this] { return bStopping || !setQueue.empty(); });
+            if (bStopping)
+                return;
+
+            uintId = setQueue.begin()->uintId;
+            setQueue.erase(setQueue.begin());
+            pJob = mJobs.at(uintId);
+            pJob->bStarted = true;
+            uintInFlight++;
+        }
+
+        ///< Obj::Load swallows its own exceptions, but the cache can still throw on allocation
+        ObjLoadResult Result;
+        try
+        {
+            Result.pObj = LoadOne(pJob->pPath, pJob->Stop.get_token());
+        }
+        catch (...)
+        {
+            Result.pObj = nullptr;
+        }
+
+        if (Result.pObj != nullptr)
+            Result.Status = ObjLoadStatus::Loaded;
+        else
+            Result.Status = pJob->Stop.stop_requested() ? ObjLoadStatus::Cancelled : ObjLoadStatus::Failed;
+
+        {
+            std::scoped_lock Lock(mtxQueue);
+            mJobs.erase(uintId);
+            uintInFlight--;
+        }
+        pJob->Promise.set_value(std::move(Result));
+    }
+}
@@ -0,0 +1,421 @@
+//Module:	XPObjOptimizer
+//Author:	Connor Russell
+//Date:		10/16/2026 11:06:12 PM
+//Purpose:	Implements XPObjOptimizer.h
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <xplib/include/HashUtils.h>
+#include <xplib/include/XPObjOptimizer.h>
+#include <xplib/include/XPProfile.h>
+
+namespace
+{
+    ///< LRU cache size Forsyth's scores are tuned for. Larger than the FIFO ACMR is measured with, which is what the original paper recommends.
+    constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+
+    ///< Valences above this all get the same (tiny) boost
+    constexpr uint32_t FORSYTH_MAX_VALENCE = 64;
+
+    constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+    /**
+     * @brief Forsyth's vertex score tables. The three most recent vertices score the same, so the triangle just drawn isn't favoured over its neighbours,
+     * then the score falls off with cache position. Vertices with few triangles left get a boost, so they're finished off instead of left dangling.
+     */
+    class ForsythScores
+    {
+    public:
+        std::array<float, FORSYTH_CACHE_SIZE> arrCache{};
+        std::array<float, FORSYTH_MAX_VALENCE + 1> arrValence{};
+
+        ForsythScores()
+        {
+            for (uint32_t i = 0; i < FORSYTH_CACHE_SIZE; i++)
+                arrCache[i] = i < 3 ? 0.75f : std::pow(1.0f - static_cast<float>(i - 3) / static_cast<float>(FORSYTH_CACHE_SIZE - 3), 1.5f);
+            for (uint32_t i = 1; i <= FORSYTH_MAX_VALENCE; i++)
+                arrValence[i] = 2.0f / std::sqrt(static_cast<float>(i));
+        }
+
+        ///< InCachePosition is -1 outside the cache. Vertices with nothing left to draw score -1 so they never attract anything.
+        [[nodiscard]] float Get(const int InCachePosition, const uint32_t InRemaining) const
+        {
+            if (InRemaining == 0)
+                return -1.0f;
+            const float fltCache = InCachePosition >= 0 ? arrCache[InCachePosition] : 0.0f;
+            return fltCache + arrValence[std::min(InRemaining, FORSYTH_MAX_VALENCE)];
+        }
+    };
+
+    /**
+     * @brief Reorders the triangles of a triangle list for the post-transform vertex cache, with Tom Forsyth's linear-speed vertex cache optimisation.
+     * Greedily draws the best scoring triangle among those touching the simulated cache, falling back to the next undrawn triangle in input order.
+     *
+     * @param InOutIndices = Triangle list, a whole number of triangles. Reordered in place.
+     * @param InOutLocal = Scratch, one entry per vertex in the object, all NONE. Left all NONE.
+     */
+    void ReorderTriangles(const std::span<size_t> InOutIndices, std::vector<size_t> &InOutLocal)
+    {
+        static const ForsythScores Scores;
+
+        const size_t uintTriangles = InOutIndices.size() / 3;
+        if (uintTriangles < 2)
+            return;
+
+        ///< Number the range's vertices locally, so the work is proportional to the range and not the whole object
+        std::vector<size_t> vctGlobal;
+        std::vector<uint32_t> vctCorners(InOutIndices.size());
+        for (size_t i = 0; i < InOutIndices.size(); i++)
+        {
+            size_t &idxLocal = InOutLocal[InOutIndices[i]];
+            if (idxLocal == NONE)
+            {
+                idxLocal = vctGlobal.size();
+                vctGlobal.push_back(InOutIndices[i]);
+            }
+            vctCorners[i] = static_cast<uint32_t>(idxLocal);
+        }
+        for (const size_t idxVertex : vctGlobal)
+            InOutLocal[idxVertex] = NONE;
+
+        ///< Each vertex's undrawn triangles, packed. The first uintRemaining entries of a vertex's run are the undrawn ones.
+        const size_t uintVertices = vctGlobal.size();
+        std::vector<uint32_t> vctRemaining(uintVertices, 0);
+        for (const uint32_t idxVertex : vctCorners)
+            vctRemaining[idxVertex]++;
+
+        std::vector<uint32_t> vctFirstTriangle(uintVertices + 1, 0);
+        for (size_t i = 0; i < uintVertices; i++)
+            vctFirstTriangle[i + 1] = vctFirstTriangle[i] + vctRemaining[i];
+
+        std::vector<uint32_t> vctTriangles(vctCorners.size());
+        {
+            std::vector<uint32_t> vctFill(vctFirstTriangle.begin(), vctFirstTriangle.end() - 1);
+            for (size_t i = 0; i < vctCorners.size(); i++)
+                vctTriangles[vctFill[vctCorners[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        std::vector<int> vctCachePosition(uintVertices, -1);
+        std::vector<float> vctVertexScore(uintVertices);
+        for (size_t i = 0; i < uintVertices; i++)
+            vctVertexScore[i] = Scores.Get(-1, vctRemaining[i]);
+
+        ///< Triangle scores are only needed in full to pick the first one, after that only the cached vertices' triangles are rescored
+        std::vector<float> vctTriangleScore(uintTriangles);
+        std::vector<bool> vctDrawn(uintTriangles, false);
+        for (size_t t = 0; t < uintTriangles; t++)
+            vctTriangleScore[t] = vctVertexScore[vctCorners[t * 3]] + vctVertexScore[vctCorners[t * 3 + 1]] + vctVertexScore[vctCorners[t * 3 + 2]];
+
+        ///< Simulated LRU cache, with room for the three vertices pushed in before the oldest are evicted
+        std::vector<uint32_t> vctCache;
+        std::vector<uint32_t> vctNextCache;
+        vctCache.reserve(FORSYTH_CACHE_SIZE + 3);
+        vctNextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+        std::vector<uint32_t> vctOrder;
+        vctOrder.reserve(uintTriangles);
+
+        size_t idxBest = static_cast<size_t>(std::ranges::max_element(vctTriangleScore) - vctTriangleScore.begin());
+        size_t idxNextInOrder = 0;
+
+        while (vctOrder.size() < uintTriangles)
+        {
+            ///< Nothing in the cache touches an undrawn triangle, start again from the next one in input order
+            if (idxBest == NONE)
+            {
+                while (vctDrawn[idxNextInOrder])
+                    idxNextInOrder++;
+                idxBest = idxNextInOrder;
+            }
+
+            ///< Draw it, and take it off its vertices' lists
+            vctDrawn[idxBest] = true;
+            vctOrder.push_back(static_cast<uint32_t>(idxBest));
+            for (int c = 0; c < 3; c++)
+            {
+                const uint32_t idxVertex = vctCorners[idxBest * 3 + c];
+                uint32_t *pBegin = vctTriangles.data() + vctFirstTriangle[idxVertex];
+                uint32_t *pEnd = pBegin + vctRemaining[idxVertex];
+                std::iter_swap(std::find(pBegin, pEnd, static_cast<uint32_t>(idxBest)), pEnd - 1);
+                vctRemaining[idxVertex]--;
+            }
+
+            ///< Its vertices move to the front of the cache
+            vctNextCache.clear();
+            for (int c = 0; c < 3; c++)
+            {
+                const uint32_t idxVertex = vctCorners[idxBest * 3 + c];
+                if (std::ranges::find(vctNextCache, idxVertex) == vctNextCache.end())
+                    vctNextCache.push_back(idxVertex);
+            }
+            for (const uint32_t idxVertex : vctCache)
+            {
+                if (std::ranges::find(vctNextCache, idxVertex) == vctNextCache.end())
+                    vctNextCache.push_back(idxVertex);
+            }
+
+            ///< Rescore everything that was or is in the cache. Entries past the cache size were just evicted.
+            for (size_t i = 0; i < vctNextCache.size(); i++)
+            {
+                const uint32_t idxVertex = vctNextCache[i];
+                vctCachePosition[idxVertex] = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+                vctVertexScore[idxVertex] = Scores.Get(vctCachePosition[idxVertex], vctRemaining[idxVertex]);
+            }
+
+            ///< The next triangle is the best one touching the cache
+            idxBest = NONE;
+            float fltBestScore = -std::numeric_limits<float>::infinity();
+            for (const uint32_t idxVertex : vctNextCache)
+            {
+                for (uint32_t i = 0; i < vctRemaining[idxVertex]; i++)
+                {
+                    const uint32_t idxTriangle = vctTriangles[vctFirstTriangle[idxVertex] + i];
+                    const float fltScore = vctVertexScore[vctCorners[idxTriangle * 3]] + vctVertexScore[vctCorners[idxTriangle * 3 + 1]] + vctVertexScore[vctCorners[idxTriangle * 3 + 2]];
+                    if (fltScore > fltBestScore)
+                    {
+                        fltBestScore = fltScore;
+                        idxBest = idxTriangle;
+                    }
+                }
+            }
+
+            vctNextCache.resize(std::min<size_t>(vctNextCache.size(), FORSYTH_CACHE_SIZE));
+            std::swap(vctCache, vctNextCache);
+        }
+
+        ///< Write the triangles back in the new order
+        for (size_t t = 0; t < uintTriangles; t++)
+        {
+            const uint32_t idxTriangle = vctOrder[t];
+            for (int c = 0; c < 3; c++)
+                InOutIndices[t * 3 + c] = vctGlobal[vctCorners[idxTriangle * 3 + c]];
+        }
+    }
+
+    /**
+     * @brief Counts FIFO cache misses over a triangle list. A vertex is cached if fewer than InCacheSize misses happened since its own.
+     *
+     * @param InIndices = Triangle list
+     * @param InCacheSize = Cache entries
+     * @param InOutStamps = Miss count at each vertex's last miss, one entry per vertex
+     * @param InOutClock = Running miss count. Bump it by InCacheSize to empty the cache.
+     * @returns Misses
+     */
+    size_t CountCacheMisses(const std::span<const size_t> InIndices, const uint32_t InCacheSize, std::vector<size_t> &InOutStamps, size_t &InOutClock)
+    {
+        size_t uintMisses = 0;
+        for (size_t i = 0; i < InIndices.size() / 3 * 3; i++)
+        {
+            size_t &uintStamp = InOutStamps[InIndices[i]];
+            if (uintStamp == NONE || InOutClock - uintStamp >= InCacheSize)
+            {
+                uintStamp = InOutClock++;
+                uintMisses++;
+            }
+        }
+        return uintMisses;
+    }
+
+    ///< A draw call's index range
+    class IndexRange
+    {
+    public:
+        size_t idxStart;
+        size_t idxEnd;
+        bool bReorder{true}; //False when reordering it would change the triangles of another range
+
+        auto operator<=>(const IndexRange &InOther) const { return std::pair(idxStart, idxEnd) <=> std::pair(InOther.idxStart, InOther.idxEnd); }
+        bool operator==(const IndexRange &InOther) const { return idxStart == InOther.idxStart && idxEnd == InOther.idxEnd; }
+    };
+
+    /**
+     * @brief Collects the distinct index ranges of the draw calls, dropping ranges outside Indices or with a partial triangle
+     */
+    std::vector<IndexRange> GetTriangleRanges(const XPAsset::Obj &InObj)
+    {
+        std::vector<IndexRange> vctRanges;
+        for (const XPAsset::ObjDrawCall &Call : InObj.DrawCalls)
+        {
+            if (Call.idxStart < Call.idxEnd && Call.idxEnd <= InObj.Indices.size() && (Call.idxEnd - Call.idxStart) % 3 == 0)
+                vctRanges.push_back({Call.idxStart, Call.idxEnd});
+        }
+        std::ranges::sort(vctRanges);
+        vctRanges.erase(std::unique(vctRanges.begin(), vctRanges.end()), vctRanges.end());
+
+        ///< Reordering a range only keeps the triangles of the ranges that contain it on a triangle boundary. Any other overlap, nested or not, would
+        ///< change the triangles of one of the two. Each pair is visited from its earlier range, stopping at the first range that starts after it ends.
+        for (size_t i = 0; i < vctRanges.size(); i++)
+        {
+            IndexRange &Outer = vctRanges[i];
+            for (size_t j = i + 1; j < vctRanges.size() && vctRanges[j].idxStart < Outer.idxEnd; j++)
+            {
+                IndexRange &Inner = vctRanges[j];
+                if (Inner.idxStart == Outer.idxStart)
+                    Inner.bReorder = false; //Sorted, so this one is longer and contains Outer
+                else if (Inner.idxEnd <= Outer.idxEnd && (Inner.idxStart - Outer.idxStart) % 3 == 0)
+                    Outer.bReorder = false;
+                else
+                    Inner.bReorder = Outer.bReorder = false;
+            }
+        }
+        return vctRanges;
+    }
+
+    ///< ACMR over every range, with the cache emptied between draw calls
+    double MeasureAcmr(const XPAsset::Obj &InObj, const std::vector<IndexRange> &InRanges, const uint32_t InCacheSize)
+    {
+        std::vector<size_t> vctStamps(InObj.Vertices.size(), NONE);
+        size_t uintClock = 0;
+        size_t uintMisses = 0;
+        size_t uintTriangles = 0;
+        for (const IndexRange &Range : InRanges)
+        {
+            uintMisses += CountCacheMisses(std::span<const size_t>(InObj.Indices).subspan(Range.idxStart, Range.idxEnd - Range.idxStart), InCacheSize, vctStamps, uintClock);
+            uintTriangles += (Range.idxEnd - Range.idxStart) / 3;
+            uintClock += InCacheSize;
+        }
+        return uintTriangles == 0 ? 0.0 : static_cast<double>(uintMisses) / static_cast<double>(uintTriangles);
+    }
+
+    ///< Vertices compare and hash by their bits, so only exact duplicates merge
+    static_assert(sizeof(XPAsset::Vertex) == 8 * sizeof(double), "Vertex must have no padding to compare by its bytes");
+
+    uint64_t HashBits(const XPAsset::Vertex &InVertex)
+    {
+        uint64_t uintWords[8];
+        std::memcpy(uintWords, &InVertex, sizeof(uintWords));
+
+        uint64_t uintHash = HashUtils::FNV_OFFSET;
+        for (const uint64_t uintWord : uintWords)
+            uintHash = HashUtils::Mix64(uintHash ^ uintWord);
+        return uintHash;
+    }
+
+    /**
+     * @brief Renumbers the vertices. Vertices mapped to the same new index must be identical.
+     *
+     * @param InOutObj = Object
+     * @param InRemap = New index of each old vertex
+     * @param InNewCount = Vertex count afterwards
+     */
+    void RemapVertices(XPAsset::Obj &InOutObj, const std::vector<size_t> &InRemap, const size_t InNewCount)
+    {
+        std::vector<XPAsset::Vertex> vctVertices(InNewCount);
+        for (size_t i = 0; i < InRemap.size(); i++)
+            vctVertices[InRemap[i]] = InOutObj.Vertices[i];
+        InOutObj.Vertices = std::move(vctVertices);
+
+        for (size_t &idxVertex : InOutObj.Indices)
+            idxVertex = InRemap[idxVertex];
+    }
+}
+
+/**
+* @brief GetAcmr - Simulates a FIFO post-transform vertex cache over a triangle list
+*
+* @param InIndices = Triangle list
+* @param InCacheSize = Cache entries
+* @return Cache misses per triangle
+*/
+double XPAsset::GetAcmr(const std::span<const size_t> InIndices, const uint32_t InCacheSize)
+{
+    const size_t uintTriangles = InIndices.size() / 3;
+    if (uintTriangles == 0)
+        return 0.0;
+
+    std::vector<size_t> vctStamps(*std::max_element(InIndices.begin(), InIndices.begin() + uintTriangles * 3) + 1, NONE);
+    size_t uintClock = 0;
+    return static_cast<double>(CountCacheMisses(InIndices, InCacheSize, vctStamps, uintClock)) / static_cast<double>(uintTriangles);
+}
+
+/**
+* @brief OptimizeObj - Merges duplicate vertices, reorders each draw call's triangles for the vertex cache, then renumbers vertices in fetch order
+*
+* @param InOutObj = Loaded object
+* @param InOptions = Steps to run
+* @return What changed
+*/
+XPAsset::ObjOptimizeStats XPAsset::OptimizeObj(Obj &InOutObj, const ObjOptimizeOptions &InOptions)
+{
+    XPLIB_ZONE("OptimizeObj");
+
+    ObjOptimizeStats Stats;
+    Stats.uintVerticesBefore = Stats.uintVerticesAfter = InOutObj.Vertices.size();
+
+    ///< Indices pointing past the vertices would make every step read out of bounds. Such an object is broken anyway, leave it be.
+    if (std::ranges::any_of(InOutObj.Indices, [&](const size_t idx) { return idx >= InOutObj.Vertices.size(); }))
+        return Stats;
+
+    const std::vector<IndexRange> vctRanges = GetTriangleRanges(InOutObj);
+    for (const IndexRange &Range : vctRanges)
+        Stats.uintTriangles += (Range.idxEnd - Range.idxStart) / 3;
+    Stats.dblAcmrBefore = MeasureAcmr(InOutObj, vctRanges, InOptions.uintCacheSize);
+
+    ///< Duplicates first, so triangles that only differed by which copy they used now share vertices in the cache
+    if (InOptions.bMergeDuplicates)
+    {
+        ///< Open addressing over vertex numbers, at most half full. A std::unordered_map would cost an allocation per vertex.
+        const size_t uintVertices = InOutObj.Vertices.size();
+        const size_t uintMask = std::bit_ceil(uintVertices * 2 + 1) - 1;
+        std::vector<size_t> vctSlots(uintMask + 1, NONE);
+
+        ///< Survivors keep their relative order, duplicates take the number of the first copy
+        std::vector<size_t> vctRemap(uintVertices);
+        size_t uintUnique = 0;
+        for (size_t i = 0; i < uintVertices; i++)
+        {
+            const XPAsset::Vertex &V = InOutObj.Vertices[i];
+            size_t idxSlot = HashBits(V) & uintMask;
+            while (vctSlots[idxSlot] != NONE && std::memcmp(&InOutObj.Vertices[vctSlots[idxSlot]], &V, sizeof(V)) != 0)
+                idxSlot = (idxSlot + 1) & uintMask;
+
+            if (vctSlots[idxSlot] == NONE)
+            {
+                vctSlots[idxSlot] = i;
+                vctRemap[i] = uintUnique++;
+            }
+            else
+                vctRemap[i] = vctRemap[vctSlots[idxSlot]];
+        }
+
+        if (uintUnique != uintVertices)
+            RemapVertices(InOutObj, vctRemap, uintUnique);
+    }
+
+    if (InOptions.bReorderTriangles)
+    {
+        std::vector<size_t> vctLocal(InOutObj.Vertices.size(), NONE);
+        for (const IndexRange &Range : vctRanges)
+        {
+            if (Range.bReorder)
+                ReorderTriangles(std::span<size_t>(InOutObj.Indices).subspan(Range.idxStart, Range.idxEnd - Range.idxStart), vctLocal);
+        }
+    }
+
+    ///< First use order over the whole index buffer. Vertices nothing uses keep their relative order, at the end.
+    if (InOptions.bReorderVertices)
+    {
+        std::vector<size_t> vctRemap(InOutObj.Vertices.size(), NONE);
+        size_t uintNext = 0;
+        for (const size_t idxVertex : InOutObj.Indices)
+        {
+            if (vctRemap[idxVertex] == NONE)
+                vctRemap[idxVertex] = uintNext++;
+        }
+        for (size_t &idxNew : vctRemap)
+        {
+            if (idxNew == NONE)
+                idxNew = uintNext++;
+        }
+        RemapVertices(InOutObj, vctRemap, InOutObj.Vertices.size());
+    }
+
+    Stats.uintVerticesAfter = InOutObj.Vertices.size();
+    Stats.dblAcmrAfter = MeasureAcmr(InOutObj, vctRanges, InOptions.uintCacheSize);
+    return Stats;
+}
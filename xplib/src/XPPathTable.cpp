@@ -0,0 +1,107 @@
+//Module:	XPPathTable
+//Author:	Connor Russell
+//Date:		10/16/2026 4:18:30 PM
+//Purpose:	Implements XPPathTable.h
+#include <mutex>
+#include <stdexcept>
+#include <xplib/include/XPPathTable.h>
+#include <xplib/include/XPProfile.h>
+
+namespace XPLibrary
+{
+	/**
+	* @brief Get - Gets the process-wide table
+	*/
+	PathTable &PathTable::Get()
+	{
+	    static PathTable Table;
+	    return Table;
+	}
+
+	PathTable::PathTable() : pChunks(new std::atomic<std::filesystem::path *>[MAX_CHUNKS])
+	{
+	    for (size_t i = 0; i < MAX_CHUNKS; i++)
+	        pChunks[i].store(nullptr, std::memory_order_relaxed);
+
+	    ///< ID 0 is the empty path, so default constructed IDs resolve to something sensible
+	    Intern({});
+	}
+
+	PathTable::~PathTable()
+	{
+	    for (size_t i = 0; i < MAX_CHUNKS; i++)
+	        delete[] pChunks[i].load(std::memory_order_relaxed);
+	}
+
+	/**
+	* @brief Intern - Interns a path
+	*
+	* @param InPath = Path to intern
+	* @return The ID for the path
+	*/
+	PathId PathTable::Intern(const std::filesystem::path &InPath)
+	{
+	    const NativeView svPath = InPath.native();
+
+	    ///< Most paths are already in the table, so try with a shared lock first
+	    {
+	        std::shared_lock Lock(mtxTable);
+	        if (const auto it = mIds.find(svPath); it != mIds.end())
+	            return it->second;
+	    }
+
+	    std::unique_lock Lock(mtxTable);
+	    if (const auto it = mIds.find(svPath); it != mIds.end())
+	        return it->second;
+
+	    const size_t idx = uintCount.load(std::memory_order_relaxed);
+	    if (idx >= MAX_CHUNKS * CHUNK_SIZE)
+	        throw std::length_error("PathTable is full");
+
+	    std::filesystem::path *pChunk = pChunks[idx >> CHUNK_BITS].load(std::memory_order_relaxed);
+	    if (pChunk == nullptr)
+	    {
+	        pChunk = new std::filesystem::path[CHUNK_SIZE];
+	        pChunks[idx >> CHUNK_BITS].store(pChunk, std::memory_order_release);
+	    }
+
+	    std::filesystem::path &Slot = pChunk[idx & (CHUNK_SIZE - 1)];
+	    Slot = InPath;
+	    ProfileUtils::MemoryUsage SlotUsage;
+	    SlotUsage.AddPath(Slot);
+	    uintStringBytes += SlotUsage.uintCapacity;
+	    mIds.emplace(Slot.native(), static_cast<PathId>(idx));
+
+	    ///< Publish the slot last, so a reader that sees the new count sees the path too
+	    uintCount.store(idx + 1, std::memory_order_release);
+	    return static_cast<PathId>(idx);
+	}
+
+	/**
+	* @brief Resolve - Gets the path for an ID
+	*
+	* @param InId = ID from Intern
+	* @return The path. Unknown IDs resolve to the empty path.
+	*/
+	const std::filesystem::path &PathTable::Resolve(const PathId InId) const
+	{
+	    const PathId id = InId < Size() ? InId : 0;
+	    return pChunks[id >> CHUNK_BITS].load(std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+	}
+
+	/**
+	* @brief GetMemoryUsage - Estimates the heap memory used by the table, in bytes
+	*/
+	size_t PathTable::GetMemoryUsage() const
+	{
+	    std::shared_lock Lock(mtxTable);
+
+	    const size_t uintChunks = (uintCount.load(std::memory_order_relaxed) + CHUNK_SIZE - 1) >> CHUNK_BITS;
+	    size_t uintBytes = MAX_CHUNKS * sizeof(std::atomic<std::filesystem::path *>);
+	    uintBytes += uintChunks * CHUNK_SIZE * sizeof(std::filesystem::path);
+	    uintBytes += uintStringBytes;
+	    uintBytes += mIds.bucket_count() * sizeof(void *);
+	    uintBytes += mIds.size() * (sizeof(std::pair<const NativeView, PathId>) + sizeof(void *) * 2); ///< Node plus its next pointer and cached hash
+	    return uintBytes;
+	}
+}
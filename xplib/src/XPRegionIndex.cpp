@@ -0,0 +1,191 @@
+//Module:	XPRegionIndex
+//Author:	Connor Russell
+//Date:		10/16/2026 5:10:19 PM
+//Purpose:	Implements XPRegionIndex.h
+#include <algorithm>
+#include <cmath>
+#include <xplib/include/XPRegionIndex.h>
+
+namespace XPLibrary
+{
+	namespace
+	{
+	    /**
+	     * @brief Gets the cell a coordinate falls in along one axis, clamped to the grid
+	     */
+	    int GetCell(const double InValue, const double InMin, const int InCells)
+	    {
+	        return std::clamp(static_cast<int>(std::floor(InValue - InMin)), 0, InCells - 1);
+	    }
+
+	    /**
+	     * @brief Sets a region's bit for every point compatible with it. Written without branches so it vectorizes.
+	     */
+	    void TestRegion(const Region &InRegion, const RegionId InId, const std::span<const double> InLat, const std::span<const double> InLon, const size_t InWords, uint64_t *OutMasks)
+	    {
+	        const double dblNorth = InRegion.dblNorth, dblSouth = InRegion.dblSouth, dblEast = InRegion.dblEast, dblWest = InRegion.dblWest;
+	        const unsigned uintBit = InId % 64;
+	        uint64_t *pWord = OutMasks + InId / 64;
+
+	        for (size_t i = 0; i < InLat.size(); i++)
+	        {
+	            const bool bCompatible = (InLat[i] < dblNorth) & (InLat[i] > dblSouth) & (InLon[i] > dblWest) & (InLon[i] < dblEast);
+	            pWord[i * InWords] |= static_cast<uint64_t>(bCompatible) << uintBit;
+	        }
+	    }
+	}
+
+	/**
+	* @brief Build - Builds the grid
+	*
+	* @param InRegions = Region table, indexed by RegionId
+	*/
+	void RegionIndex::Build(const std::vector<Region> &InRegions)
+	{
+	    pRegions = &InRegions;
+
+	    ///< Collect (cell, id) pairs for both lists, then lay them out flat by cell
+	    std::vector<std::vector<RegionId>> vctInsideCells(ROWS * COLUMNS);
+	    std::vector<std::vector<RegionId>> vctPartialCells(ROWS * COLUMNS);
+
+	    for (RegionId id = 0; id < InRegions.size(); id++)
+	    {
+	        const Region &R = InRegions[id];
+
+	        ///< Regions with empty bounds (including undefined ones) can't be compatible with anything
+	        if (!(R.dblNorth > R.dblSouth) || !(R.dblEast > R.dblWest))
+	            continue;
+
+	        const int intRowFirst = GetCell(R.dblSouth, -90, ROWS);
+	        const int intRowLast = GetCell(R.dblNorth, -90, ROWS);
+	        const int intColFirst = GetCell(R.dblWest, -180, COLUMNS);
+	        const int intColLast = GetCell(R.dblEast, -180, COLUMNS);
+
+	        for (int r = intRowFirst; r <= intRowLast; r++)
+	        {
+	            const double dblCellSouth = r - 90.0;
+	            const double dblCellNorth = dblCellSouth + 1;
+	            for (int c = intColFirst; c <= intColLast; c++)
+	            {
+	                const double dblCellWest = c - 180.0;
+	                const double dblCellEast = dblCellWest + 1;
+
+	                ///< CompatibleWith uses strict comparisons, so a cell is only inside if it is inside the open rectangle, edges included
+	                if (R.dblSouth < dblCellSouth && R.dblNorth > dblCellNorth && R.dblWest < dblCellWest && R.dblEast > dblCellEast)
+	                    vctInsideCells[r * COLUMNS + c].push_back(id);
+	                else if (R.dblSouth < dblCellNorth && R.dblNorth > dblCellSouth && R.dblWest < dblCellEast && R.dblEast > dblCellWest)
+	                    vctPartialCells[r * COLUMNS + c].push_back(id);
+	            }
+	        }
+	    }
+
+	    auto Flatten = [](const std::vector<std::vector<RegionId>> &InCells, std::vector<uint32_t> &OutOffsets, std::vector<RegionId> &OutIds) {
+	        OutOffsets.assign(InCells.size() + 1, 0);
+	        OutIds.clear();
+	        for (size_t i = 0; i < InCells.size(); i++)
+	        {
+	            OutIds.insert(OutIds.end(), InCells[i].begin(), InCells[i].end());
+	            OutOffsets[i + 1] = static_cast<uint32_t>(OutIds.size());
+	        }
+	        OutIds.shrink_to_fit();
+	    };
+	    Flatten(vctInsideCells, vctInsideOffsets, vctInside);
+	    Flatten(vctPartialCells, vctPartialOffsets, vctPartial);
+	}
+
+	/**
+	* @brief GetCompatible - Finds every region compatible with a point
+	*
+	* @param InLat = Latitude
+	* @param InLon = Longitude
+	* @param OutMask = Set to the compatible regions
+	*/
+	void RegionIndex::GetCompatible(const double InLat, const double InLon, RegionMask &OutMask) const
+	{
+	    if (pRegions == nullptr)
+	    {
+	        OutMask.Reset(0);
+	        return;
+	    }
+
+	    OutMask.Reset(pRegions->size());
+
+	    ///< Points off the grid (or NaN) can't use the cell lists, test everything
+	    const int intCell = GetCellIndex(InLat, InLon);
+	    if (intCell == OFF_GRID)
+	    {
+	        for (RegionId id = 0; id < pRegions->size(); id++)
+	        {
+	            if ((*pRegions)[id].CompatibleWith(InLat, InLon))
+	                OutMask.Set(id);
+	        }
+	        return;
+	    }
+
+	    const auto idxCell = static_cast<size_t>(intCell);
+
+	    for (uint32_t i = vctInsideOffsets[idxCell]; i < vctInsideOffsets[idxCell + 1]; i++)
+	        OutMask.Set(vctInside[i]);
+
+	    for (uint32_t i = vctPartialOffsets[idxCell]; i < vctPartialOffsets[idxCell + 1]; i++)
+	    {
+	        if ((*pRegions)[vctPartial[i]].CompatibleWith(InLat, InLon))
+	            OutMask.Set(vctPartial[i]);
+	    }
+	}
+
+	/**
+	* @brief GetCellIndex - Gets the grid cell of a point
+	*
+	* @return The cell index, or OFF_GRID
+	*/
+	int RegionIndex::GetCellIndex(const double InLat, const double InLon)
+	{
+	    if (!(InLat >= -90 && InLat <= 90 && InLon >= -180 && InLon <= 180))
+	        return OFF_GRID;
+	    return GetCell(InLat, -90, ROWS) * COLUMNS + GetCell(InLon, -180, COLUMNS);
+	}
+
+	/**
+	* @brief GetCompatibleInCell - Finds the compatible regions for many points in the same cell
+	*
+	* @param InCell = Cell every point is in
+	* @param InLat = Latitudes
+	* @param InLon = Longitudes
+	* @param InWords = Mask words per point
+	* @param OutMasks = InWords words per point
+	*/
+	void RegionIndex::GetCompatibleInCell(const int InCell, const std::span<const double> InLat, const std::span<const double> InLon, const size_t InWords, const std::span<uint64_t> OutMasks) const
+	{
+	    std::ranges::fill(OutMasks, 0);
+	    if (pRegions == nullptr || InWords == 0)
+	        return;
+
+	    ///< Off the grid there are no cell lists, test everything
+	    if (InCell == OFF_GRID)
+	    {
+	        for (RegionId id = 0; id < pRegions->size(); id++)
+	            TestRegion((*pRegions)[id], id, InLat, InLon, InWords, OutMasks.data());
+	        return;
+	    }
+
+	    const auto idxCell = static_cast<size_t>(InCell);
+	    for (uint32_t i = vctInsideOffsets[idxCell]; i < vctInsideOffsets[idxCell + 1]; i++)
+	    {
+	        const RegionId id = vctInside[i];
+	        for (size_t j = 0; j < InLat.size(); j++)
+	            OutMasks[j * InWords + id / 64] |= uint64_t{1} << (id % 64);
+	    }
+
+	    for (uint32_t i = vctPartialOffsets[idxCell]; i < vctPartialOffsets[idxCell + 1]; i++)
+	        TestRegion((*pRegions)[vctPartial[i]], vctPartial[i], InLat, InLon, InWords, OutMasks.data());
+	}
+
+	/**
+	* @brief GetMemoryUsage - Estimates the heap memory used by the index, in bytes
+	*/
+	size_t RegionIndex::GetMemoryUsage() const
+	{
+	    return (vctInsideOffsets.capacity() + vctPartialOffsets.capacity()) * sizeof(uint32_t) + (vctInside.capacity() + vctPartial.capacity()) * sizeof(RegionId);
+	}
+}